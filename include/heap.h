@@ -109,6 +109,22 @@ typedef struct st_heap_block
 
 struct st_heap_info;			/* For referense */
 
+/*
+  Columns of a record that are stored packed (see hp_var.c).
+  FIXED columns are stored as they are, VARCHAR columns with only the
+  used part of the string and BLOB columns with their data.
+*/
+
+enum hp_column_type { HP_COLUMN_FIXED, HP_COLUMN_VARCHAR, HP_COLUMN_BLOB };
+
+typedef struct st_hp_columndef
+{
+  uint offset;				/* Offset of the column in the record */
+  uint length;				/* Length of the column in the record */
+  uint8 type;				/* enum hp_column_type */
+  uint8 length_bytes;			/* Bytes of VARCHAR/BLOB length */
+} HP_COLUMNDEF;
+
 typedef struct st_hp_keydef		/* Key definition with open */
 {
   uint flag;				/* HA_NOSAME | HA_NULL_PART_KEY */
@@ -159,6 +175,21 @@ typedef struct st_heap_share
   LIST open_list;
   uint auto_key;
   uint auto_key_type;			/* real type of the auto key segment */
+  /*
+    Variable-length rows. If columns != 0, only the first fixed_length
+    bytes of a record are kept in 'block'. The rest of the record is
+    packed according to columndef and stored in a chain of chunks in
+    var_block; the record in 'block' is followed by the packed length and
+    a pointer to the first chunk.
+  */
+  HP_COLUMNDEF *columndef;
+  uint columns;
+  uint fixed_length;
+  uint blobs;				/* Number of BLOB columns */
+  HP_BLOCK var_block;
+  uchar *var_del_link;			/* Link to next free chunk */
+  ulong var_chunks;			/* Chunks allocated in var_block */
+  ulong var_deleted;			/* Free chunks in var_block */
 } HP_SHARE;
 
 struct st_hp_hash_info;
@@ -180,6 +211,8 @@ typedef struct st_heap_info
   uint key_version;                     /* Version at last read */
   uint file_version;                    /* Version at scan */
   uint lastkey_len;
+  uchar *rec_buff;			/* Packed part of the current row */
+  size_t rec_buff_length;
   my_bool implicit_emptied;
   THR_LOCK_DATA lock;
   LIST open_list;
@@ -193,6 +226,10 @@ typedef struct st_heap_create_info
   uint auto_key_type;
   uint keys;
   uint reclength;
+  /* Columns to store packed, see HP_SHARE::columndef. 0 for fixed rows */
+  HP_COLUMNDEF *columndef;
+  uint columns;
+  uint fixed_length;
   ulong max_records;
   ulong min_records;
   ulonglong max_table_size;
@@ -738,6 +738,9 @@ ALTER TABLE help_topic MODIFY url TEXT NOT NULL;
 # MDEV-7383 - varbinary on mix/max of column_stats
 alter table column_stats modify min_value varbinary(255) DEFAULT NULL, modify max_value varbinary(255) DEFAULT NULL;
 
+# JSON_HB histograms
+alter table column_stats modify hist_type enum('SINGLE_PREC_HB','DOUBLE_PREC_HB','JSON_HB') COLLATE utf8_bin DEFAULT NULL, modify histogram longblob DEFAULT NULL;
+
 --
 -- Ensure that all tables are of type Aria and transactional
 --
@@ -216,7 +216,8 @@ SORT_INFO *filesort(THD *thd, TABLE *table, Filesort *filesort,
     const size_t compare_length= param.sort_length;
     if (pq.init(param.max_rows,
                 true,                           // max_at_top
-                NULL,                           // compare_function
+                reinterpret_cast<Bounded_queue<uchar, uchar>::compare_function>
+                  (get_sort_key_compare(compare_length)),
                 compare_length,
                 &make_sortkey, &param, sort->get_sort_keys()))
     {
@@ -1608,7 +1609,7 @@ bool merge_buffers(Sort_param *param, IO_CACHE *from_file,
   }
   else
   {
-    cmp= get_ptr_compare(sort_length);
+    cmp= get_sort_key_compare(sort_length);
     first_cmp_arg= (void*) &sort_length;
   }
   if (unlikely(init_queue(&queue, (uint) (Tb-Fb)+1, offsetof(BUFFPEK,key), 0,
@@ -18,6 +18,7 @@
 #include "sql_const.h"
 #include "sql_sort.h"
 #include "table.h"
+#include <myisampack.h>
 
 
 namespace {
@@ -149,6 +150,73 @@ uchar **Filesort_buffer::alloc_sort_buffer(uint num_records,
 }
 
 
+/*
+  Compare two sort keys of length key_len as sequences of unsigned bytes.
+
+  The keys are read as big-endian words, so that comparing the words gives
+  the same result as memcmp(). As key_len is a constant, the loop is
+  unrolled by the compiler.
+*/
+
+template <size_t key_len>
+static inline int cmp_sort_keys(const uchar *a, const uchar *b)
+{
+  size_t i= 0;
+  for (; i + 8 <= key_len; i+= 8)
+  {
+    ulonglong x= mi_uint8korr(a + i), y= mi_uint8korr(b + i);
+    if (x != y)
+      return x < y ? -1 : 1;
+  }
+  if (key_len - i >= 4)
+  {
+    uint32 x= mi_uint4korr(a + i), y= mi_uint4korr(b + i);
+    if (x != y)
+      return x < y ? -1 : 1;
+    i+= 4;
+  }
+  if (key_len - i >= 2)
+  {
+    uint x= mi_uint2korr(a + i), y= mi_uint2korr(b + i);
+    if (x != y)
+      return x < y ? -1 : 1;
+    i+= 2;
+  }
+  if (key_len - i)
+    return (int) a[i] - (int) b[i];
+  return 0;
+}
+
+
+template <size_t key_len>
+static int sort_key_compare(size_t *not_used __attribute__((unused)),
+                            uchar **a, uchar **b)
+{
+  return cmp_sort_keys<key_len>(*a, *b);
+}
+
+
+qsort2_cmp get_sort_key_compare(size_t size)
+{
+  switch (size) {
+#define SORT_KEY_COMPARE(N) \
+  case N: return (qsort2_cmp) sort_key_compare<N>;
+  SORT_KEY_COMPARE(1)  SORT_KEY_COMPARE(2)  SORT_KEY_COMPARE(3)
+  SORT_KEY_COMPARE(4)  SORT_KEY_COMPARE(5)  SORT_KEY_COMPARE(6)
+  SORT_KEY_COMPARE(7)  SORT_KEY_COMPARE(8)  SORT_KEY_COMPARE(9)
+  SORT_KEY_COMPARE(10) SORT_KEY_COMPARE(11) SORT_KEY_COMPARE(12)
+  SORT_KEY_COMPARE(13) SORT_KEY_COMPARE(14) SORT_KEY_COMPARE(15)
+  SORT_KEY_COMPARE(16) SORT_KEY_COMPARE(17) SORT_KEY_COMPARE(18)
+  SORT_KEY_COMPARE(19) SORT_KEY_COMPARE(20) SORT_KEY_COMPARE(24)
+  SORT_KEY_COMPARE(32)
+#undef SORT_KEY_COMPARE
+  default:
+    break;
+  }
+  return get_ptr_compare(size);
+}
+
+
 void Filesort_buffer::free_sort_buffer()
 {
   my_free(m_idx_array.array());
@@ -173,5 +241,5 @@ void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
     return;
   }
   
-  my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(size), &size);
+  my_qsort2(keys, count, sizeof(uchar*), get_sort_key_compare(size), &size);
 }
@@ -17,6 +17,7 @@
 #define FILESORT_UTILS_INCLUDED
 
 #include "my_base.h"
+#include "my_sys.h"
 #include "sql_array.h"
 
 class Sort_param;
@@ -44,6 +45,17 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
                                       uint    elem_size);
 
 
+/**
+  Get the function to compare sort keys of the given length.
+
+  Short keys are compared by a function made for their length, which
+  compares them by words instead of calling memcmp(). Other lengths use
+  get_ptr_compare().
+*/
+
+qsort2_cmp get_sort_key_compare(size_t size);
+
+
 /**
   A wrapper class around the buffer used by filesort().
   The buffer is a contiguous chunk of memory,
@@ -43,6 +43,7 @@
 #include "debug_sync.h"         // DEBUG_SYNC
 #include "sql_audit.h"
 #include "ha_sequence.h"
+#include "sql_statistics.h"   // note_rows_changed_for_statistics
 
 #ifdef WITH_PARTITION_STORAGE_ENGINE
 #include "ha_partition.h"
@@ -4801,6 +4802,9 @@ void handler::update_global_table_stats()
   status_var_add(table->in_use->status_var.rows_read, rows_read);
   DBUG_ASSERT(rows_tmp_read == 0);
 
+  if (rows_changed)
+    note_rows_changed_for_statistics(table, rows_changed);
+
   if (!table->in_use->userstat_running)
   {
     rows_read= rows_changed= 0;
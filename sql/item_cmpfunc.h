@@ -1301,6 +1301,20 @@ class Item_func_nullif :public Item_func_case_expression
 
 class in_vector :public Sql_alloc
 {
+  /*
+    Bloom filter over the hashes of the sorted elements, NULL for short
+    lists and for vectors without hash(). See create_bloom_filter().
+  */
+  uchar *bloom_filter;
+  ulonglong bloom_filter_mask;
+  bool bloom_filter_may_contain(const uchar *value)
+  {
+    ulonglong nr= hash(value);
+    ulonglong bit1= nr & bloom_filter_mask;
+    ulonglong bit2= (nr >> 32) & bloom_filter_mask;
+    return (bloom_filter[bit1 / 8] & (1 << (bit1 % 8))) &&
+           (bloom_filter[bit2 / 8] & (1 << (bit2 % 8)));
+  }
 public:
   char *base;
   uint size;
@@ -1308,10 +1322,11 @@ class in_vector :public Sql_alloc
   CHARSET_INFO *collation;
   uint count;
   uint used_count;
-  in_vector() {}
+  in_vector() :bloom_filter(NULL) {}
   in_vector(THD *thd, uint elements, uint element_length, qsort2_cmp cmp_func,
   	    CHARSET_INFO *cmp_coll)
-    :base((char*) thd_calloc(thd, elements * element_length)),
+    :bloom_filter(NULL), bloom_filter_mask(0),
+     base((char*) thd_calloc(thd, elements * element_length)),
      size(element_length), compare(cmp_func), collation(cmp_coll),
      count(elements), used_count(elements) {}
   virtual ~in_vector() {}
@@ -1321,7 +1336,16 @@ class in_vector :public Sql_alloc
   {
     my_qsort2(base,used_count,size,compare,(void*)collation);
   }
+  void create_bloom_filter(THD *thd);
   bool find(Item *item);
+
+  /*
+    Hash a value in the format of the elements (as returned by get_value()).
+    Values that compare as equal must have the same hash. Only vectors
+    returning true from has_hash() implement it.
+  */
+  virtual bool has_hash() const { return false; }
+  virtual ulonglong hash(const uchar *value) { return 0; }
   
   /* 
     Create an instance of Item_{type} (e.g. Item_decimal) constant object
@@ -1372,6 +1396,8 @@ class in_string :public in_vector
   ~in_string();
   void set(uint pos,Item *item);
   uchar *get_value(Item *item);
+  bool has_hash() const { return true; }
+  ulonglong hash(const uchar *value);
   Item* create_item(THD *thd);
   void value_to_item(uint pos, Item *item)
   {    
@@ -1399,6 +1425,8 @@ class in_longlong :public in_vector
   in_longlong(THD *thd, uint elements);
   void set(uint pos,Item *item);
   uchar *get_value(Item *item);
+  bool has_hash() const { return true; }
+  ulonglong hash(const uchar *value);
   Item* create_item(THD *thd);
   void value_to_item(uint pos, Item *item)
   {
@@ -1464,6 +1492,8 @@ class in_double :public in_vector
   in_double(THD *thd, uint elements);
   void set(uint pos,Item *item);
   uchar *get_value(Item *item);
+  bool has_hash() const { return true; }
+  ulonglong hash(const uchar *value);
   Item *create_item(THD *thd);
   void value_to_item(uint pos, Item *item)
   {
@@ -2300,6 +2330,7 @@ class Item_func_in :public Item_func_opt_neg,
 protected:
   SEL_TREE *get_func_mm_tree(RANGE_OPT_PARAM *param,
                              Field *field, Item *value);
+  SEL_TREE *get_in_array_mm_tree(RANGE_OPT_PARAM *param, Field *field);
   bool transform_into_subq;
 public:
   /// An array of values, created when the bisection lookup method is used
@@ -2345,14 +2376,14 @@ class Item_func_in :public Item_func_opt_neg,
   {
     return agg_arg_charsets_for_comparison(cmp_collation, args, arg_count);
   }
-  void fix_in_vector();
+  void fix_in_vector(THD *thd);
   bool value_list_convert_const_to_int(THD *thd);
   bool fix_for_scalar_comparison_using_bisection(THD *thd)
   {
     array= m_comparator.type_handler()->make_in_vector(thd, this, arg_count - 1);
     if (!array)      // OOM
       return true;
-    fix_in_vector();
+    fix_in_vector(thd);
     return false;
   }
   bool fix_for_scalar_comparison_using_cmp_items(THD *thd, uint found_types);
@@ -478,7 +478,7 @@ String *Item_func_from_base64::val_str(String *str)
 
 
 const char *histogram_types[] =
-           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", 0};
+           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", "JSON_HB", 0};
 static TYPELIB hystorgam_types_typelib=
   { array_elements(histogram_types),
     "histogram_types",
@@ -508,6 +508,19 @@ String *Item_func_decode_histogram::val_str(String *str)
     null_value= 1;
     return 0;
   }
+  if (type == JSON_HB)
+  {
+    /* The histogram is stored as JSON text, show it as it is */
+    uint errors;
+    if (str->copy(res->ptr(), res->length(), &my_charset_utf8mb4_bin,
+                  collation.collation, &errors))
+    {
+      null_value= 1;
+      return 0;
+    }
+    null_value= 0;
+    return str;
+  }
   if (type == DOUBLE_PREC_HB && res->length() % 2 != 0)
     res->length(res->length() - 1); // one byte is unused
 
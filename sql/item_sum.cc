@@ -700,6 +700,145 @@ int Aggregator_distinct::composite_key_cmp(void* arg, uchar* key1, uchar* key2)
 }
 
 
+/**
+  Check if the keys of COUNT(DISTINCT) can be put into a hash table
+
+  The hash of a value must be the same for all values that Field::cmp()
+  finds equal: this is not so for the floating point numbers (0 and -0)
+  and for the compressed columns.
+*/
+
+static bool distinct_field_hashable(Field *f)
+{
+  return f->result_type() != REAL_RESULT && !f->compression_method();
+}
+
+
+/**
+  Hash the image of a field value in a key of COUNT(DISTINCT)
+
+  The strings are hashed according to their collation, the rest of the
+  values by their bytes.
+*/
+
+static void distinct_field_hash(Field *f, const uchar *key,
+                                ulong *nr1, ulong *nr2)
+{
+  CHARSET_INFO *cs= &my_charset_bin;
+  uint length= f->pack_length();
+  if (f->type() == MYSQL_TYPE_VARCHAR)
+  {
+    uint length_bytes= ((Field_varstring *) f)->length_bytes;
+    length= length_bytes == 1 ? (uint) *key : uint2korr(key);
+    key+= length_bytes;
+    cs= f->charset();
+  }
+  else if (f->real_type() == MYSQL_TYPE_STRING)
+    cs= f->charset();
+  cs->coll->hash_sort(cs, key, length, nr1, nr2);
+}
+
+
+/**
+  Length of the image of a field value in a packed key of COUNT(DISTINCT)
+*/
+
+static uint distinct_packed_field_length(Field *f, const uchar *key)
+{
+  if (f->type() == MYSQL_TYPE_VARCHAR)
+  {
+    uint length_bytes= ((Field_varstring *) f)->length_bytes;
+    return length_bytes + (length_bytes == 1 ? (uint) *key : uint2korr(key));
+  }
+  return f->pack_length();
+}
+
+
+ulong Aggregator_distinct::composite_key_hash(void *arg, const uchar *key)
+{
+  Aggregator_distinct *aggr= (Aggregator_distinct *) arg;
+  Field **field    = aggr->table->field;
+  Field **field_end= field + aggr->table->s->fields;
+  uint32 *lengths=aggr->field_lengths;
+  ulong nr1= 1, nr2= 4;
+  for (; field < field_end; ++field)
+  {
+    distinct_field_hash(*field, key, &nr1, &nr2);
+    key+= *lengths++;
+  }
+  return nr1;
+}
+
+
+/**
+  Compare packed keys of COUNT(DISTINCT)
+
+  A packed key starts with its length (see Unique::read_packed_length()),
+  followed by the images of the field values. The image of a VARCHAR value
+  is its length bytes and the actual data only.
+
+  @param arg     Pointer to the relevant Aggregator_distinct instance
+  @param key1    left key image
+  @param key2    right key image
+  @return        comparison result
+    @retval <0       if key1 < key2
+    @retval =0       if key1 = key2
+    @retval >0       if key1 > key2
+*/
+
+int Aggregator_distinct::packed_key_cmp(void* arg, uchar* key1, uchar* key2)
+{
+  Aggregator_distinct *aggr= (Aggregator_distinct *) arg;
+  Field **field    = aggr->table->field;
+  Field **field_end= field + aggr->table->s->fields;
+  key1+= Unique::PACKED_KEY_LENGTH_BYTES;
+  key2+= Unique::PACKED_KEY_LENGTH_BYTES;
+  for (; field < field_end; ++field)
+  {
+    Field* f = *field;
+    int res = f->cmp(key1, key2);
+    if (res)
+      return res;
+    key1+= distinct_packed_field_length(f, key1);
+    key2+= distinct_packed_field_length(f, key2);
+  }
+  return 0;
+}
+
+
+ulong Aggregator_distinct::packed_key_hash(void *arg, const uchar *key)
+{
+  Aggregator_distinct *aggr= (Aggregator_distinct *) arg;
+  Field **field    = aggr->table->field;
+  Field **field_end= field + aggr->table->s->fields;
+  ulong nr1= 1, nr2= 4;
+  key+= Unique::PACKED_KEY_LENGTH_BYTES;
+  for (; field < field_end; ++field)
+  {
+    distinct_field_hash(*field, key, &nr1, &nr2);
+    key+= distinct_packed_field_length(*field, key);
+  }
+  return nr1;
+}
+
+
+static ulong simple_str_key_hash(void *arg, const uchar *key)
+{
+  ulong nr1= 1, nr2= 4;
+  distinct_field_hash((Field *) arg, key, &nr1, &nr2);
+  return nr1;
+}
+
+
+static ulong simple_raw_key_hash(void *arg, const uchar *key)
+{
+  ulong nr1= 1, nr2= 4;
+  my_charset_bin.coll->hash_sort(&my_charset_bin, key, *(uint *) arg,
+                                 &nr1, &nr2);
+  return nr1;
+}
+
+
 /***************************************************************************/
 
 C_MODE_START
@@ -809,28 +948,47 @@ bool Aggregator_distinct::setup(THD *thd)
         function and its arguments to use with Unique.
       */
       qsort_cmp2 compare_key;
+      unique_hash_func hash_key;
       void* cmp_arg;
       Field **field= table->field;
       Field **field_end= field + table->s->fields;
       bool all_binary= TRUE;
+      bool has_varchar= FALSE;
+      bool hashable= TRUE;
 
+      packed_key= NULL;
       for (tree_key_length= 0; field < field_end; ++field)
       {
         Field *f= *field;
         enum enum_field_types type= f->type();
         tree_key_length+= f->pack_length();
+        if (type == MYSQL_TYPE_VARCHAR)
+          has_varchar= TRUE;
+        if (!distinct_field_hashable(f))
+          hashable= FALSE;
         if ((type == MYSQL_TYPE_VARCHAR) ||
             (!f->binary() && (type == MYSQL_TYPE_STRING ||
                              type == MYSQL_TYPE_VAR_STRING)))
-        {
           all_binary= FALSE;
-          break;
-        }
       }
-      if (all_binary)
+      if (has_varchar)
+      {
+        /*
+          Don't waste memory on the unused tails of VARCHAR values: they
+          are removed from the keys.
+        */
+        tree_key_length+= Unique::PACKED_KEY_LENGTH_BYTES;
+        if (!(packed_key= (uchar*) thd->alloc(tree_key_length)))
+          return TRUE;
+        compare_key= (qsort_cmp2) packed_key_cmp;
+        hash_key= hashable ? packed_key_hash : NULL;
+        cmp_arg= (void*) this;
+      }
+      else if (all_binary)
       {
         cmp_arg= (void*) &tree_key_length;
         compare_key= (qsort_cmp2) simple_raw_key_cmp;
+        hash_key= simple_raw_key_hash;
       }
       else
       {
@@ -843,6 +1001,7 @@ bool Aggregator_distinct::setup(THD *thd)
             about other fields.
           */
           compare_key= (qsort_cmp2) simple_str_key_cmp;
+          hash_key= hashable ? simple_str_key_hash : NULL;
           cmp_arg= (void*) table->field[0];
           /* tree_key_length has been set already */
         }
@@ -850,6 +1009,7 @@ bool Aggregator_distinct::setup(THD *thd)
         {
           uint32 *length;
           compare_key= (qsort_cmp2) composite_key_cmp;
+          hash_key= hashable ? composite_key_hash : NULL;
           cmp_arg= (void*) this;
           field_lengths= (uint32*) thd->alloc(table->s->fields * sizeof(uint32));
           for (tree_key_length= 0, length= field_lengths, field= table->field;
@@ -861,8 +1021,13 @@ bool Aggregator_distinct::setup(THD *thd)
         }
       }
       DBUG_ASSERT(tree == 0);
+      /*
+        COUNT(DISTINCT) needs the values in order only if they don't fit
+        in memory: collect them in a hash table.
+      */
       tree= new Unique(compare_key, cmp_arg, tree_key_length,
-                       item_sum->ram_limitation(thd));
+                       item_sum->ram_limitation(thd), 0, has_varchar,
+                       hash_key);
       /*
         The only time tree_key_length could be 0 is if someone does
         count(distinct) on a char(0) field - stupid thing to do,
@@ -998,6 +1163,18 @@ bool Aggregator_distinct::add()
         bloat the tree without providing any valuable info. Besides,
         key_length used to initialize the tree didn't include space for them.
       */
+      if (packed_key)
+      {
+        uchar *to= packed_key + Unique::PACKED_KEY_LENGTH_BYTES;
+        for (Field **field= table->field; *field; field++)
+        {
+          uint length= distinct_packed_field_length(*field, (*field)->ptr);
+          memcpy(to, (*field)->ptr, length);
+          to+= length;
+        }
+        Unique::store_packed_length(packed_key, (uint) (to - packed_key));
+        return tree->unique_add(packed_key);
+      }
       return tree->unique_add(table->record[0] + table->s->null_bytes);
     }
     if (unlikely((error= table->file->ha_write_tmp_row(table->record[0]))) &&
@@ -2302,6 +2479,8 @@ void Item_sum_hybrid::clear()
   DBUG_ENTER("Item_sum_hybrid::clear");
   value->clear();
   null_value= 1;
+  window_first= window_elements= 0;
+  window_rows_added= window_rows_removed= 0;
   DBUG_VOID_RETURN;
 }
 
@@ -2388,6 +2567,10 @@ void Item_sum_hybrid::cleanup()
   if (cmp)
     delete cmp;
   cmp= 0;
+  /* The cached values were allocated in the execution mem_root */
+  my_free(window_values);
+  window_values= 0;
+  window_values_size= window_first= window_elements= 0;
   /*
     by default it is TRUE to avoid TRUE reporting by
     Item_func_not_all/Item_func_nop_all if this item was never called.
@@ -2422,6 +2605,163 @@ void Item_sum_hybrid::restore_to_before_no_rows_in_result()
 }
 
 
+/**
+  Set up MIN/MAX to be computed as a window function
+
+  @details
+    Rows are removed from the frame only when its top bound is not
+    UNBOUNDED PRECEDING. The frame is then computed incrementally with a
+    monotonic queue of values, which relies on the rows leaving the frame
+    in the order they entered it. This is not the case when both bounds
+    can be on the same side of the current row in a RANGE frame or the
+    frame can be empty; then supports_removal() returns false and the
+    frame is scanned for every row.
+*/
+
+void Item_sum_hybrid::setup_window_func(THD *thd, Window_spec *window_spec)
+{
+  Window_frame *frame= window_spec->window_frame;
+  Window_frame_bound *top, *bottom;
+
+  as_window_function= window_sliding= FALSE;
+  if (!frame)
+  {
+    /* RANGE BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW */
+    as_window_function= TRUE;
+    return;
+  }
+  if (frame->exclusion != Window_frame::EXCL_NONE)
+    return;
+
+  top= frame->top_bound;
+  bottom= frame->bottom_bound;
+  if (top->precedence_type == Window_frame_bound::PRECEDING &&
+      top->is_unbounded())
+  {
+    /* Rows never leave the frame */
+    as_window_function= TRUE;
+    return;
+  }
+  if ((top->precedence_type == Window_frame_bound::FOLLOWING ||
+       bottom->precedence_type == Window_frame_bound::PRECEDING) &&
+      !bottom->is_unbounded())
+  {
+    longlong top_rows, bottom_rows;
+    if (frame->units != Window_frame::UNITS_ROWS ||
+        top->precedence_type != bottom->precedence_type ||
+        top->is_unbounded())
+      return;
+    top_rows= top->offset->val_int();
+    bottom_rows= bottom->offset->val_int();
+    if (top->precedence_type == Window_frame_bound::PRECEDING ?
+        top_rows < bottom_rows : top_rows > bottom_rows)
+      return;                                   // Empty frame
+  }
+  as_window_function= window_sliding= TRUE;
+}
+
+
+/**
+  Add the value in arg_cache to the queue of window frame values
+
+  @return TRUE on out of memory
+*/
+
+bool Item_sum_hybrid::add_window_value()
+{
+  Item_cache *save_value= value;
+  Window_value *to;
+  ulonglong row= window_rows_added++;
+
+  if (arg_cache->null_value)
+    return FALSE;
+
+  /*
+    Values that are worse than the new one will never be the result.
+    Equal values are kept, so that the result is the first of them
+    like when the frame is scanned.
+  */
+  while (window_elements)
+  {
+    value= window_values[(window_first + window_elements - 1) &
+                         (window_values_size - 1)].value;
+    if (cmp->compare() * cmp_sign >= 0)
+      break;
+    window_elements--;
+  }
+  value= save_value;
+
+  if (window_elements == window_values_size)
+  {
+    uint new_size= MY_MAX(window_values_size * 2, 16);
+    Window_value *new_values;
+    if (!(new_values= (Window_value*) my_malloc(new_size *
+                                                sizeof(Window_value),
+                                                MYF(MY_WME | MY_ZEROFILL |
+                                                    MY_THREAD_SPECIFIC))))
+      return TRUE;
+    /* Keep the order of the values and the caches of the unused slots */
+    for (uint i= 0; i < window_values_size; i++)
+      new_values[i]= window_values[(window_first + i) &
+                                   (window_values_size - 1)];
+    my_free(window_values);
+    window_values= new_values;
+    window_values_size= new_size;
+    window_first= 0;
+  }
+
+  to= &window_values[(window_first + window_elements) &
+                     (window_values_size - 1)];
+  if (!to->value)
+  {
+    THD *thd= current_thd;
+    if (!(to->value= arguments()[0]->get_cache(thd)))
+      return TRUE;
+    to->value->setup(thd, arguments()[0]);
+    to->value->set_used_tables(RAND_TABLE_BIT);
+  }
+  to->value->store(arg_cache);
+  to->value->cache_value();
+  to->row= row;
+  window_elements++;
+  set_window_result();
+  return FALSE;
+}
+
+
+/* Set the result to the first value in the queue of window frame values */
+
+void Item_sum_hybrid::set_window_result()
+{
+  if (!window_elements)
+  {
+    value->clear();
+    null_value= 1;
+    return;
+  }
+  value->store(window_values[window_first].value);
+  value->cache_value();
+  null_value= 0;
+}
+
+
+void Item_sum_hybrid::remove()
+{
+  DBUG_ASSERT(as_window_function);
+  if (!window_sliding)
+    return;
+  /* Rows leave the frame in the order they were added */
+  if (window_elements &&
+      window_values[window_first].row == window_rows_removed)
+  {
+    window_first= (window_first + 1) & (window_values_size - 1);
+    window_elements--;
+    set_window_result();
+  }
+  window_rows_removed++;
+}
+
+
 Item *Item_sum_min::copy_or_same(THD* thd)
 {
   DBUG_ENTER("Item_sum_min::copy_or_same");
@@ -2434,6 +2774,7 @@ Item *Item_sum_min::copy_or_same(THD* thd)
 bool Item_sum_min::add()
 {
   Item *UNINIT_VAR(tmp_item);
+  bool result= FALSE;
   DBUG_ENTER("Item_sum_min::add");
   DBUG_PRINT("enter", ("this: %p", this));
 
@@ -2446,8 +2787,10 @@ bool Item_sum_min::add()
   DBUG_PRINT("info", ("null_value: %s", null_value ? "TRUE" : "FALSE"));
   /* args[0] < value */
   arg_cache->cache_value();
-  if (!arg_cache->null_value &&
-      (null_value || cmp->compare() < 0))
+  if (window_sliding)
+    result= add_window_value();
+  else if (!arg_cache->null_value &&
+           (null_value || cmp->compare() < 0))
   {
     value->store(arg_cache);
     value->cache_value();
@@ -2459,7 +2802,7 @@ bool Item_sum_min::add()
     direct_added= FALSE;
     arg_cache->store(tmp_item);
   }
-  DBUG_RETURN(0);
+  DBUG_RETURN(result);
 }
 
 
@@ -2474,6 +2817,7 @@ Item *Item_sum_max::copy_or_same(THD* thd)
 bool Item_sum_max::add()
 {
   Item * UNINIT_VAR(tmp_item);
+  bool result= FALSE;
   DBUG_ENTER("Item_sum_max::add");
   DBUG_PRINT("enter", ("this: %p", this));
 
@@ -2486,8 +2830,10 @@ bool Item_sum_max::add()
   /* args[0] > value */
   arg_cache->cache_value();
   DBUG_PRINT("info", ("null_value: %s", null_value ? "TRUE" : "FALSE"));
-  if (!arg_cache->null_value &&
-      (null_value || cmp->compare() > 0))
+  if (window_sliding)
+    result= add_window_value();
+  else if (!arg_cache->null_value &&
+           (null_value || cmp->compare() > 0))
   {
     value->store(arg_cache);
     value->cache_value();
@@ -2499,7 +2845,7 @@ bool Item_sum_max::add()
     direct_added= FALSE;
     arg_cache->store(tmp_item);
   }
-  DBUG_RETURN(0);
+  DBUG_RETURN(result);
 }
 
 
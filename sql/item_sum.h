@@ -634,6 +634,13 @@ class Aggregator_distinct : public Aggregator
   */
   uint32 *field_lengths;
 
+  /*
+    The buffer for the key of COUNT(DISTINCT) with VARCHAR columns: the
+    key is packed, it has only the actual data of the VARCHAR columns. See
+    Aggregator_distinct::packed_key_cmp
+  */
+  uchar *packed_key;
+
   /*
     Used in conjunction with 'table' to support the access to Field classes 
     for COUNT(DISTINCT). Needed by copy_fields()/copy_funcs().
@@ -678,8 +685,8 @@ class Aggregator_distinct : public Aggregator
 
 public:
   Aggregator_distinct (Item_sum *sum) :
-    Aggregator(sum), table(NULL), tmp_table_param(NULL), tree(NULL),
-    always_null(false), use_distinct_values(false) {}
+    Aggregator(sum), table(NULL), packed_key(NULL), tmp_table_param(NULL),
+    tree(NULL), always_null(false), use_distinct_values(false) {}
   virtual ~Aggregator_distinct ();
   Aggregator_type Aggrtype() { return DISTINCT_AGGREGATOR; }
 
@@ -694,6 +701,9 @@ class Aggregator_distinct : public Aggregator
   bool unique_walk_function(void *element);
   bool unique_walk_function_for_count(void *element);
   static int composite_key_cmp(void* arg, uchar* key1, uchar* key2);
+  static ulong composite_key_hash(void *arg, const uchar *key);
+  static int packed_key_cmp(void* arg, uchar* key1, uchar* key2);
+  static ulong packed_key_hash(void *arg, const uchar *key);
 };
 
 
@@ -1047,19 +1057,43 @@ class Item_sum_hybrid :public Item_sum, public Type_handler_hybrid_field_type
   int cmp_sign;
   bool was_values;  // Set if we have found at least one row (for max/min only)
   bool was_null_value;
+  /*
+    Marks whether the function is computed as a window function with
+    the frame cursors adding and removing rows.
+  */
+  bool as_window_function;
+  /*
+    When rows can leave the window frame: the values of the rows in the
+    frame that can still become the result, in the order the rows were
+    added. Each value is better than all values after it (a monotonic
+    queue), so the first one is the result.
+  */
+  struct Window_value
+  {
+    Item_cache *value;
+    ulonglong row;
+  };
+  Window_value *window_values;
+  uint window_values_size, window_first, window_elements;
+  bool window_sliding;
+  /* Number of rows added to and removed from the frame */
+  ulonglong window_rows_added, window_rows_removed;
 
   public:
   Item_sum_hybrid(THD *thd, Item *item_par,int sign):
     Item_sum(thd, item_par),
     Type_handler_hybrid_field_type(&type_handler_longlong),
     direct_added(FALSE), value(0), arg_cache(0), cmp(0),
-    cmp_sign(sign), was_values(TRUE)
+    cmp_sign(sign), was_values(TRUE), as_window_function(FALSE),
+    window_values(0), window_values_size(0), window_sliding(FALSE)
   { collation.set(&my_charset_bin); }
   Item_sum_hybrid(THD *thd, Item_sum_hybrid *item)
     :Item_sum(thd, item),
     Type_handler_hybrid_field_type(item),
     direct_added(FALSE), value(item->value), arg_cache(0),
-    cmp_sign(item->cmp_sign), was_values(item->was_values)
+    cmp_sign(item->cmp_sign), was_values(item->was_values),
+    as_window_function(FALSE), window_values(0), window_values_size(0),
+    window_sliding(FALSE)
   { }
   bool fix_fields(THD *, Item **);
   bool fix_length_and_dec();
@@ -1090,6 +1124,13 @@ class Item_sum_hybrid :public Item_sum, public Type_handler_hybrid_field_type
   void restore_to_before_no_rows_in_result();
   Field *create_tmp_field(bool group, TABLE *table);
   void setup_caches(THD *thd) { setup_hybrid(thd, arguments()[0], NULL); }
+  void setup_window_func(THD *thd, Window_spec *window_spec);
+  bool supports_removal() const { return as_window_function; }
+  void remove();
+
+protected:
+  bool add_window_value();
+  void set_window_result();
 };
 
 
@@ -11641,6 +11641,101 @@ int Rows_log_event::do_apply_event(rpl_group_info *rgi)
   DBUG_RETURN(error);
 }
 
+/**
+  Look up the rows of this event by primary key, so that the index pages
+  the SQL thread will modify when applying the event are read into the
+  storage engine's cache in advance.
+
+  For updates and deletes this reads the row itself. For inserts the
+  lookup misses, but it still reads the leaf page the row will go into.
+
+  The tables mapped for the current statement are opened and locked for
+  reading on the first row event, and stay open until the caller ends the
+  statement. Only tables whose definition matches the master's exactly are
+  looked at; anything needing type conversion is skipped.
+*/
+
+int Rows_log_event::prefetch(rpl_group_info *rgi)
+{
+  TABLE *table;
+  KEY *key_info;
+  uchar key_buf[MAX_KEY_LENGTH];
+  ulonglong rows= 0;
+  int error= 0;
+  DBUG_ENTER("Rows_log_event::prefetch");
+
+  if (m_table_id == ~0UL || !rgi->tables_to_lock)
+    DBUG_RETURN(0);
+
+  if (!thd->lock)
+  {
+    lex_start(thd);
+    thd->reset_for_next_command();
+    /*
+      Storage engines take shared row locks for reads done by anything but
+      a plain SELECT; we must not wait for, or block, the SQL thread.
+    */
+    thd->lex->sql_command= SQLCOM_SELECT;
+    if (unlikely(open_and_lock_tables(thd, rgi->tables_to_lock, FALSE, 0)))
+      DBUG_RETURN(thd->get_stmt_da()->sql_errno() ?
+                  thd->get_stmt_da()->sql_errno() : HA_ERR_GENERIC);
+
+    /* See do_apply_event() for why we stop at tables_to_lock_count */
+    TABLE_LIST *table_list_ptr= rgi->tables_to_lock;
+    for (uint i=0 ; table_list_ptr && (i < rgi->tables_to_lock_count);
+         table_list_ptr= table_list_ptr->next_global, i++)
+    {
+      if (table_list_ptr->parent_l)
+        continue;
+      RPL_TABLE_LIST *ptr= static_cast<RPL_TABLE_LIST*>(table_list_ptr);
+      if (ptr->m_tabledef.same_types_as(rgi->rli, ptr->table))
+        rgi->m_table_map.set_table(ptr->table_id, ptr->table);
+    }
+  }
+
+  table= m_table= rgi->m_table_map.get_table(m_table_id);
+  if (!table || table->s->primary_key == MAX_KEY)
+    DBUG_RETURN(0);
+
+  /* The row image must contain the whole primary key */
+  key_info= table->key_info + table->s->primary_key;
+  for (uint i= 0; i < key_info->user_defined_key_parts; i++)
+  {
+    uint fieldnr= key_info->key_part[i].fieldnr - 1;
+    if (fieldnr >= m_width || !bitmap_is_set(&m_cols, fieldnr))
+      DBUG_RETURN(0);
+  }
+
+  table->use_all_columns();
+  for (m_curr_row= m_rows_buf; m_curr_row < m_rows_end;
+       m_curr_row= m_curr_row_end)
+  {
+    if ((error= unpack_current_row(rgi)))
+      break;
+    key_copy(key_buf, table->record[0], key_info, 0);
+    table->file->ha_index_read_idx_map(table->record[1],
+                                       table->s->primary_key, key_buf,
+                                       HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+    rows++;
+
+    if (get_general_type_code() == UPDATE_ROWS_EVENT)
+    {
+      /* Step over the after image */
+      m_curr_row= m_curr_row_end;
+      if ((error= unpack_current_row(rgi, &m_cols_ai)))
+        break;
+    }
+    if (unlikely(m_curr_row_end <= m_curr_row))
+    {
+      error= HA_ERR_CORRUPT_EVENT;
+      break;
+    }
+  }
+  m_curr_row= m_rows_buf;
+  statistic_add(slave_prefetched_rows, rows, &LOCK_status);
+  DBUG_RETURN(error);
+}
+
 Log_event::enum_skip_reason
 Rows_log_event::do_shall_skip(rpl_group_info *rgi)
 {
@@ -12711,6 +12806,74 @@ int Table_map_log_event::do_apply_event(rpl_group_info *rgi)
   DBUG_RETURN(tblmap_status == SAME_ID_MAPPING_DIFFERENT_TABLE);
 }
 
+/**
+  Record the table mapping for the relay log prefetch thread.
+
+  This is a read-only version of do_apply_event(): the table is put on
+  rgi->tables_to_lock with a read lock, and tables that are filtered out
+  by the replication filters or already mapped are silently ignored.
+*/
+
+int Table_map_log_event::prefetch(rpl_group_info *rgi)
+{
+  RPL_TABLE_LIST *table_list;
+  char *db_mem, *tname_mem, *ptr;
+  size_t dummy_len, db_mem_length, tname_mem_length;
+  void *memory;
+  Rpl_filter *filter= rgi->rli->mi->rpl_filter;
+  DBUG_ENTER("Table_map_log_event::prefetch");
+
+  if (!(memory= my_multi_malloc(MYF(MY_WME),
+                                &table_list, (uint) sizeof(RPL_TABLE_LIST),
+                                &db_mem, (uint) NAME_LEN + 1,
+                                &tname_mem, (uint) NAME_LEN + 1,
+                                NullS)))
+    DBUG_RETURN(HA_ERR_OUT_OF_MEM);
+
+  db_mem_length= strmov(db_mem, m_dbnam) - db_mem;
+  tname_mem_length= strmov(tname_mem, m_tblnam) - tname_mem;
+  if (lower_case_table_names)
+  {
+    my_casedn_str(files_charset_info, (char*)tname_mem);
+    my_casedn_str(files_charset_info, (char*)db_mem);
+  }
+
+  if (((ptr= (char*) filter->get_rewrite_db(db_mem, &dummy_len)) != db_mem))
+    db_mem_length= strmov(db_mem, ptr) - db_mem;
+
+  LEX_CSTRING tmp_db_name=  {db_mem, db_mem_length };
+  LEX_CSTRING tmp_tbl_name= {tname_mem, tname_mem_length };
+
+  table_list->init_one_table(&tmp_db_name, &tmp_tbl_name, 0, TL_READ);
+  table_list->table_id= m_table_id;
+  table_list->required_type= TABLE_TYPE_NORMAL;
+
+  bool skip= !filter->db_ok(table_list->db.str) ||
+             (filter->is_on() && !filter->tables_ok("", table_list));
+  for (TABLE_LIST *tl= rgi->tables_to_lock; tl && !skip; tl= tl->next_global)
+    skip= tl->table_id == table_list->table_id;
+  if (skip)
+  {
+    my_free(memory);
+    DBUG_RETURN(0);
+  }
+
+  /* Freed in rpl_group_info::clear_tables_to_lock(), as for do_apply_event */
+  new (&table_list->m_tabledef)
+    table_def(m_coltype, m_colcnt,
+              m_field_metadata, m_field_metadata_size,
+              m_null_bits, m_flags);
+  table_list->m_tabledef_valid= TRUE;
+  table_list->m_conv_table= NULL;
+  table_list->master_had_triggers= 0;
+  table_list->open_type= OT_BASE_ONLY;
+
+  table_list->next_global= table_list->next_local= rgi->tables_to_lock;
+  rgi->tables_to_lock= table_list;
+  rgi->tables_to_lock_count++;
+  DBUG_RETURN(0);
+}
+
 Log_event::enum_skip_reason
 Table_map_log_event::do_shall_skip(rpl_group_info *rgi)
 {
@@ -1484,6 +1484,19 @@ class Log_event
   }
 
 
+  /**
+     Bring the data that applying this event will touch into the storage
+     engine's cache, without changing anything.
+
+     This is called by the relay log prefetch thread (see rpl_prefetch.cc)
+     ahead of the SQL thread. The default implementation does nothing.
+
+     @retval 0     Success, or nothing to prefetch
+     @retval errno Error; the caller should give up on the current statement
+   */
+  virtual int prefetch(rpl_group_info *rgi) { return 0; }
+
+
   /**
      Update the relay log position.
 
@@ -4321,6 +4334,7 @@ class Table_map_log_event : public Log_event
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
   virtual void pack_info(Protocol *protocol);
+  virtual int prefetch(rpl_group_info *rgi);
 #endif
 
 #ifdef MYSQL_CLIENT
@@ -4549,6 +4563,7 @@ class Rows_log_event : public Log_event
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
   virtual uint8 get_trg_event_map()= 0;
+  virtual int prefetch(rpl_group_info *rgi);
 #endif
 
 protected:
@@ -29,10 +29,15 @@
 
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
+static PSI_mutex_key key_MDL_context_LOCK_fast_path;
+static PSI_mutex_key key_LOCK_mdl_fast_path_contexts;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
-  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
+  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0},
+  { &key_MDL_context_LOCK_fast_path, "MDL_context::LOCK_fast_path", 0},
+  { &key_LOCK_mdl_fast_path_contexts, "LOCK_mdl_fast_path_contexts",
+    PSI_FLAG_GLOBAL}
 };
 
 static PSI_rwlock_key key_MDL_lock_rwlock;
@@ -123,6 +128,8 @@ class MDL_map
   void init();
   void destroy();
   MDL_lock *find_or_insert(LF_PINS *pins, const MDL_key *key);
+  MDL_lock *fast_path_acquire(LF_PINS *pins, const MDL_key *key,
+                              int64 increment);
   unsigned long get_lock_owner(LF_PINS *pins, const MDL_key *key);
   void remove(LF_PINS *pins, MDL_lock *lock);
   LF_PINS *get_pins() { return lf_hash_get_pins(&m_locks); }
@@ -513,6 +520,133 @@ class MDL_lock
   bitmap_t hog_lock_types_bitmap() const
   { return m_strategy->hog_lock_types_bitmap(); }
 
+  /**
+    Fast path for unobtrusive locks.
+
+    S, SH, SR and SW locks on objects are compatible with each other and
+    are by far the most common ones. Yet acquiring them in the ordinary
+    way means write-locking m_rwlock, which is shared by all connections
+    using the object. So as long as nobody holds or waits for an
+    obtrusive (SU, SRO, SNW, SNRW or X) lock on the object, unobtrusive
+    locks are acquired and released by atomic updates of the counters in
+    m_fast_path_state, without taking m_rwlock and without including
+    the ticket into m_granted.
+
+    Connections asking for an obtrusive lock set HAS_OBTRUSIVE under
+    m_rwlock, which forces everybody to the slow path, and treat the
+    counters as locks granted to other contexts. Their own fast path
+    locks are converted to ordinary ones beforehand, see
+    MDL_context::materialize_fast_path_locks().
+
+    Once all counters drop to zero and the lists are empty, the object
+    is marked IS_DESTROYED before it is removed from MDL_map, so that
+    concurrent fast path acquirers know they have to look it up again.
+  */
+  static const int64 FAST_PATH_S_INCREMENT= 1;
+  static const int64 FAST_PATH_SR_INCREMENT= 1LL << 20;
+  static const int64 FAST_PATH_SW_INCREMENT= 1LL << 40;
+  static const int64 FAST_PATH_COUNTERS= (1LL << 60) - 1;
+  static const int64 HAS_OBTRUSIVE= 1LL << 60;
+  static const int64 IS_DESTROYED= 1LL << 61;
+
+  int64 volatile m_fast_path_state;
+
+  /**
+    Scoped locks are not taken on the fast path, neither are user level
+    locks whose owners must be known for IS_USED_LOCK().
+  */
+  static bool is_fast_path_namespace(MDL_key::enum_mdl_namespace ns)
+  {
+    return ns != MDL_key::GLOBAL && ns != MDL_key::COMMIT &&
+           ns != MDL_key::SCHEMA && ns != MDL_key::USER_LOCK;
+  }
+
+  /** @return Counter increment for a lock type, 0 for obtrusive ones. */
+  static int64 fast_path_increment(enum_mdl_type type)
+  {
+    switch (type) {
+    case MDL_SHARED:
+    case MDL_SHARED_HIGH_PRIO:
+      return FAST_PATH_S_INCREMENT;
+    case MDL_SHARED_READ:
+      return FAST_PATH_SR_INCREMENT;
+    case MDL_SHARED_WRITE:
+      return FAST_PATH_SW_INCREMENT;
+    default:
+      return 0;
+    }
+  }
+
+  bool is_obtrusive(enum_mdl_type type) const
+  {
+    return is_fast_path_namespace(key.mdl_namespace()) &&
+           !fast_path_increment(type);
+  }
+
+  /**
+    Types of locks granted on the fast path. SH locks are reported as S,
+    which is incompatible with exactly the same lock types.
+  */
+  bitmap_t fast_path_granted_bitmap() const
+  {
+    int64 state=
+      my_atomic_load64(const_cast<int64 volatile*>(&m_fast_path_state));
+    bitmap_t result= 0;
+    if (state & (FAST_PATH_SR_INCREMENT - 1))
+      result|= MDL_BIT(MDL_SHARED);
+    if (state & (FAST_PATH_SW_INCREMENT - FAST_PATH_SR_INCREMENT))
+      result|= MDL_BIT(MDL_SHARED_READ);
+    if (state & (FAST_PATH_COUNTERS - (FAST_PATH_SW_INCREMENT - 1)))
+      result|= MDL_BIT(MDL_SHARED_WRITE);
+    return result;
+  }
+
+  /** Force the slow path. @pre m_rwlock is write-locked. */
+  void set_has_obtrusive()
+  {
+    int64 state= my_atomic_load64(&m_fast_path_state);
+    while (!(state & HAS_OBTRUSIVE) &&
+           !my_atomic_cas64(&m_fast_path_state, &state, state | HAS_OBTRUSIVE))
+    { }
+  }
+
+  /**
+    Re-enable the fast path if there are no more obtrusive locks.
+    @pre m_rwlock is write-locked.
+  */
+  void update_obtrusive_flag()
+  {
+    const bitmap_t obtrusive= MDL_BIT(MDL_SHARED_UPGRADABLE) |
+                              MDL_BIT(MDL_SHARED_READ_ONLY) |
+                              MDL_BIT(MDL_SHARED_NO_WRITE) |
+                              MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+                              MDL_BIT(MDL_EXCLUSIVE);
+    int64 state= my_atomic_load64(&m_fast_path_state);
+    if (!(state & HAS_OBTRUSIVE) ||
+        ((m_granted.bitmap() | m_waiting.bitmap()) & obtrusive))
+      return;
+    while ((state & HAS_OBTRUSIVE) &&
+           !my_atomic_cas64(&m_fast_path_state, &state, state & ~HAS_OBTRUSIVE))
+    { }
+  }
+
+  /**
+    Mark the object as destroyed if no locks are held on the fast path.
+    @pre m_rwlock is write-locked and both lists are empty.
+  */
+  bool try_mark_destroyed()
+  {
+    int64 state= my_atomic_load64(&m_fast_path_state);
+    while (!(state & (FAST_PATH_COUNTERS | IS_DESTROYED)))
+    {
+      if (my_atomic_cas64(&m_fast_path_state, &state, IS_DESTROYED))
+        return true;
+    }
+    return false;
+  }
+
+  void fast_path_release(LF_PINS *pins, int64 increment);
+
 #ifndef DBUG_OFF
   bool check_if_conflicting_replication_locks(MDL_context *ctx);
 #endif
@@ -531,12 +665,14 @@ class MDL_lock
 public:
 
   MDL_lock()
-    : m_hog_lock_count(0),
+    : m_fast_path_state(0),
+      m_hog_lock_count(0),
       m_strategy(0)
   { mysql_prlock_init(key_MDL_lock_rwlock, &m_rwlock); }
 
   MDL_lock(const MDL_key *key_arg)
   : key(key_arg),
+    m_fast_path_state(0),
     m_hog_lock_count(0),
     m_strategy(&m_scoped_lock_strategy)
   {
@@ -560,6 +696,7 @@ class MDL_lock
     DBUG_ASSERT(key_arg->mdl_namespace() != MDL_key::GLOBAL &&
                 key_arg->mdl_namespace() != MDL_key::COMMIT);
     new (&lock->key) MDL_key(key_arg);
+    lock->m_fast_path_state= 0;
     if (key_arg->mdl_namespace() == MDL_key::SCHEMA)
       lock->m_strategy= &m_scoped_lock_strategy;
     else
@@ -580,6 +717,22 @@ const MDL_lock::MDL_object_lock MDL_lock::m_object_lock_strategy;
 static MDL_map mdl_locks;
 
 
+/**
+  Contexts which have acquired locks on the fast path, so that
+  mdl_iterate() can find the tickets missing from MDL_lock::m_granted.
+  A context is added on its first such lock and stays until destroyed.
+*/
+
+typedef I_P_List<MDL_context,
+                 I_P_List_adapter<MDL_context,
+                                  &MDL_context::next_in_fast_path_registry,
+                                  &MDL_context::prev_in_fast_path_registry> >
+        MDL_context_list;
+
+static MDL_context_list mdl_fast_path_contexts;
+static mysql_mutex_t LOCK_mdl_fast_path_contexts;
+
+
 extern "C"
 {
 static uchar *
@@ -614,6 +767,8 @@ void mdl_init()
 #endif
 
   mdl_locks.init();
+  mysql_mutex_init(key_LOCK_mdl_fast_path_contexts,
+                   &LOCK_mdl_fast_path_contexts, MY_MUTEX_INIT_FAST);
 }
 
 
@@ -630,6 +785,11 @@ void mdl_destroy()
   {
     mdl_initialized= FALSE;
     mdl_locks.destroy();
+    /* Contexts which outlive us must not touch the list any more. */
+    MDL_context *ctx;
+    while ((ctx= mdl_fast_path_contexts.pop_front()))
+      ctx->m_in_fast_path_registry= false;
+    mysql_mutex_destroy(&LOCK_mdl_fast_path_contexts);
   }
 }
 
@@ -673,6 +833,15 @@ int mdl_iterate(int (*callback)(MDL_ticket *ticket, void *arg), void *arg)
                          (my_hash_walk_action) mdl_iterate_lock, &argument);
     lf_hash_put_pins(pins);
   }
+  if (!res)
+  {
+    MDL_context_list::Iterator it(mdl_fast_path_contexts);
+    MDL_context *ctx;
+    mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+    while ((ctx= it++) && !(res= ctx->iterate_fast_path_locks(callback, arg)))
+      /* no-op */;
+    mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+  }
   DBUG_RETURN(res);
 }
 
@@ -773,6 +942,48 @@ MDL_lock* MDL_map::find_or_insert(LF_PINS *pins, const MDL_key *mdl_key)
 }
 
 
+/**
+  Try to acquire an unobtrusive lock on the fast path, i.e. by
+  incrementing the counter in MDL_lock::m_fast_path_state.
+
+  @retval non-NULL - Success. MDL_lock instance for the key. It is
+                     not destroyed until the counter is decremented.
+  @retval NULL     - The slow path has to be taken (somebody holds or
+                     waits for an obtrusive lock, or OOM).
+*/
+
+MDL_lock* MDL_map::fast_path_acquire(LF_PINS *pins, const MDL_key *mdl_key,
+                                     int64 increment)
+{
+  MDL_lock *lock;
+  int64 state;
+
+  DBUG_ASSERT(MDL_lock::is_fast_path_namespace(mdl_key->mdl_namespace()));
+  do
+  {
+    while (!(lock= (MDL_lock*) lf_hash_search(&m_locks, pins, mdl_key->ptr(),
+                                              mdl_key->length())))
+      if (lf_hash_insert(&m_locks, pins, (uchar*) mdl_key) == -1)
+        return NULL;
+
+    state= my_atomic_load64(&lock->m_fast_path_state);
+    while (!(state & (MDL_lock::HAS_OBTRUSIVE | MDL_lock::IS_DESTROYED)))
+    {
+      if (my_atomic_cas64(&lock->m_fast_path_state, &state,
+                          state + increment))
+      {
+        lf_hash_search_unpin(pins);
+        return lock;
+      }
+    }
+    lf_hash_search_unpin(pins);
+    /* The object is being removed from the hash, look it up again. */
+  } while (state & MDL_lock::IS_DESTROYED);
+
+  return NULL;
+}
+
+
 /**
  * Return thread id of the owner of the lock, if it is owned.
  */
@@ -845,12 +1056,16 @@ void MDL_map::remove(LF_PINS *pins, MDL_lock *lock)
 
 MDL_context::MDL_context()
   :
+  m_in_fast_path_registry(false),
   m_owner(NULL),
   m_needs_thr_lock_abort(FALSE),
   m_waiting_for(NULL),
-  m_pins(NULL)
+  m_pins(NULL),
+  m_ticket_cache_size(0)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  mysql_mutex_init(key_MDL_context_LOCK_fast_path, &m_LOCK_fast_path,
+                   MY_MUTEX_INIT_FAST);
 }
 
 
@@ -871,7 +1086,18 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_STATEMENT].is_empty());
   DBUG_ASSERT(m_tickets[MDL_TRANSACTION].is_empty());
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
+  DBUG_ASSERT(m_fast_path_tickets.is_empty());
 
+  if (m_in_fast_path_registry)
+  {
+    mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+    mdl_fast_path_contexts.remove(this);
+    m_in_fast_path_registry= false;
+    mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+  }
+  while (m_ticket_cache_size)
+    delete m_ticket_cache[--m_ticket_cache_size];
+  mysql_mutex_destroy(&m_LOCK_fast_path);
   mysql_prlock_destroy(&m_LOCK_waiting_for);
   if (m_pins)
     lf_hash_put_pins(m_pins);
@@ -941,8 +1167,8 @@ void MDL_request::init(const MDL_key *key_arg,
   Auxiliary functions needed for creation/destruction of MDL_ticket
   objects.
 
-  @todo This naive implementation should be replaced with one that saves
-        on memory allocation by reusing released objects.
+  Released tickets are kept in a small per-context cache and reused,
+  as each statement acquires and releases a few locks.
 */
 
 MDL_ticket *MDL_ticket::create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -951,6 +1177,13 @@ MDL_ticket *MDL_ticket::create(MDL_context *ctx_arg, enum_mdl_type type_arg
 #endif
                                )
 {
+  if (ctx_arg->m_ticket_cache_size)
+    return new (ctx_arg->m_ticket_cache[--ctx_arg->m_ticket_cache_size])
+               MDL_ticket(ctx_arg, type_arg
+#ifndef DBUG_OFF
+                          , duration_arg
+#endif
+                          );
   return new (std::nothrow)
              MDL_ticket(ctx_arg, type_arg
 #ifndef DBUG_OFF
@@ -962,7 +1195,11 @@ MDL_ticket *MDL_ticket::create(MDL_context *ctx_arg, enum_mdl_type type_arg
 
 void MDL_ticket::destroy(MDL_ticket *ticket)
 {
-  delete ticket;
+  MDL_context *ctx= ticket->m_ctx;
+  if (ctx->m_ticket_cache_size < MDL_context::TICKET_CACHE_SIZE)
+    ctx->m_ticket_cache[ctx->m_ticket_cache_size++]= ticket;
+  else
+    delete ticket;
 }
 
 
@@ -1569,7 +1806,14 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   */
   if (ignore_lock_priority || !(m_waiting.bitmap() & waiting_incompat_map))
   {
-    if (! (m_granted.bitmap() & granted_incompat_map))
+    if (fast_path_granted_bitmap() & granted_incompat_map)
+    {
+      /*
+        Locks acquired on the fast path belong to other contexts, as
+        the requestor of an obtrusive lock has materialized its own ones.
+      */
+    }
+    else if (! (m_granted.bitmap() & granted_incompat_map))
       can_grant= TRUE;
     else
     {
@@ -1654,10 +1898,12 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
-  if (is_empty())
+  if (is_empty() &&
+      (!is_fast_path_namespace(key.mdl_namespace()) || try_mark_destroyed()))
     mdl_locks.remove(pins, this);
   else
   {
+    update_obtrusive_flag();
     /*
       There can be some contexts waiting to acquire a lock
       which now might be able to do it. Grant the lock to
@@ -1678,6 +1924,56 @@ void MDL_lock::remove_ticket(LF_PINS *pins, Ticket_list MDL_lock::*list,
 }
 
 
+/**
+  Release a lock acquired on the fast path.
+
+  @param pins       Pins of the releasing context.
+  @param increment  Counter increment of the lock type.
+*/
+
+void MDL_lock::fast_path_release(LF_PINS *pins, int64 increment)
+{
+  int64 state= my_atomic_load64(&m_fast_path_state);
+
+  /*
+    Once the counter is decremented the object may be destroyed by
+    another connection at any moment. Keep its memory from being reused
+    while we might still need to look at it.
+  */
+  lf_pin(pins, 3, (uchar*) this - LF_HASH_OVERHEAD);
+
+  while (!(state & HAS_OBTRUSIVE))
+  {
+    if (my_atomic_cas64(&m_fast_path_state, &state, state - increment))
+    {
+      if (state == increment)
+      {
+        /* This was the last lock on the object, try to get rid of it. */
+        mysql_prlock_wrlock(&m_rwlock);
+        if (is_empty() && try_mark_destroyed())
+          mdl_locks.remove(pins, this);
+        else
+          mysql_prlock_unlock(&m_rwlock);
+      }
+      lf_unpin(pins, 3);
+      return;
+    }
+  }
+
+  /* Somebody needs an obtrusive lock and may be waiting for ours. */
+  mysql_prlock_wrlock(&m_rwlock);
+  my_atomic_add64(&m_fast_path_state, -increment);
+  if (is_empty() && try_mark_destroyed())
+    mdl_locks.remove(pins, this);
+  else
+  {
+    reschedule_waiters();
+    mysql_prlock_unlock(&m_rwlock);
+  }
+  lf_unpin(pins, 3);
+}
+
+
 /**
   Check if we have any pending locks which conflict with existing
   shared lock.
@@ -1826,6 +2122,7 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       is no need to release it.
     */
     DBUG_ASSERT(! ticket->m_lock->is_empty());
+    ticket->m_lock->update_obtrusive_flag();
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
@@ -1834,6 +2131,96 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
 }
 
 
+/**
+  Check if a lock can be acquired on the fast path by this context.
+
+  Contexts which need thr_lock aborts and Galera conflict resolution
+  rely on seeing every granted ticket in MDL_lock::m_granted.
+*/
+
+bool MDL_context::fast_path_allowed(const MDL_request *mdl_request) const
+{
+  return MDL_lock::fast_path_increment(mdl_request->type) &&
+         MDL_lock::is_fast_path_namespace(mdl_request->key.mdl_namespace()) &&
+         !m_needs_thr_lock_abort && !WSREP_ON;
+}
+
+
+/**
+  Register a ticket for a lock acquired on the fast path.
+*/
+
+void MDL_context::add_fast_path_ticket(MDL_ticket *ticket)
+{
+  if (!m_in_fast_path_registry)
+  {
+    mysql_mutex_lock(&LOCK_mdl_fast_path_contexts);
+    mdl_fast_path_contexts.push_front(this);
+    m_in_fast_path_registry= true;
+    mysql_mutex_unlock(&LOCK_mdl_fast_path_contexts);
+  }
+  ticket->m_is_fast_path= true;
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  m_fast_path_tickets.push_front(ticket);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/**
+  Convert all locks acquired by this context on the fast path to
+  ordinary ones, i.e. include their tickets into MDL_lock::m_granted.
+
+  This is done before requesting an obtrusive lock, so that
+  MDL_lock::can_grant_lock() can tell own locks from locks of other
+  contexts, and before waiting, so that the deadlock detector can see
+  all locks held by a waiting context.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  MDL_ticket *ticket;
+
+  if (m_fast_path_tickets.is_empty())
+    return;
+
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  while ((ticket= m_fast_path_tickets.pop_front()))
+  {
+    MDL_lock *lock= ticket->m_lock;
+    mysql_prlock_wrlock(&lock->m_rwlock);
+    my_atomic_add64(&lock->m_fast_path_state,
+                    -MDL_lock::fast_path_increment(ticket->m_type));
+    ticket->m_is_fast_path= false;
+    lock->m_granted.add_ticket(ticket);
+    mysql_prlock_unlock(&lock->m_rwlock);
+  }
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/**
+  Call a function for every lock of this context acquired on the
+  fast path.
+
+  @return The first non-zero value returned by the callback or 0.
+*/
+
+int MDL_context::iterate_fast_path_locks(int (*callback)(MDL_ticket *ticket,
+                                                         void *arg),
+                                         void *arg)
+{
+  Fast_path_ticket_list::Iterator it(m_fast_path_tickets);
+  MDL_ticket *ticket;
+  int res= 0;
+
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  while ((ticket= it++) && !(res= callback(ticket, arg)))
+    /* no-op */;
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+  return res;
+}
+
+
 /**
   Auxiliary method for acquiring lock without waiting.
 
@@ -1913,6 +2300,22 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
+  if (fast_path_allowed(mdl_request))
+  {
+    if ((lock= mdl_locks.fast_path_acquire(m_pins, key,
+                  MDL_lock::fast_path_increment(mdl_request->type))))
+    {
+      ticket->m_lock= lock;
+      add_fast_path_ticket(ticket);
+      m_tickets[mdl_request->duration].push_front(ticket);
+      mdl_request->ticket= ticket;
+      return FALSE;
+    }
+  }
+  else if (MDL_lock::is_fast_path_namespace(key->mdl_namespace()) &&
+           !MDL_lock::fast_path_increment(mdl_request->type))
+    materialize_fast_path_locks();
+
   /* The below call implicitly locks MDL_lock::m_rwlock on success. */
   if (!(lock= mdl_locks.find_or_insert(m_pins, key)))
   {
@@ -1922,6 +2325,9 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
 
   ticket->m_lock= lock;
 
+  if (lock->is_obtrusive(mdl_request->type))
+    lock->set_has_obtrusive();
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
@@ -1984,11 +2390,25 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
   DBUG_ASSERT(mdl_request->ticket->has_stronger_or_equal_type(ticket->m_type));
 
   ticket->m_lock= mdl_request->ticket->m_lock;
-  mdl_request->ticket= ticket;
 
-  mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
-  ticket->m_lock->m_granted.add_ticket(ticket);
-  mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  if (mdl_request->ticket->m_is_fast_path && fast_path_allowed(mdl_request))
+  {
+    /*
+      The original ticket keeps the object alive, and the clone is
+      granted regardless of pending obtrusive requests, just like below.
+    */
+    my_atomic_add64(&ticket->m_lock->m_fast_path_state,
+                    MDL_lock::fast_path_increment(ticket->m_type));
+    mdl_request->ticket= ticket;
+    add_fast_path_ticket(ticket);
+  }
+  else
+  {
+    mdl_request->ticket= ticket;
+    mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
+    ticket->m_lock->m_granted.add_ticket(ticket);
+    mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  }
 
   m_tickets[mdl_request->duration].push_front(ticket);
 
@@ -2088,8 +2508,28 @@ MDL_context::acquire_lock(MDL_request *mdl_request, double lock_wait_timeout)
   */
   lock= ticket->m_lock;
 
+  if (!m_fast_path_tickets.is_empty() && lock_wait_timeout)
+  {
+    /*
+      The deadlock detector must see all our locks before we start
+      waiting. Making the fast path ones visible requires locking other
+      MDL_lock objects, so give up this one and start over.
+    */
+    lock->update_obtrusive_flag();
+    mysql_prlock_unlock(&lock->m_rwlock);
+    MDL_ticket::destroy(ticket);
+    materialize_fast_path_locks();
+
+    if (try_acquire_lock_impl(mdl_request, &ticket))
+      DBUG_RETURN(TRUE);
+    if (mdl_request->ticket)
+      DBUG_RETURN(FALSE);
+    lock= ticket->m_lock;
+  }
+
   if (lock_wait_timeout == 0)
   {
+    lock->update_obtrusive_flag();
     mysql_prlock_unlock(&lock->m_rwlock);
     MDL_ticket::destroy(ticket);
     my_error(ER_LOCK_WAIT_TIMEOUT, MYF(0));
@@ -2337,6 +2777,8 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
     DBUG_RETURN(TRUE);
 
   is_new_ticket= ! has_lock(mdl_svp, mdl_xlock_request.ticket);
+  /* Acquiring an obtrusive lock has materialized the original one. */
+  DBUG_ASSERT(!mdl_ticket->m_is_fast_path);
 
   /* Merge the acquired and the original lock. @todo: move to a method. */
   mysql_prlock_wrlock(&mdl_ticket->m_lock->m_rwlock);
@@ -2627,7 +3069,16 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 
   DBUG_ASSERT(this == ticket->get_ctx());
 
-  lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    mysql_mutex_lock(&m_LOCK_fast_path);
+    m_fast_path_tickets.remove(ticket);
+    mysql_mutex_unlock(&m_LOCK_fast_path);
+    lock->fast_path_release(m_pins,
+                            MDL_lock::fast_path_increment(ticket->m_type));
+  }
+  else
+    lock->remove_ticket(m_pins, &MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2740,6 +3191,7 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->update_obtrusive_flag();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
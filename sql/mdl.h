@@ -595,6 +595,12 @@ class MDL_ticket : public MDL_wait_for_subgraph
   */
   MDL_ticket *next_in_lock;
   MDL_ticket **prev_in_lock;
+  /**
+    Pointers for participating in the list of tickets of the context
+    acquired on the fast path. Protected by MDL_context::m_LOCK_fast_path.
+  */
+  MDL_ticket *next_in_fast_path;
+  MDL_ticket **prev_in_fast_path;
 public:
 #ifdef WITH_WSREP
   void wsrep_report(bool debug);
@@ -635,7 +641,8 @@ class MDL_ticket : public MDL_wait_for_subgraph
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_is_fast_path(false)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -664,6 +671,12 @@ class MDL_ticket : public MDL_wait_for_subgraph
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the lock is accounted in MDL_lock::m_fast_path_state rather
+    than by this ticket in MDL_lock::m_granted. Context private.
+  */
+  bool m_is_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -758,6 +771,15 @@ class MDL_context
 
   typedef Ticket_list::Iterator Ticket_iterator;
 
+  /**
+    Pointers for participating in the list of contexts which have
+    acquired locks on the fast path. Protected by the mutex of the list.
+  */
+  MDL_context *next_in_fast_path_registry;
+  MDL_context **prev_in_fast_path_registry;
+  /** TRUE if this context is included in that list. */
+  bool m_in_fast_path_registry;
+
   MDL_context();
   void destroy();
 
@@ -832,6 +854,13 @@ class MDL_context
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+    /*
+      Locks acquired on the fast path are invisible to
+      MDL_lock::notify_conflicting_locks(), so they have to be
+      converted to ordinary ones for the abort to work.
+    */
+    if (needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
@@ -928,9 +957,31 @@ class MDL_context
    */
   MDL_wait_for_subgraph *m_waiting_for;
   LF_PINS *m_pins;
+
+  typedef I_P_List<MDL_ticket,
+                   I_P_List_adapter<MDL_ticket,
+                                    &MDL_ticket::next_in_fast_path,
+                                    &MDL_ticket::prev_in_fast_path> >
+          Fast_path_ticket_list;
+  /**
+    Tickets for locks acquired on the fast path. They are not included
+    in MDL_lock::m_granted, this list allows mdl_iterate() to see them.
+  */
+  Fast_path_ticket_list m_fast_path_tickets;
+  /** Protects m_fast_path_tickets from concurrent mdl_iterate(). */
+  mysql_mutex_t m_LOCK_fast_path;
+  /**
+    Released tickets kept for reuse, to save on memory allocation for
+    every lock. Context private.
+  */
+  enum { TICKET_CACHE_SIZE= 16 };
+  MDL_ticket *m_ticket_cache[TICKET_CACHE_SIZE];
+  uint m_ticket_cache_size;
 private:
   MDL_ticket *find_ticket(MDL_request *mdl_req,
                           enum_mdl_duration *duration);
+  bool fast_path_allowed(const MDL_request *mdl_request) const;
+  void add_fast_path_ticket(MDL_ticket *ticket);
   void release_locks_stored_before(enum_mdl_duration duration, MDL_ticket *sentinel);
   void release_lock(enum_mdl_duration duration, MDL_ticket *ticket);
   bool try_acquire_lock_impl(MDL_request *mdl_request,
@@ -941,6 +992,9 @@ class MDL_context
   THD *get_thd() const { return m_owner->get_thd(); }
   bool has_explicit_locks();
   void find_deadlock();
+  void materialize_fast_path_locks();
+  int iterate_fast_path_locks(int (*callback)(MDL_ticket *ticket, void *arg),
+                              void *arg);
 
   ulong get_thread_id() const { return thd_get_thread_id(get_thd()); }
 
@@ -949,6 +1003,8 @@ class MDL_context
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /* Make all our locks visible to the deadlock detector. */
+    materialize_fast_path_locks();
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
@@ -973,6 +1029,7 @@ class MDL_context
   MDL_context(const MDL_context &rhs);          /* not implemented */
   MDL_context &operator=(MDL_context &rhs);     /* not implemented */
 
+  friend class MDL_ticket;
   /* metadata_lock_info plugin */
   friend int i_s_metadata_lock_info_fill_row(MDL_ticket*, void*);
 };
@@ -67,8 +67,10 @@ handler::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
   THD *thd= table->in_use;
   uint limit= thd->variables.eq_range_index_dive_limit;
   
+  KEY *key_info= table->key_info + keyno;
   bool use_statistics_for_eq_range= eq_ranges_exceeds_limit(seq,
                                                             seq_init_param,
+                                                            key_info,
                                                             limit);
 
   /* Default MRR implementation doesn't need buffer */
@@ -94,15 +96,19 @@ handler::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
       min_endp= range.start_key.length? &range.start_key : NULL;
       max_endp= range.end_key.length? &range.end_key : NULL;
     }
-    int keyparts_used= my_count_bits(range.start_key.keypart_map);
+    uint eq_parts;
     if ((range.range_flag & UNIQUE_RANGE) && !(range.range_flag & NULL_RANGE))
       rows= 1; /* there can be at most one row */
     else if (use_statistics_for_eq_range &&
-             !(range.range_flag & NULL_RANGE) &&
-             (range.range_flag & EQ_RANGE) &&
-             table->key_info[keyno].actual_rec_per_key(keyparts_used - 1) > 0.5)
-      rows=
-        (ha_rows) table->key_info[keyno].actual_rec_per_key(keyparts_used - 1);
+             (eq_parts= range_eq_prefix_key_parts(key_info, &range)) &&
+             key_info->actual_rec_per_key(eq_parts - 1) > 0.5)
+    {
+      /*
+        For "kp1 = c1 AND kp2 < c2" this is the number of rows with kp1 = c1,
+        an upper bound of the rows in the range.
+      */
+      rows= (ha_rows) key_info->actual_rec_per_key(eq_parts - 1);
+    }
     else
     {
       if (HA_POS_ERROR == (rows= this->records_in_range(keyno, min_endp, 
@@ -1457,6 +1463,8 @@ ha_rows DsMrr_impl::dsmrr_info_const(uint keyno, RANGE_SEQ_IF *seq,
   ha_rows rows;
   uint def_flags= *flags;
   uint def_bufsz= *bufsz;
+  TABLE *tab= primary_file->get_table();
+  THD *thd= tab->in_use;
   /* Get cost/flags/mem_usage of default MRR implementation */
   rows= primary_file->handler::multi_range_read_info_const(keyno, seq, 
                                                            seq_init_param,
@@ -1469,13 +1477,24 @@ ha_rows DsMrr_impl::dsmrr_info_const(uint keyno, RANGE_SEQ_IF *seq,
     return rows;
   }
 
+  /*
+    A scan over as many equality ranges as eq_range_index_dive_limit, like
+    the one of a big IN list, may be done with DS-MRR even if it is not
+    enabled in @@optimizer_switch
+  */
+  bool eq_range_list=
+    optimizer_flag(thd, OPTIMIZER_SWITCH_MRR_IN_LISTS) &&
+    !(*flags & HA_MRR_USE_DEFAULT_IMPL) &&
+    eq_ranges_exceeds_limit(seq, seq_init_param, tab->key_info + keyno,
+                            thd->variables.eq_range_index_dive_limit);
+
   /*
     If HA_MRR_USE_DEFAULT_IMPL has been passed to us, that is an order to
     use the default MRR implementation (we need it for UPDATE/DELETE).
     Otherwise, make a choice based on cost and @@optimizer_switch settings
   */
   if ((*flags & HA_MRR_USE_DEFAULT_IMPL) ||
-      choose_mrr_impl(keyno, rows, flags, bufsz, cost))
+      choose_mrr_impl(keyno, rows, flags, bufsz, cost, eq_range_list))
   {
     DBUG_PRINT("info", ("Default MRR implementation choosen"));
     *flags= def_flags;
@@ -1560,6 +1579,9 @@ bool DsMrr_impl::check_cpk_scan(THD *thd, TABLE_SHARE *share, uint keyno,
   @param cost   IN   Cost of default MRR implementation
                 OUT  If DS-MRR is choosen, cost of DS-MRR scan
                      else the value is not modified
+  @param eq_range_list  TRUE <=> the scan is over a list of equality ranges
+                        that reaches eq_range_index_dive_limit, and DS-MRR
+                        can be used for it even if optimizer_switch mrr=off
 
   @retval TRUE   Default MRR implementation should be used
   @retval FALSE  DS-MRR implementation should be used
@@ -1567,7 +1589,8 @@ bool DsMrr_impl::check_cpk_scan(THD *thd, TABLE_SHARE *share, uint keyno,
 
 
 bool DsMrr_impl::choose_mrr_impl(uint keyno, ha_rows rows, uint *flags,
-                                 uint *bufsz, Cost_estimate *cost)
+                                 uint *bufsz, Cost_estimate *cost,
+                                 bool eq_range_list)
 {
   Cost_estimate dsmrr_cost;
   bool res;
@@ -1578,7 +1601,7 @@ bool DsMrr_impl::choose_mrr_impl(uint keyno, ha_rows rows, uint *flags,
   bool using_cpk= MY_TEST(keyno == share->primary_key &&
                           primary_file->primary_key_is_clustered());
   *flags &= ~HA_MRR_IMPLEMENTATION_FLAGS;
-  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_MRR) ||
+  if (!(optimizer_flag(thd, OPTIMIZER_SWITCH_MRR) || eq_range_list) ||
       *flags & HA_MRR_INDEX_ONLY ||
       (using_cpk && !doing_cpk_scan) || key_uses_partial_cols(share, keyno))
   {
@@ -48,6 +48,7 @@
 #include "derror.h"       // init_errmessage
 #include "des_key_file.h" // load_des_key_file
 #include "sql_manager.h"  // stop_handle_manager, start_handle_manager
+#include "sql_statistics.h" // start_stats_recalc_thread
 #include "sql_expression_cache.h" // subquery_cache_miss, subquery_cache_hit
 #include "sys_vars_shared.h"
 
@@ -110,6 +111,7 @@
 #include <errmsg.h>
 #include "sp_rcontext.h"
 #include "sp_cache.h"
+#include "sql_plan_cache.h"
 #include "sql_reload.h"  // reload_acl_and_cache
 #include "pcre.h"
 
@@ -509,6 +511,7 @@ ulong aborted_threads, aborted_connects;
 ulong delayed_insert_timeout, delayed_insert_limit, delayed_queue_size;
 ulong delayed_insert_threads, delayed_insert_writes, delayed_rows_in_use;
 ulong delayed_insert_errors,flush_time;
+ulong analyze_auto_recalc_percentage;
 ulong specialflag=0;
 ulong binlog_cache_use= 0, binlog_cache_disk_use= 0;
 ulong binlog_stmt_cache_use= 0, binlog_stmt_cache_disk_use= 0;
@@ -520,6 +523,7 @@ ulong transactions_multi_engine;
 ulong rpl_transactions_multi_engine;
 ulong transactions_gtid_foreign_engine;
 ulonglong slave_skipped_errors;
+ulonglong slave_prefetched_rows;
 ulong feature_files_opened_with_delayed_keys= 0, feature_check_constraint= 0;
 ulonglong denied_connections;
 my_decimal decimal_zero;
@@ -560,6 +564,7 @@ ulong rpl_recovery_rank=0;
   in the sp_cache for one connection.
 */
 ulong stored_program_cache_size= 0;
+ulong plan_cache_size= 0;
 
 ulong opt_slave_parallel_threads= 0;
 ulong opt_slave_domain_parallel_threads= 0;
@@ -567,6 +572,7 @@ ulong opt_slave_parallel_mode= SLAVE_PARALLEL_CONSERVATIVE;
 ulong opt_binlog_commit_wait_count= 0;
 ulong opt_binlog_commit_wait_usec= 0;
 ulong opt_slave_parallel_max_queued= 131072;
+ulong opt_slave_prefetch_window= 0;
 my_bool opt_gtid_ignore_duplicates= FALSE;
 
 const double log_10[] = {
@@ -927,7 +933,8 @@ PSI_mutex_key key_RELAYLOG_LOCK_index;
 PSI_mutex_key key_LOCK_relaylog_end_pos;
 PSI_mutex_key key_LOCK_thread_id;
 PSI_mutex_key key_LOCK_slave_state, key_LOCK_binlog_state,
-  key_LOCK_rpl_thread, key_LOCK_rpl_thread_pool, key_LOCK_parallel_entry;
+  key_LOCK_rpl_thread, key_LOCK_rpl_thread_pool, key_LOCK_parallel_entry,
+  key_LOCK_rpl_prefetch;
 PSI_mutex_key key_LOCK_binlog;
 
 PSI_mutex_key key_LOCK_stats,
@@ -935,6 +942,7 @@ PSI_mutex_key key_LOCK_stats,
   key_LOCK_global_index_stats,
   key_LOCK_wakeup_ready, key_LOCK_wait_commit;
 PSI_mutex_key key_LOCK_gtid_waiting;
+PSI_mutex_key key_LOCK_collect_stats, key_LOCK_stats_recalc;
 
 PSI_mutex_key key_LOCK_after_binlog_sync;
 PSI_mutex_key key_LOCK_prepare_ordered, key_LOCK_commit_ordered,
@@ -991,6 +999,8 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_wakeup_ready, "THD::LOCK_wakeup_ready", 0},
   { &key_LOCK_wait_commit, "wait_for_commit::LOCK_wait_commit", 0},
   { &key_LOCK_gtid_waiting, "gtid_waiting::LOCK_gtid_waiting", 0},
+  { &key_LOCK_collect_stats, "Column_stats_collector::LOCK_collect_stats", 0},
+  { &key_LOCK_stats_recalc, "LOCK_stats_recalc", PSI_FLAG_GLOBAL},
   { &key_LOCK_thd_data, "THD::LOCK_thd_data", 0},
   { &key_LOCK_thd_kill, "THD::LOCK_thd_kill", 0},
   { &key_LOCK_user_conn, "LOCK_user_conn", PSI_FLAG_GLOBAL},
@@ -1024,6 +1034,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_rpl_thread, "LOCK_rpl_thread", 0},
   { &key_LOCK_rpl_thread_pool, "LOCK_rpl_thread_pool", 0},
   { &key_LOCK_parallel_entry, "LOCK_parallel_entry", 0},
+  { &key_LOCK_rpl_prefetch, "LOCK_rpl_prefetch", 0},
   { &key_LOCK_ack_receiver, "Ack_receiver::mutex", 0},
   { &key_LOCK_binlog, "LOCK_binlog", 0}
 };
@@ -1079,9 +1090,11 @@ PSI_cond_key key_TC_LOG_MMAP_COND_queue_busy;
 PSI_cond_key key_COND_rpl_thread_queue, key_COND_rpl_thread,
   key_COND_rpl_thread_stop, key_COND_rpl_thread_pool,
   key_COND_parallel_entry, key_COND_group_commit_orderer,
-  key_COND_prepare_ordered, key_COND_slave_background;
+  key_COND_prepare_ordered, key_COND_slave_background,
+  key_COND_rpl_prefetch;
 PSI_cond_key key_COND_wait_gtid, key_COND_gtid_ignore_duplicates;
 PSI_cond_key key_COND_ack_receiver;
+PSI_cond_key key_COND_collect_stats, key_COND_stats_recalc;
 
 static PSI_cond_info all_server_conds[]=
 {
@@ -1129,10 +1142,13 @@ static PSI_cond_info all_server_conds[]=
   { &key_COND_group_commit_orderer, "COND_group_commit_orderer", 0},
   { &key_COND_prepare_ordered, "COND_prepare_ordered", 0},
   { &key_COND_slave_background, "COND_slave_background", 0},
+  { &key_COND_rpl_prefetch, "COND_rpl_prefetch", 0},
   { &key_COND_start_thread, "COND_start_thread", PSI_FLAG_GLOBAL},
   { &key_COND_wait_gtid, "COND_wait_gtid", 0},
   { &key_COND_gtid_ignore_duplicates, "COND_gtid_ignore_duplicates", 0},
   { &key_COND_ack_receiver, "Ack_receiver::cond", 0},
+  { &key_COND_collect_stats, "Column_stats_collector::COND_collect_stats", 0},
+  { &key_COND_stats_recalc, "COND_stats_recalc", PSI_FLAG_GLOBAL},
   { &key_COND_binlog_send, "COND_binlog_send", 0},
   { &key_TABLE_SHARE_COND_rotation, "TABLE_SHARE::COND_rotation", 0}
 };
@@ -1140,7 +1156,9 @@ static PSI_cond_info all_server_conds[]=
 PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_main,
   key_thread_one_connection, key_thread_signal_hand,
-  key_thread_slave_background, key_rpl_parallel_thread;
+  key_thread_slave_background, key_rpl_parallel_thread,
+  key_rpl_prefetch_thread, key_thread_collect_stats,
+  key_thread_stats_recalc;
 PSI_thread_key key_thread_ack_receiver;
 
 static PSI_thread_info all_server_threads[]=
@@ -1153,7 +1171,10 @@ static PSI_thread_info all_server_threads[]=
   { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL},
   { &key_thread_slave_background, "slave_background", PSI_FLAG_GLOBAL},
   { &key_thread_ack_receiver, "Ack_receiver", PSI_FLAG_GLOBAL},
-  { &key_rpl_parallel_thread, "rpl_parallel_thread", 0}
+  { &key_rpl_parallel_thread, "rpl_parallel_thread", 0},
+  { &key_rpl_prefetch_thread, "rpl_prefetch_thread", 0},
+  { &key_thread_collect_stats, "collect_stats", 0},
+  { &key_thread_stats_recalc, "stats_recalc", PSI_FLAG_GLOBAL}
 };
 
 #ifdef HAVE_MMAP
@@ -1777,6 +1798,7 @@ static void close_connections(void)
     mysql_mutex_unlock(&LOCK_thread_count);
   }
   end_slave();
+  stop_stats_recalc_thread();
   /* All threads has now been aborted */
   DBUG_PRINT("quit",("Waiting for threads to die (count=%u)",thread_count));
   mysql_mutex_lock(&LOCK_thread_count);
@@ -1786,6 +1808,7 @@ static void close_connections(void)
     DBUG_PRINT("quit",("One thread died (count=%u)",thread_count));
   }
   mysql_mutex_unlock(&LOCK_thread_count);
+  free_stats_recalc_thread();
 
   DBUG_PRINT("quit",("close_connections thread"));
   DBUG_VOID_RETURN;
@@ -2139,6 +2162,7 @@ void clean_up(bool print_message)
     tc_log->close();
   xid_cache_free();
   tdc_deinit();
+  plan_cache_free();
   mdl_destroy();
   dflt_key_cache= 0;
   key_caches.delete_elements((void (*)(const char*, uchar*)) free_key_cache);
@@ -4916,6 +4940,7 @@ static int init_server_components()
     all things are initialized so that unireg_abort() doesn't fail
   */
   mdl_init();
+  plan_cache_init();
   if (tdc_init() || hostname_cache_init())
     unireg_abort(1);
 
@@ -5878,6 +5903,7 @@ int mysqld_main(int argc, char **argv)
 
   create_shutdown_event();
   start_handle_manager();
+  start_stats_recalc_thread();
 
   /* Copy default global rpl_filter to global_rpl_filter */
   copy_filter_setting(global_rpl_filter, get_or_create_rpl_filter("", 0));
@@ -7414,6 +7440,27 @@ static int show_table_definitions(THD *thd, SHOW_VAR *var, char *buff,
 }
 
 
+static int show_plan_cache_entries(THD *thd, SHOW_VAR *var, char *buff,
+                                   enum enum_var_type scope)
+{
+  var->type= SHOW_LONG;
+  var->value= buff;
+  *((long *) buff)= (long) plan_cache_entries();
+  return 0;
+}
+
+
+static int show_table_definition_cache_waits(THD *thd, SHOW_VAR *var,
+                                             char *buff,
+                                             enum enum_var_type scope)
+{
+  var->type= SHOW_LONGLONG;
+  var->value= buff;
+  *((longlong *) buff)= (longlong) tdc_unused_shares_waits();
+  return 0;
+}
+
+
 static int show_flush_commands(THD *thd, SHOW_VAR *var, char *buff,
                                enum enum_var_type scope)
 {
@@ -8046,6 +8093,9 @@ SHOW_VAR status_vars[]= {
   {"Opened_table_definitions", (char*) offsetof(STATUS_VAR, opened_shares), SHOW_LONG_STATUS},
   {"Opened_tables",            (char*) offsetof(STATUS_VAR, opened_tables), SHOW_LONG_STATUS},
   {"Opened_views",             (char*) offsetof(STATUS_VAR, opened_views), SHOW_LONG_STATUS},
+  {"Plan_cache_entries",       (char*) &show_plan_cache_entries, SHOW_SIMPLE_FUNC},
+  {"Plan_cache_hits",          (char*) offsetof(STATUS_VAR, plan_cache_hits), SHOW_LONG_STATUS},
+  {"Plan_cache_misses",        (char*) offsetof(STATUS_VAR, plan_cache_misses), SHOW_LONG_STATUS},
   {"Prepared_stmt_count",      (char*) &show_prepared_stmt_count, SHOW_SIMPLE_FUNC},
   {"Rows_sent",                (char*) offsetof(STATUS_VAR, rows_sent), SHOW_LONGLONG_STATUS},
   {"Rows_read",                (char*) offsetof(STATUS_VAR, rows_read), SHOW_LONGLONG_STATUS},
@@ -8096,6 +8146,7 @@ SHOW_VAR status_vars[]= {
   {"Slaves_running",          (char*) &show_slaves_running, SHOW_SIMPLE_FUNC },
   {"Slave_connections",       (char*) offsetof(STATUS_VAR, com_register_slave), SHOW_LONG_STATUS},
   {"Slave_heartbeat_period",   (char*) &show_heartbeat_period, SHOW_SIMPLE_FUNC},
+  {"Slave_prefetched_rows",    (char*) &slave_prefetched_rows, SHOW_LONGLONG},
   {"Slave_received_heartbeats",(char*) &show_slave_received_heartbeats, SHOW_SIMPLE_FUNC},
   {"Slave_retried_transactions",(char*)&slave_retried_transactions, SHOW_LONG},
   {"Slave_running",            (char*) &show_slave_running,     SHOW_SIMPLE_FUNC},
@@ -8144,6 +8195,9 @@ SHOW_VAR status_vars[]= {
   */
   {"Subquery_cache_hit",       (char*) &subquery_cache_hit,     SHOW_LONG},
   {"Subquery_cache_miss",      (char*) &subquery_cache_miss,    SHOW_LONG},
+  {"Table_definition_cache_hits", (char*) offsetof(STATUS_VAR, table_definition_cache_hits), SHOW_LONGLONG_STATUS},
+  {"Table_definition_cache_misses", (char*) offsetof(STATUS_VAR, table_definition_cache_misses), SHOW_LONGLONG_STATUS},
+  {"Table_definition_cache_waits", (char*) &show_table_definition_cache_waits, SHOW_SIMPLE_FUNC},
   {"Table_locks_immediate",    (char*) &locks_immediate,        SHOW_LONG},
   {"Table_locks_waited",       (char*) &locks_waited,           SHOW_LONG},
   {"Table_open_cache_active_instances", (char*) &tc_active_instances, SHOW_UINT},
@@ -8157,6 +8211,7 @@ SHOW_VAR status_vars[]= {
 #endif
 #ifdef HAVE_POOL_OF_THREADS
   {"Threadpool_idle_threads",  (char *) &show_threadpool_idle_threads, SHOW_SIMPLE_FUNC},
+  {"Threadpool_stolen_connections", (char *) &tp_stats.num_stolen_connections, SHOW_LONGLONG},
   {"Threadpool_threads",       (char *) &tp_stats.num_worker_threads, SHOW_INT},
 #endif
   {"Threads_cached",           (char*) &cached_thread_count,    SHOW_LONG_NOFLUSH},
@@ -8411,6 +8466,7 @@ static int mysql_init_variables(void)
   report_user= report_password = report_host= 0;	/* TO BE DELETED */
   opt_relay_logname= opt_relaylog_index_name= 0;
   slave_retried_transactions= 0;
+  slave_prefetched_rows= 0;
   transactions_multi_engine= 0;
   rpl_transactions_multi_engine= 0;
   transactions_gtid_foreign_engine= 0;
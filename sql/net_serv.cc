@@ -525,6 +525,63 @@ net_write_command(NET *net,uchar command,
   DBUG_RETURN(rc);
 }
 
+#if defined(MYSQL_SERVER) && !defined(_WIN32)
+#define HAVE_NET_WRITEV
+
+/**
+  Send the buffered data and a packet that does not fit behind it.
+
+  Instead of copying the head of the packet into the buffer to fill it
+  up, the buffer and the packet are handed to the kernel together with a
+  single vio_writev() call, so large rows and BLOBs are never copied.
+  Whatever the socket does not accept at once is sent with
+  net_real_write(), except for a tail of the packet small enough to be
+  buffered for the next write.
+
+  @retval 0 ok
+  @retval 1 error
+*/
+
+static my_bool
+net_write_buff_and_packet(NET *net, const uchar *packet, size_t len)
+{
+  struct iovec iov[2];
+  size_t buffered= (size_t) (net->write_pos - net->buff);
+  const uchar *buff= net->buff;
+  ssize_t written;
+
+  iov[0].iov_base= (void *) buff;
+  iov[0].iov_len= buffered;
+  iov[1].iov_base= (void *) packet;
+  iov[1].iov_len= len;
+  if ((written= vio_writev(net->vio, iov, 2)) > 0)
+  {
+    size_t from_buff= MY_MIN((size_t) written, buffered);
+#ifdef USE_QUERY_CACHE
+    query_cache_insert(net->thd, (char*) buff, from_buff, net->pkt_nr);
+    if ((size_t) written > from_buff)
+      query_cache_insert(net->thd, (char*) packet, written - from_buff,
+                         net->pkt_nr);
+#endif
+    update_statistics(thd_increment_bytes_sent(net->thd, written));
+    buff+= from_buff;
+    buffered-= from_buff;
+    packet+= written - from_buff;
+    len-= written - from_buff;
+  }
+
+  net->write_pos= net->buff;
+  if (buffered && net_real_write(net, buff, buffered))
+    return 1;
+  if (len > net->max_packet)
+    return net_real_write(net, packet, len) ? 1 : 0;
+  memcpy((char*) net->write_pos, packet, len);
+  net->write_pos+= len;
+  return 0;
+}
+#endif
+
+
 /**
   Caching the data in a local buffer before sending it.
 
@@ -565,6 +622,12 @@ net_write_buff(NET *net, const uchar *packet, size_t len)
 #endif
   if (len > left_length)
   {
+#ifdef HAVE_NET_WRITEV
+    if (!net->compress && net->error != 2 && net->write_pos != net->buff &&
+        (vio_type(net->vio) == VIO_TYPE_TCPIP ||
+         vio_type(net->vio) == VIO_TYPE_SOCKET))
+      return net_write_buff_and_packet(net, packet, len);
+#endif
     if (net->write_pos != net->buff)
     {
       /* Fill up already used packet and write it */
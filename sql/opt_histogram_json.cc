@@ -0,0 +1,548 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Histograms of the type JSON_HB, see opt_histogram_json.h
+*/
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_array.h"
+#include "json_lib.h"
+#include "opt_histogram_json.h"
+
+/* The character set of the JSON text */
+#define JSON_HISTOGRAM_CS (&my_charset_utf8mb4_bin)
+
+
+/* Values that cannot be shown as text are written in hex */
+
+static bool is_binary_value(Field *field)
+{
+  return field->cmp_type() == STRING_RESULT &&
+         field->charset() == &my_charset_bin;
+}
+
+
+/* The length of the part of the record image of a value that is used */
+
+static uint value_image_length(Field *field)
+{
+  if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    return ((Field_varstring *) field)->length_bytes + field->data_length();
+  return field->pack_length();
+}
+
+
+Histogram_json_builder::Histogram_json_builder(Field *col, uint width,
+                                               ha_rows rows)
+  :column(col), records(rows), bucket_capacity((double) rows / width),
+   bucket_count(0), bucket_ndv(0)
+{}
+
+
+/**
+  @brief
+  Append "name": "value" to the JSON text
+
+  @details
+  The value is converted to the character set of the JSON text and
+  escaped. If this is not possible, or the column is binary, the value
+  is written in hex as "name_hex": "value".
+*/
+
+void Histogram_json_builder::append_value(String *out, const char *name,
+                                          const String *value)
+{
+  char buff[MAX_FIELD_WIDTH * 6];
+  int length= -1;
+
+  if (!is_binary_value(column) &&
+      value->length() * 12 < sizeof(buff))
+    length= json_escape(value->charset(), (const uchar *) value->ptr(),
+                        (const uchar *) value->end(), JSON_HISTOGRAM_CS,
+                        (uchar *) buff, (uchar *) buff + sizeof(buff));
+  out->append('"');
+  out->append(name, strlen(name));
+  if (length >= 0)
+  {
+    out->append(STRING_WITH_LEN("\": \""));
+    out->append(buff, length);
+  }
+  else
+  {
+    out->append(STRING_WITH_LEN("_hex\": \""));
+    out->append_hex(value->ptr(), value->length());
+  }
+  out->append('"');
+}
+
+
+/* Write the bucket that is being filled */
+
+void Histogram_json_builder::end_bucket()
+{
+  char numbuf[64];
+  size_t length;
+
+  if (!bucket_ndv)
+    return;
+  if (buckets.length())
+    buckets.append(STRING_WITH_LEN(", "));
+  buckets.append('{');
+  append_value(&buckets, "start", &bucket_start);
+  buckets.append(STRING_WITH_LEN(", "));
+  append_value(&buckets, "end", &bucket_end);
+  length= my_snprintf(numbuf, sizeof(numbuf), ", \"size\": %g, \"ndv\": %llu}",
+                      (double) bucket_count / records, bucket_ndv);
+  buckets.append(numbuf, length);
+  bucket_count= 0;
+  bucket_ndv= 0;
+}
+
+
+/**
+  @brief
+  Add the next distinct value of the column to the histogram
+
+  @param
+  elem      The value in the record format
+  @param
+  elem_cnt  The number of times the value occurs
+*/
+
+void Histogram_json_builder::next(void *elem, element_count elem_cnt)
+{
+  char buff[MAX_FIELD_WIDTH];
+  String tmp(buff, sizeof(buff), &my_charset_bin), *value;
+
+  column->store_field_value((uchar *) elem, column->pack_length());
+  value= column->val_str(&tmp);
+
+  if (elem_cnt >= bucket_capacity)
+  {
+    char numbuf[64];
+    size_t length;
+    if (mcv.length())
+      mcv.append(STRING_WITH_LEN(", "));
+    mcv.append('{');
+    append_value(&mcv, "value", value);
+    length= my_snprintf(numbuf, sizeof(numbuf), ", \"frequency\": %g}",
+                        (double) elem_cnt / records);
+    mcv.append(numbuf, length);
+    return;
+  }
+
+  if (!bucket_ndv)
+    bucket_start.copy(*value);
+  bucket_end.copy(*value);
+  bucket_count+= elem_cnt;
+  bucket_ndv++;
+  if (bucket_count >= bucket_capacity)
+    end_bucket();
+}
+
+
+/**
+  @brief
+  Get the JSON text of the histogram
+
+  @param
+  mem_root   Where to allocate the text
+  @param
+  length     [out] The length of the text
+
+  @return
+  The text, or NULL if out of memory
+*/
+
+char *Histogram_json_builder::finish(MEM_ROOT *mem_root, uint *length)
+{
+  String out;
+  end_bucket();
+  out.append(STRING_WITH_LEN("{\"buckets\": ["));
+  out.append(buckets);
+  out.append(STRING_WITH_LEN("], \"mcv\": ["));
+  out.append(mcv);
+  out.append(STRING_WITH_LEN("]}"));
+  *length= out.length();
+  return (char *) memdup_root(mem_root, out.ptr(), out.length());
+}
+
+
+/* Decode the hex form of a value */
+
+static bool hex_to_binary(const char *from, uint length, String *to)
+{
+  if ((length & 1) || to->alloc(length / 2))
+    return TRUE;
+  for (uint i= 0; i < length; i+= 2)
+  {
+    int hi= hexchar_to_int(from[i]), lo= hexchar_to_int(from[i + 1]);
+    if (hi < 0 || lo < 0)
+      return TRUE;
+    to->qs_append((char) ((hi << 4) | lo));
+  }
+  return FALSE;
+}
+
+
+/**
+  @brief
+  Read a value of the histogram
+
+  @param
+  je         The JSON engine positioned at the value
+  @param
+  field      The field the value is stored into
+  @param
+  is_hex     TRUE if the value is written in hex
+  @param
+  mem_root   Where to allocate the record image of the value
+
+  @return
+  The record image of the value, or NULL in case of an error
+*/
+
+static const uchar *read_value(json_engine_t *je, Field *field, bool is_hex,
+                               MEM_ROOT *mem_root)
+{
+  StringBuffer<MAX_FIELD_WIDTH> buff;
+  StringBuffer<MAX_FIELD_WIDTH> bin;
+  uint max_length;
+  int length;
+
+  if (json_read_value(je) || je->value_type != JSON_VALUE_STRING)
+    return NULL;
+  max_length= (uint) je->value_len * field->charset()->mbmaxlen;
+  if (buff.alloc(max_length) ||
+      (length= json_unescape(JSON_HISTOGRAM_CS, je->value,
+                             je->value + je->value_len,
+                             is_hex ? &my_charset_latin1 : field->charset(),
+                             (uchar *) buff.ptr(),
+                             (uchar *) buff.ptr() + max_length)) < 0)
+    return NULL;
+  buff.length(length);
+
+  if (is_hex)
+  {
+    if (hex_to_binary(buff.ptr(), length, &bin))
+      return NULL;
+    field->store(bin.ptr(), bin.length(), &my_charset_bin);
+  }
+  else
+    field->store(buff.ptr(), length, field->charset());
+  return (const uchar *) memdup_root(mem_root, field->ptr,
+                                     value_image_length(field));
+}
+
+
+/*
+  Read the name of the key the JSON engine is positioned at
+
+  Names longer than the buffer do not matter for the histogram, they are
+  cut and then do not match any name.
+*/
+
+static bool read_key(json_engine_t *je, char *name, uint size)
+{
+  uint length= 0;
+  while (json_read_keyname_chr(je) == 0)
+  {
+    if (length < size - 1)
+      name[length++]= je->s.c_next < 128 ? (char) je->s.c_next : '?';
+  }
+  name[length]= 0;
+  return je->s.error != 0;
+}
+
+
+/* Check whether the key is the name or its hex form */
+
+static bool key_matches(const char *key, const char *name, bool *is_hex)
+{
+  size_t length= strlen(name);
+  if (strncmp(key, name, length))
+    return FALSE;
+  *is_hex= key[length] != 0;
+  return !*is_hex || !strcmp(key + length, "_hex");
+}
+
+
+static bool read_number(json_engine_t *je, double *nr)
+{
+  char *end;
+  int err;
+  if (json_read_value(je) || je->value_type != JSON_VALUE_NUMBER)
+    return TRUE;
+  end= (char *) je->value_end;
+  *nr= my_strtod((const char *) je->value, &end, &err);
+  return err != 0;
+}
+
+
+/**
+  @brief
+  Prepare a JSON_HB histogram read from column_stats for the optimizer
+
+  @param
+  mem_root    Where to allocate the histogram
+  @param
+  field       A copy of the column with its own record buffer, the values
+              of the histogram are stored into it
+  @param
+  min_value   The minimal value of the column, or NULL if not known
+  @param
+  max_value   The maximal value of the column, or NULL if not known
+  @param
+  text        The JSON text of the histogram
+  @param
+  length      The length of the text
+
+  @return
+  The histogram, or NULL if the text is not a valid histogram
+*/
+
+Histogram_json *Histogram_json::create(MEM_ROOT *mem_root, Field *field,
+                                       Field *min_value, Field *max_value,
+                                       const char *text, size_t length)
+{
+  json_engine_t je;
+  char key[16];
+  bool is_hex;
+  Dynamic_array<Bucket> buckets;
+  Dynamic_array<Common_value> mcv;
+  Histogram_json *hist;
+  double size_before= 0;
+
+  json_scan_start(&je, JSON_HISTOGRAM_CS, (const uchar *) text,
+                  (const uchar *) text + length);
+  if (json_read_value(&je) || je.value_type != JSON_VALUE_OBJECT)
+    return NULL;
+
+  while (!json_scan_next(&je) && je.state == JST_KEY)
+  {
+    bool is_buckets, is_mcv;
+    if (read_key(&je, key, sizeof(key)))
+      return NULL;
+    is_buckets= !strcmp(key, "buckets");
+    is_mcv= !strcmp(key, "mcv");
+    if (!is_buckets && !is_mcv)
+    {
+      if (json_skip_key(&je))
+        return NULL;
+      continue;
+    }
+    if (json_read_value(&je) || je.value_type != JSON_VALUE_ARRAY)
+      return NULL;
+
+    while (!json_scan_next(&je) && je.state == JST_VALUE)
+    {
+      Bucket bucket;
+      Common_value common;
+      bzero(&bucket, sizeof(bucket));
+      bzero(&common, sizeof(common));
+      if (json_read_value(&je) || je.value_type != JSON_VALUE_OBJECT)
+        return NULL;
+      while (!json_scan_next(&je) && je.state == JST_KEY)
+      {
+        bool err;
+        if (read_key(&je, key, sizeof(key)))
+          return NULL;
+        if (is_buckets && key_matches(key, "start", &is_hex))
+        {
+          if ((err= !(bucket.start= read_value(&je, field, is_hex,
+                                               mem_root))) == FALSE &&
+              min_value && max_value)
+            bucket.start_pos= field->pos_in_interval(min_value, max_value);
+        }
+        else if (is_buckets && key_matches(key, "end", &is_hex))
+        {
+          if ((err= !(bucket.end= read_value(&je, field, is_hex,
+                                             mem_root))) == FALSE &&
+              min_value && max_value)
+            bucket.end_pos= field->pos_in_interval(min_value, max_value);
+        }
+        else if (is_buckets && !strcmp(key, "size"))
+          err= read_number(&je, &bucket.size);
+        else if (is_buckets && !strcmp(key, "ndv"))
+          err= read_number(&je, &bucket.ndv);
+        else if (is_mcv && key_matches(key, "value", &is_hex))
+          err= !(common.value= read_value(&je, field, is_hex, mem_root));
+        else if (is_mcv && !strcmp(key, "frequency"))
+          err= read_number(&je, &common.frequency);
+        else
+          err= json_skip_key(&je);
+        if (err)
+          return NULL;
+      }
+      if (je.s.error)
+        return NULL;
+      if (is_buckets)
+      {
+        if (!bucket.start || !bucket.end || bucket.ndv < 1)
+          return NULL;
+        bucket.size_before= size_before;
+        size_before+= bucket.size;
+        if (buckets.append(bucket))
+          return NULL;
+      }
+      else if (!common.value || mcv.append(common))
+        return NULL;
+    }
+    if (je.s.error)
+      return NULL;
+  }
+  if (je.s.error)
+    return NULL;
+
+  if (!(hist= new (mem_root) Histogram_json()))
+    return NULL;
+  hist->n_buckets= (uint) buckets.elements();
+  hist->n_mcv= (uint) mcv.elements();
+  hist->buckets= NULL;
+  hist->mcv= NULL;
+  if ((hist->n_buckets &&
+       !(hist->buckets= (Bucket *) memdup_root(mem_root, buckets.front(),
+                                               sizeof(Bucket) *
+                                               hist->n_buckets))) ||
+      (hist->n_mcv &&
+       !(hist->mcv= (Common_value *) memdup_root(mem_root, mcv.front(),
+                                                 sizeof(Common_value) *
+                                                 hist->n_mcv))))
+    return NULL;
+  return hist;
+}
+
+
+/*
+  Find the first bucket whose end is not less than the value of the field
+
+  @return
+  The number of the bucket, n_buckets if the value is above all buckets
+*/
+
+uint Histogram_json::find_bucket(Field *field)
+{
+  uint lo= 0, hi= n_buckets;
+  while (lo < hi)
+  {
+    uint mid= (lo + hi) / 2;
+    if (field->cmp(field->ptr, buckets[mid].end) > 0)
+      lo= mid + 1;
+    else
+      hi= mid;
+  }
+  return lo;
+}
+
+
+/**
+  @brief
+  Estimate the selectivity of "col=const"
+
+  @param
+  field      The column with the constant stored in it
+  @param
+  avg_sel    The average selectivity of "col=const"
+
+  @return
+  The fraction of the non-NULL values of the column equal to the constant
+*/
+
+double Histogram_json::point_selectivity(Field *field, double avg_sel)
+{
+  uint i;
+  for (i= 0; i < n_mcv; i++)
+  {
+    if (!field->cmp(field->ptr, mcv[i].value))
+      return mcv[i].frequency;
+  }
+  if (!n_buckets)
+    return avg_sel;
+
+  i= find_bucket(field);
+  if (i < n_buckets && field->cmp(field->ptr, buckets[i].start) >= 0)
+    return buckets[i].size / buckets[i].ndv;
+  /*
+    The value was not met when the histogram was built. It cannot be more
+    common than the values of the buckets around it.
+  */
+  if (i == n_buckets)
+    i--;
+  return MY_MIN(avg_sel, buckets[i].size / buckets[i].ndv);
+}
+
+
+/**
+  @brief
+  Estimate the fraction of the values of the column below a constant
+
+  @param
+  field          The column with the constant stored in it
+  @param
+  pos            The position of the constant between the minimal and the
+                 maximal value of the column
+  @param
+  include_value  TRUE if the values equal to the constant are counted
+
+  @return
+  The fraction of the non-NULL values of the column that are less than
+  (or equal to) the constant
+*/
+
+double Histogram_json::fraction_below(Field *field, double pos,
+                                      bool include_value)
+{
+  double sel= 0;
+  uint i;
+  int cmp;
+
+  for (i= 0; i < n_mcv; i++)
+  {
+    cmp= field->cmp(field->ptr, mcv[i].value);
+    if (cmp > 0 || (cmp == 0 && include_value))
+      sel+= mcv[i].frequency;
+  }
+  if (!n_buckets)
+    return sel;
+
+  if ((i= find_bucket(field)) == n_buckets)
+    return sel + buckets[i - 1].size_before + buckets[i - 1].size;
+
+  Bucket *bucket= buckets + i;
+  double value_size= bucket->size / bucket->ndv;
+  sel+= bucket->size_before;
+  if ((cmp= field->cmp(field->ptr, bucket->start)) <= 0)
+  {
+    if (cmp == 0 && include_value)
+      sel+= value_size;
+  }
+  else if (!field->cmp(field->ptr, bucket->end))
+    sel+= include_value ? bucket->size : bucket->size - value_size;
+  else
+  {
+    /* The constant is inside the bucket, the values are spread evenly */
+    double fraction= 0.5;
+    if (bucket->end_pos > bucket->start_pos)
+      fraction= (pos - bucket->start_pos) /
+                (bucket->end_pos - bucket->start_pos);
+    set_if_bigger(fraction, 0.0);
+    set_if_smaller(fraction, 1.0);
+    sel+= value_size + fraction * (bucket->size - 2 * value_size);
+  }
+  return sel;
+}
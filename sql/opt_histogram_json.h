@@ -0,0 +1,106 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef OPT_HISTOGRAM_JSON_INCLUDED
+#define OPT_HISTOGRAM_JSON_INCLUDED
+
+/*
+  Histograms of the type JSON_HB.
+
+  A JSON_HB histogram is an equi-height histogram with exact endpoint
+  values, together with a list of the most common values of the column
+  and their frequencies. It is stored in mysql.column_stats.histogram as
+  JSON text:
+
+    {"buckets": [{"start": "1", "end": "37", "size": 0.1, "ndv": 37},
+                 ...],
+     "mcv": [{"value": "42", "frequency": 0.3}, ...]}
+
+  A value that occurs at least as often as there are values in a bucket
+  is put into the "mcv" list and is not counted in any bucket. The other
+  values are split into at most histogram_size buckets of about the same
+  number of values; "start" and "end" are the smallest and the largest
+  value in the bucket and "ndv" is the number of distinct values in it.
+  "size" and "frequency" are fractions of all non-NULL values of the
+  column. Values are written the way the column shows them, values of
+  binary strings are written in hex as "start_hex", "end_hex" and
+  "value_hex".
+
+  Histogram_json_builder produces the text from the sorted distinct values
+  of a column when ANALYZE collects statistics, Histogram_json is the
+  histogram read back for the optimizer.
+*/
+
+class Histogram_json_builder
+{
+  Field *column;
+  ha_rows records;        /* Number of non-NULL values */
+  double bucket_capacity; /* Number of values in a bucket */
+  String buckets;         /* The JSON text of the buckets and of the list */
+  String mcv;             /* of the most common values */
+
+  /* The bucket being filled */
+  ulonglong bucket_count;
+  ulonglong bucket_ndv;
+  String bucket_start;
+  String bucket_end;
+
+  void append_value(String *out, const char *name, const String *value);
+  void end_bucket();
+
+public:
+  Histogram_json_builder(Field *col, uint width, ha_rows rows);
+  void next(void *elem, element_count elem_cnt);
+  char *finish(MEM_ROOT *mem_root, uint *length);
+};
+
+
+class Histogram_json: public Sql_alloc
+{
+public:
+  struct Bucket
+  {
+    const uchar *start;   /* The values in the record format */
+    const uchar *end;
+    double start_pos;     /* Positions of the values between min and max */
+    double end_pos;
+    double size;
+    double ndv;
+    double size_before;   /* Sum of the sizes of the preceding buckets */
+  };
+  struct Common_value
+  {
+    const uchar *value;
+    double frequency;
+  };
+
+private:
+  Bucket *buckets;
+  uint n_buckets;
+  Common_value *mcv;
+  uint n_mcv;
+
+  uint find_bucket(Field *field);
+
+public:
+  static Histogram_json *create(MEM_ROOT *mem_root, Field *field,
+                                Field *min_value, Field *max_value,
+                                const char *text, size_t length);
+
+  double point_selectivity(Field *field, double avg_sel);
+  double fraction_below(Field *field, double pos, bool include_value);
+};
+
+#endif /* OPT_HISTOGRAM_JSON_INCLUDED */
@@ -119,6 +119,7 @@
 #include "sql_select.h"
 #include "sql_statistics.h"
 #include "uniques.h"
+#include <my_bit.h>
 
 #ifndef EXTRA_DEBUG
 #define test_rb_tree(A,B) {}
@@ -380,6 +381,10 @@ TABLE_READ_PLAN *merge_same_index_scans(PARAM *param, SEL_IMERGE *imerge,
 static
 TRP_GROUP_MIN_MAX *get_best_group_min_max(PARAM *param, SEL_TREE *tree,
                                           double read_time);
+class TRP_SKIP_SCAN;
+static
+TRP_SKIP_SCAN *get_best_skip_scan(PARAM *param, SEL_TREE *tree,
+                                  double read_time);
 
 #ifndef DBUG_OFF
 static void print_sel_tree(PARAM *param, SEL_TREE *tree, key_map *tree_map,
@@ -2362,6 +2367,28 @@ class TRP_GROUP_MIN_MAX : public TABLE_READ_PLAN
 };
 
 
+/*
+  Plan for a QUICK_SKIP_SCAN_SELECT scan.
+  QUICK_SKIP_SCAN_SELECT reads full rows unless the index is covering,
+  which is decided by the join, so retrieve_full_rows is ignored.
+*/
+
+class TRP_SKIP_SCAN : public TABLE_READ_PLAN
+{
+public:
+  SEL_ARG *key; /* intervals over the key parts after the skipped prefix */
+  uint     key_idx; /* key number in PARAM::key */
+
+  TRP_SKIP_SCAN(SEL_ARG *key_arg, uint idx_arg)
+   : key(key_arg), key_idx(idx_arg)
+  {}
+  virtual ~TRP_SKIP_SCAN() {}                 /* Remove gcc warning */
+
+  QUICK_SELECT_I *make_quick(PARAM *param, bool retrieve_full_rows,
+                             MEM_ROOT *parent_alloc);
+};
+
+
 typedef struct st_index_scan_info
 {
   uint      idx;      /* # of used key in param->keys */
@@ -2695,8 +2722,22 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
       TRP_RANGE         *range_trp;
       TRP_ROR_INTERSECT *rori_trp;
       TRP_INDEX_INTERSECT *intersect_trp;
+      TRP_SKIP_SCAN     *skip_scan_trp;
       bool can_build_covering= FALSE;
-      
+
+      /*
+        Skip scans use the trees without conditions on the first key parts,
+        so they are looked for before such trees are removed.
+      */
+      if (optimizer_flag(thd, OPTIMIZER_SWITCH_SKIP_SCAN) &&
+          (skip_scan_trp= get_best_skip_scan(&param, tree, best_read_time)))
+      {
+        best_trp= skip_scan_trp;
+        best_read_time= best_trp->read_cost;
+        set_if_smaller(param.table->quick_condition_rows,
+                       skip_scan_trp->records);
+      }
+
       remove_nonrange_trees(&param, tree);
 
       /* Get best 'range' plan and prepare data for making other plans */
@@ -7347,6 +7388,9 @@ SEL_TREE *Item_func_in::get_func_mm_tree(RANGE_OPT_PARAM *param,
   }
   else
   {
+    if (array && array->type_handler()->result_type() != ROW_RESULT)
+      DBUG_RETURN(get_in_array_mm_tree(param, field));
+
     tree= get_mm_parts(param, field, Item_func::EQ_FUNC, args[1]);
     if (tree)
     {
@@ -7363,6 +7407,118 @@ SEL_TREE *Item_func_in::get_func_mm_tree(RANGE_OPT_PARAM *param,
 }
 
 
+/*
+  Build the SEL_TREE for "field IN (c1, ..., cN)" from the sorted array
+
+  SYNOPSIS
+    Item_func_in::get_in_array_mm_tree()
+    param  PARAM from SQL_SELECT::test_quick_select
+    field  The field compared with the values of the IN list
+
+  DESCRIPTION
+    OR-ing one SEL_TREE per value of the list needs a SEL_TREE with an
+    array of MAX_KEY keys and a key_or() call for every value, which for
+    lists with tens of thousands of values takes seconds and hundreds of
+    megabytes. The values of Item_func_in::array are sorted already, so
+    instead the intervals of every key part over the field are built
+    directly from the array: duplicates are skipped and an interval
+    greater than the last one is just inserted at the end of the tree.
+    Intervals out of order, which can happen after a conversion to the
+    field type, are added with key_or().
+
+  RETURN
+    SEL_TREE with the intervals for all keys over the field
+    NULL if the tree could not be built
+*/
+
+SEL_TREE *Item_func_in::get_in_array_mm_tree(RANGE_OPT_PARAM *param,
+                                             Field *field)
+{
+  SEL_TREE *tree= NULL;
+  DBUG_ENTER("Item_func_in::get_in_array_mm_tree");
+
+  if (field->table != param->table || !array->used_count)
+    DBUG_RETURN(NULL);
+
+  MEM_ROOT *tmp_root= param->mem_root;
+  param->thd->mem_root= param->old_root;
+  /* The Item is created on the statement mem_root, see get_func_mm_tree() */
+  Item *value_item= array->create_item(param->thd);
+  param->thd->mem_root= tmp_root;
+  if (!value_item)
+    DBUG_RETURN(NULL);
+
+  for (KEY_PART *key_part= param->key_parts;
+       key_part != param->key_parts_end;
+       key_part++)
+  {
+    if (!field->eq(key_part->field))
+      continue;
+    if (!tree && !(tree= new (param->thd->mem_root) SEL_TREE(param->mem_root,
+                                                             param->keys)))
+      DBUG_RETURN(NULL);                        // OOM
+    if (tree->keys[key_part->key])
+      continue;                                 // Field twice in the key
+
+    SEL_ARG *root= NULL, *last= NULL;
+    bool usable= TRUE;
+    for (uint i= 0; i < array->used_count; i++)
+    {
+      if (i && !array->compare_elems(i, i - 1))
+        continue;                               // Duplicate value
+      array->value_to_item(i, value_item);
+
+      param->thd->mem_root= param->old_root;
+      SEL_ARG *sel_arg= get_mm_leaf(param, key_part->field, key_part,
+                                    Item_func::EQ_FUNC, value_item);
+      param->thd->mem_root= tmp_root;
+      if (!sel_arg)
+      {
+        root= NULL;                             // The key can't be used
+        usable= FALSE;
+        break;
+      }
+      if (sel_arg->type == SEL_ARG::IMPOSSIBLE)
+        continue;
+      sel_arg->part= (uchar) key_part->part;
+      sel_arg->max_part_no= sel_arg->part + 1;
+
+      if (!root)
+        root= last= sel_arg;
+      else if (sel_arg->type == SEL_ARG::KEY_RANGE && sel_arg->elements == 1 &&
+               !sel_arg->next_key_part && sel_arg->cmp_min_to_max(last) > 0)
+        root= root->insert(last= sel_arg);
+      else
+      {
+        if (!(root= key_or(param, root, sel_arg)))
+        {
+          usable= FALSE;
+          break;
+        }
+        last= root->last();
+      }
+      if (param->statement_should_be_aborted())
+        DBUG_RETURN(NULL);
+    }
+    if (root)
+    {
+      tree->keys[key_part->key]= root;
+      tree->keys_map.set_bit(key_part->key);
+    }
+    else if (usable)
+    {
+      /* No value of the list can be stored in the field */
+      tree->type= SEL_TREE::IMPOSSIBLE;
+      DBUG_RETURN(tree);
+    }
+  }
+
+  if (tree && tree->keys_map.is_clear_all())
+    tree= NULL;
+  DBUG_RETURN(tree);
+}
+
+
 /*
   The structure Key_col_info is purely  auxiliary and is used
   only in the method Item_func_in::get_func_row_mm_tree
@@ -12096,6 +12252,16 @@ QUICK_GROUP_MIN_MAX_SELECT::get_explain(MEM_ROOT *local_alloc)
 }
 
 
+Explain_quick_select*
+QUICK_SKIP_SCAN_SELECT::get_explain(MEM_ROOT *local_alloc)
+{
+  Explain_quick_select *res;
+  if ((res= new (local_alloc) Explain_quick_select(QS_TYPE_SKIP_SCAN)))
+    res->range.set(local_alloc, &head->key_info[index], max_used_key_length);
+  return res;
+}
+
+
 Explain_quick_select*
 QUICK_INDEX_SORT_SELECT::get_explain(MEM_ROOT *local_alloc)
 {
@@ -12353,6 +12519,19 @@ void QUICK_GROUP_MIN_MAX_SELECT::add_used_key_part_to_set()
 }
 
 
+void QUICK_SKIP_SCAN_SELECT::add_used_key_part_to_set()
+{
+  uint key_len;
+  KEY_PART_INFO *part= index_info->key_part;
+  for (key_len=0; key_len < max_used_key_length;
+       key_len += (part++)->store_length)
+  {
+    Field *field= head->field[part->field->field_index];
+    field->register_field_in_read_map();
+  }
+}
+
+
 void QUICK_ROR_INTERSECT_SELECT::add_used_key_part_to_set()
 {
   List_iterator_fast<QUICK_SELECT_WITH_RECORD> it(quick_selects);
@@ -14856,10 +15035,437 @@ void QUICK_GROUP_MIN_MAX_SELECT::add_keys_and_lengths(String *key_names,
 }
 
 
-/* Check whether the number for equality ranges exceeds the set threshold */ 
+/*******************************************************************************
+* Implementation of QUICK_SKIP_SCAN_SELECT
+*******************************************************************************/
+
+/*
+  Find the best skip scan over an index without conditions on its prefix
+
+  SYNOPSIS
+    get_best_skip_scan()
+    param     Parameter from test_quick_select
+    tree      SEL_TREE with the range conditions of the query
+    read_time Best read time so far (=table/index scan time)
+
+  DESCRIPTION
+    A skip scan is possible over an index when the range tree of the index
+    starts at a key part p > 0. The scan then enumerates the distinct values
+    of the first p key parts and reads the ranges of the tree for each of
+    them.
+
+    The number of distinct prefixes is taken from the index statistics,
+    indexes without statistics on the prefix are not considered. The rows
+    read for each prefix are estimated as rec_per_key of the first key part
+    after the prefix for every single-point interval over it, and a third of
+    the rows with the prefix for any other interval. Every prefix costs one
+    index lookup to find it and one more for each range.
+
+  RETURN
+    Plan for the cheapest skip scan, if it is cheaper than read_time
+    NULL otherwise
+*/
+
+static TRP_SKIP_SCAN *
+get_best_skip_scan(PARAM *param, SEL_TREE *tree, double read_time)
+{
+  TABLE *table= param->table;
+  double table_records= rows2double(table->stat_records());
+  SEL_ARG *key_to_read= NULL;
+  uint UNINIT_VAR(best_idx);
+  ha_rows UNINIT_VAR(best_records);
+  TRP_SKIP_SCAN *read_plan= NULL;
+  DBUG_ENTER("get_best_skip_scan");
+
+  if (table_records < 1)
+    DBUG_RETURN(NULL);
+
+  for (uint idx= 0; idx < param->keys; idx++)
+  {
+    SEL_ARG *key= tree->keys[idx];
+    uint keynr= param->real_keynr[idx];
+    KEY *index_info= table->key_info + keynr;
+    const ulong need_flags= HA_READ_NEXT | HA_READ_ORDER | HA_READ_RANGE;
+
+    if (!key || !key->part || key->type != SEL_ARG::KEY_RANGE ||
+        key->maybe_flag || key->part >= index_info->user_defined_key_parts ||
+        (index_info->flags & HA_SPATIAL) ||
+        (table->file->index_flags(keynr, key->part, 1) & need_flags) !=
+          need_flags)
+      continue;
+
+    double keys_per_prefix= index_info->actual_rec_per_key(key->part - 1);
+    if (keys_per_prefix < 2)
+      continue;                           /* No statistics or no gain */
+    double num_prefixes= table_records / keys_per_prefix + 1;
+    double keys_per_value= index_info->actual_rec_per_key(key->part);
+    if (keys_per_value == 0)
+      keys_per_value= keys_per_prefix / 10 + 1;
+
+    double rows_per_prefix= 0;
+    uint n_ranges= 0;
+    for (SEL_ARG *arg= key->first(); arg; arg= arg->next)
+    {
+      n_ranges++;
+      rows_per_prefix+= arg->is_singlepoint() ? keys_per_value :
+                                                keys_per_prefix / 3;
+    }
+    set_if_smaller(rows_per_prefix, keys_per_prefix);
+    double rows= MY_MIN(num_prefixes * rows_per_prefix, table_records);
+    set_if_bigger(rows, 1);
+
+    /* One lookup to find each prefix, and one for each of its ranges */
+    double lookups= num_prefixes * (n_ranges + 1);
+    if (lookups >= table_records)
+      continue;
+
+    uint keys_per_block= (uint) (table->file->stats.block_size / 2 /
+                                 (index_info->key_length +
+                                  table->file->ref_length) + 1);
+    const double tree_traversal_cost=
+      ceil(log(table_records) / log((double) keys_per_block)) *
+      1/double(2*TIME_FOR_COMPARE);
+    double io_cost;
+    if (table->covering_keys.is_set(keynr))
+      io_cost= lookups + rows / keys_per_block;
+    else
+      io_cost= table->file->read_time(keynr, (uint) lookups,
+                                      double2rows(rows));
+    double cost= io_cost + lookups * tree_traversal_cost +
+                 rows / TIME_FOR_COMPARE;
+
+    DBUG_PRINT("info", ("index %s: prefixes %g  ranges %u  rows %g  cost %g",
+                        index_info->name.str, num_prefixes, n_ranges, rows,
+                        cost));
+    if (cost < read_time)
+    {
+      read_time= cost;
+      key_to_read= key;
+      best_idx= idx;
+      best_records= double2rows(rows);
+    }
+  }
+
+  if (key_to_read &&
+      (read_plan= new (param->mem_root) TRP_SKIP_SCAN(key_to_read, best_idx)))
+  {
+    read_plan->read_cost= read_time;
+    read_plan->records= best_records;
+    read_plan->is_ror= FALSE;
+    DBUG_PRINT("info", ("Returning skip scan plan for key %s, cost %g, "
+                        "records %lu",
+                        table->key_info[param->real_keynr[best_idx]].name.str,
+                        read_plan->read_cost, (ulong) read_plan->records));
+  }
+  DBUG_RETURN(read_plan);
+}
+
+
+/*
+  Construct a new quick select for a skip scan
+
+  SYNOPSIS
+    TRP_SKIP_SCAN::make_quick()
+    param              Parameter from test_quick_select
+    retrieve_full_rows ignored
+    parent_alloc       ignored, the quick select is never merged
+
+  NOTES
+    The ranges over the key parts after the prefix are built by
+    get_quick_keys() as for a range scan. Their keypart maps include the
+    prefix, as the tree starts at key part #prefix_key_parts.
+
+  RETURN
+    New QUICK_SKIP_SCAN_SELECT object if successfully created,
+    NULL otherwise.
+*/
+
+QUICK_SELECT_I *TRP_SKIP_SCAN::make_quick(PARAM *param,
+                                          bool retrieve_full_rows,
+                                          MEM_ROOT *parent_alloc)
+{
+  QUICK_SKIP_SCAN_SELECT *quick;
+  DBUG_ENTER("TRP_SKIP_SCAN::make_quick");
+
+  if (!(quick= new QUICK_SKIP_SCAN_SELECT(param->thd, param->table,
+                                          param->real_keynr[key_idx],
+                                          key->part, read_cost, records)))
+    DBUG_RETURN(NULL);
+
+  if (!(quick->quick_ranges= get_quick_select(param, key_idx, key,
+                                              HA_MRR_USE_DEFAULT_IMPL, 0,
+                                              &quick->alloc)))
+  {
+    delete quick;
+    DBUG_RETURN(NULL);
+  }
+  quick->used_key_parts= quick->quick_ranges->used_key_parts;
+  quick->max_used_key_length+= quick->quick_ranges->max_used_key_length;
+  DBUG_RETURN(quick);
+}
+
+
+/*
+  Construct a new quick select for a skip scan
+
+  SYNOPSIS
+    QUICK_SKIP_SCAN_SELECT::QUICK_SKIP_SCAN_SELECT()
+    thd                   Thread handle
+    table                 The table being accessed
+    use_index             The index chosen for data access
+    prefix_key_parts_arg  Number of the first key parts skipped over
+    read_cost             Cost of this access method
+    records               Number of records returned
+
+  NOTES
+    Like get_quick_select(), this changes thd->mem_root to the MEM_ROOT of
+    the quick select.
+*/
+
+QUICK_SKIP_SCAN_SELECT::
+QUICK_SKIP_SCAN_SELECT(THD *thd, TABLE *table, uint use_index,
+                       uint prefix_key_parts_arg, double read_cost,
+                       ha_rows records_arg)
+  :file(table->file), index_info(table->key_info + use_index),
+   prefix_key_parts(prefix_key_parts_arg), prefix(NULL),
+   min_key(NULL), max_key(NULL), cur_range(NULL), last_range(NULL),
+   seen_first_key(FALSE), have_prefix(FALSE), in_range(FALSE),
+   quick_ranges(NULL)
+{
+  head=       table;
+  index=      use_index;
+  record=     head->record[0];
+  read_time=  read_cost;
+  records=    records_arg;
+  prefix_len= 0;
+  for (uint part= 0; part < prefix_key_parts; part++)
+    prefix_len+= index_info->key_part[part].store_length;
+  used_key_parts= prefix_key_parts;
+  max_used_key_length= prefix_len;
+
+  init_sql_alloc(&alloc, "QUICK_SKIP_SCAN_SELECT",
+                 thd->variables.range_alloc_block_size, 0,
+                 MYF(MY_THREAD_SPECIFIC));
+  thd->mem_root= &alloc;
+}
+
+
+int QUICK_SKIP_SCAN_SELECT::init()
+{
+  if (prefix) /* Already initialized. */
+    return 0;
+  /*
+    One byte more for the fields compared with uint3korr(), see
+    QUICK_GROUP_MIN_MAX_SELECT::init()
+  */
+  if (!(prefix= (uchar*) alloc_root(&alloc, prefix_len + 1)) ||
+      !(min_key= (uchar*) alloc_root(&alloc, max_used_key_length + 1)) ||
+      !(max_key= (uchar*) alloc_root(&alloc, max_used_key_length + 1)))
+    return 1;
+  return 0;
+}
+
+
+QUICK_SKIP_SCAN_SELECT::~QUICK_SKIP_SCAN_SELECT()
+{
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::~QUICK_SKIP_SCAN_SELECT");
+  if (file->inited != handler::NONE)
+  {
+    DBUG_ASSERT(file == head->file);
+    file->ha_index_or_rnd_end();
+  }
+  delete quick_ranges;
+  free_root(&alloc, MYF(0));
+  DBUG_VOID_RETURN;
+}
+
+
+int QUICK_SKIP_SCAN_SELECT::reset(void)
+{
+  int result;
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::reset");
+
+  seen_first_key= have_prefix= in_range= FALSE;
+  if (file->inited == handler::RND && (result= file->ha_rnd_end()))
+    DBUG_RETURN(result);
+  if (file->inited == handler::NONE &&
+      (result= file->ha_index_init(index, 1)))
+  {
+    file->print_error(result, MYF(0));
+    DBUG_RETURN(result);
+  }
+  last_range= ((QUICK_RANGE**) quick_ranges->ranges.buffer) +
+              quick_ranges->ranges.elements;
+  DBUG_RETURN(0);
+}
+
+
+void QUICK_SKIP_SCAN_SELECT::range_end()
+{
+  if (file->inited != handler::NONE)
+    file->ha_index_or_rnd_end();
+}
+
+
+/*
+  Find the next distinct value of the prefix
+
+  DESCRIPTION
+    The first key with a greater prefix than the current one is read into
+    this->record, and its prefix is stored in this->prefix.
+
+  RETURN
+    0                  on success
+    HA_ERR_END_OF_FILE if there are no more keys
+    other              if some error occurred
+*/
+
+int QUICK_SKIP_SCAN_SELECT::next_prefix()
+{
+  int result;
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::next_prefix");
+
+  /*
+    The end of the last range must not stop the lookup when the index
+    condition is checked by the engine.
+  */
+  file->set_end_range(NULL);
+  if (!seen_first_key)
+    result= file->ha_index_first(record);
+  else
+    result= file->ha_index_read_map(record, prefix,
+                                    make_prev_keypart_map(prefix_key_parts),
+                                    HA_READ_AFTER_KEY);
+  if (result)
+    DBUG_RETURN(result == HA_ERR_KEY_NOT_FOUND ? HA_ERR_END_OF_FILE : result);
+
+  seen_first_key= TRUE;
+  key_copy(prefix, record, index_info, prefix_len);
+  memcpy(min_key, prefix, prefix_len);
+  memcpy(max_key, prefix, prefix_len);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Get the next row of the skip scan
+
+  DESCRIPTION
+    The ranges are read one by one for the current prefix, then the next
+    prefix is looked up and the ranges are read again for it.
+
+  RETURN
+    0                  on success
+    HA_ERR_END_OF_FILE if all rows have been returned
+    other              if some error occurred
+*/
+
+int QUICK_SKIP_SCAN_SELECT::get_next()
+{
+  int result;
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::get_next");
+
+  for (;;)
+  {
+    if (in_range)
+      result= file->read_range_next();
+    else
+    {
+      if (!have_prefix)
+      {
+        if ((result= next_prefix()))
+          DBUG_RETURN(result);
+        have_prefix= TRUE;
+        cur_range= (QUICK_RANGE**) quick_ranges->ranges.buffer;
+      }
+      if (cur_range == last_range)
+      {
+        have_prefix= FALSE;
+        continue;
+      }
+
+      QUICK_RANGE *range= *cur_range;
+      key_range start_key, end_key;
+      memcpy(min_key + prefix_len, range->min_key, range->min_length);
+      memcpy(max_key + prefix_len, range->max_key, range->max_length);
+      range->make_min_endpoint(&start_key);
+      range->make_max_endpoint(&end_key);
+      start_key.key= min_key;
+      start_key.length+= prefix_len;
+      start_key.keypart_map|= make_prev_keypart_map(prefix_key_parts);
+      end_key.key= max_key;
+      end_key.length+= prefix_len;
+      end_key.keypart_map|= make_prev_keypart_map(prefix_key_parts);
+
+      result= file->read_range_first(&start_key, &end_key, FALSE, TRUE);
+      in_range= TRUE;
+    }
+
+    if (result != HA_ERR_END_OF_FILE)
+      DBUG_RETURN(result);
+    in_range= FALSE;
+    cur_range++;
+  }
+}
+
+
+void QUICK_SKIP_SCAN_SELECT::add_keys_and_lengths(String *key_names,
+                                                  String *used_lengths)
+{
+  bool first= TRUE;
+
+  add_key_and_length(key_names, used_lengths, &first);
+}
+
+
+/*
+  Get the number of key parts with the same value at both ends of a range
+
+  SYNOPSIS
+    range_eq_prefix_key_parts()
+    key_info  The index of the range
+    range     The range
+
+  DESCRIPTION
+    For ranges like "kp1 = c1 AND kp2 < c2" this is the number of the first
+    key parts compared with equalities, whose rec_per_key bounds the number
+    of rows in the range. Prefixes with NULL values are not counted.
+
+  RETURN
+    Number of the first key parts of the range that are equalities
+*/
+
+uint range_eq_prefix_key_parts(const KEY *key_info,
+                               const KEY_MULTI_RANGE *range)
+{
+  if (range->range_flag & (NULL_RANGE | GEOM_FLAG))
+    return 0;
+  if (range->range_flag & EQ_RANGE)
+    return my_count_bits(range->start_key.keypart_map);
+
+  key_part_map map= range->start_key.keypart_map &
+                    range->end_key.keypart_map;
+  const KEY_PART_INFO *key_part= key_info->key_part;
+  uint parts= 0, offset= 0;
+  for (; map & 1; map>>= 1, key_part++, parts++)
+  {
+    if ((key_part->null_bit && range->start_key.key[offset]) ||
+        memcmp(range->start_key.key + offset, range->end_key.key + offset,
+               key_part->store_length))
+      break;
+    offset+= key_part->store_length;
+  }
+  return parts;
+}
+
+
+/*
+  Check whether the number of ranges with an equality prefix exceeds
+  the set threshold
+*/
 
 bool eq_ranges_exceeds_limit(RANGE_SEQ_IF *seq, void *seq_init_param,
-                             uint limit)
+                             const KEY *key_info, uint limit)
 {
   KEY_MULTI_RANGE range;
   range_seq_t seq_it;
@@ -14873,7 +15479,7 @@ bool eq_ranges_exceeds_limit(RANGE_SEQ_IF *seq, void *seq_init_param,
   seq_it= seq->init(seq_init_param, 0, 0);
   while (!seq->next(seq_it, &range))
   {
-    if ((range.range_flag & EQ_RANGE) && !(range.range_flag & NULL_RANGE))
+    if (range_eq_prefix_key_parts(key_info, &range))
     {
       if (++count >= limit)
         return true;
@@ -15129,4 +15735,18 @@ void QUICK_GROUP_MIN_MAX_SELECT::dbug_dump(int indent, bool verbose)
   }
 }
 
+
+void QUICK_SKIP_SCAN_SELECT::dbug_dump(int indent, bool verbose)
+{
+  fprintf(DBUG_FILE,
+          "%*squick_skip_scan_select: index %s (%d), prefix key parts: %d\n",
+          indent, "", index_info->name.str, index, prefix_key_parts);
+  if (quick_ranges)
+  {
+    fprintf(DBUG_FILE, "%*susing ranges of quick_range_select:\n",
+            indent, "");
+    quick_ranges->dbug_dump(indent + 2, verbose);
+  }
+}
+
 #endif /* !DBUG_OFF */
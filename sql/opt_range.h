@@ -926,7 +926,8 @@ class QUICK_SELECT_I
     QS_TYPE_FULLTEXT   = 4,
     QS_TYPE_ROR_INTERSECT = 5,
     QS_TYPE_ROR_UNION = 6,
-    QS_TYPE_GROUP_MIN_MAX = 7
+    QS_TYPE_GROUP_MIN_MAX = 7,
+    QS_TYPE_SKIP_SCAN = 8
   };
 
   /* Get type of this quick select - one of the QS_TYPE_* values */
@@ -1138,6 +1139,7 @@ class QUICK_RANGE_SELECT : public QUICK_SELECT_I
   friend class QUICK_ROR_INTERSECT_SELECT;
   friend class QUICK_INDEX_INTERSECT_SELECT;
   friend class QUICK_GROUP_MIN_MAX_SELECT;
+  friend class QUICK_SKIP_SCAN_SELECT;
   friend bool quick_range_seq_next(range_seq_t rseq, KEY_MULTI_RANGE *range);
   friend range_seq_t quick_range_seq_init(void *init_param,
                                           uint n_ranges, uint flags);
@@ -1593,6 +1595,68 @@ class QUICK_GROUP_MIN_MAX_SELECT : public QUICK_SELECT_I
 };
 
 
+/*
+  Index scan that skips over the distinct values of the first key parts.
+
+  The quick select is used when there are range conditions on the key parts
+  following a prefix of the index, but none on the prefix itself, e.g. for
+  "WHERE b > 10" with an index on (a,b). For every distinct value of the
+  prefix the rows are read from the ranges on the following key parts with
+  that value prepended to the range endpoints:
+
+    for each distinct prefix value p in index order
+      for each range [min,max] over the key parts after the prefix
+        read the rows from (p,min) to (p,max)
+
+  The next prefix value is found with one index lookup past the current
+  value, so the scan pays off when the prefix has few distinct values. The
+  rows are returned in index order.
+*/
+
+class QUICK_SKIP_SCAN_SELECT : public QUICK_SELECT_I
+{
+private:
+  handler * const file;   /* The handler used to get data. */
+  KEY  *index_info;       /* The index chosen for data access */
+  uint prefix_key_parts;  /* Number of key parts skipped over */
+  uint prefix_len;        /* Length of the skipped key prefix */
+  uchar *prefix;          /* Current value of the prefix, in key format */
+  uchar *min_key, *max_key; /* Range endpoints with the prefix prepended */
+  QUICK_RANGE **cur_range;  /* Current range for the current prefix */
+  QUICK_RANGE **last_range; /* End of the ranges */
+  bool seen_first_key;    /* Denotes whether the first key was retrieved */
+  bool have_prefix;       /* The ranges are being read for this->prefix */
+  bool in_range;          /* A range has been started with read_range_first */
+  int next_prefix();
+public:
+  MEM_ROOT alloc; /* Memory pool for this and quick_ranges data */
+  /*
+    Ranges over the key parts after the prefix. Only the ranges of this
+    quick select are used, it never reads rows itself.
+  */
+  QUICK_RANGE_SELECT *quick_ranges;
+
+  QUICK_SKIP_SCAN_SELECT(THD *thd, TABLE *table, uint use_index,
+                         uint prefix_key_parts_arg, double read_cost,
+                         ha_rows records);
+  ~QUICK_SKIP_SCAN_SELECT();
+  int init();
+  void need_sorted_output() { /* always do it */ }
+  int reset();
+  int get_next();
+  void range_end();
+  bool reverse_sorted() { return false; }
+  bool unique_key_range() { return false; }
+  int get_type() { return QS_TYPE_SKIP_SCAN; }
+  void add_keys_and_lengths(String *key_names, String *used_lengths);
+  void add_used_key_part_to_set();
+#ifndef DBUG_OFF
+  void dbug_dump(int indent, bool verbose);
+#endif
+  Explain_quick_select *get_explain(MEM_ROOT *alloc);
+};
+
+
 class QUICK_SELECT_DESC: public QUICK_RANGE_SELECT
 {
 public:
@@ -1724,8 +1788,10 @@ SQL_SELECT *make_select(TABLE *head, table_map const_tables,
 
 bool calculate_cond_selectivity_for_table(THD *thd, TABLE *table, Item **cond);
 
+uint range_eq_prefix_key_parts(const KEY *key_info,
+                               const KEY_MULTI_RANGE *range);
 bool eq_ranges_exceeds_limit(RANGE_SEQ_IF *seq, void *seq_init_param,
-                             uint limit);
+                             const KEY *key_info, uint limit);
 
 #ifdef WITH_PARTITION_STORAGE_ENGINE
 bool prune_partitions(THD *thd, TABLE *table, Item *pprune_cond);
@@ -798,6 +798,20 @@ bool Protocol::send_result_set_metadata(List<Item> *list, uint flags)
   CHARSET_INFO *thd_charset= thd->variables.character_set_results;
   DBUG_ENTER("Protocol::send_result_set_metadata");
 
+  /*
+    Grow the network buffer for the rows, so that a large result set is
+    sent in net_send_buffer_size chunks. This is only possible while no
+    data is buffered, as net_realloc() discards it. If the buffer can't
+    grow, net_realloc() has already reported the error.
+  */
+  if (thd->variables.net_send_buffer_size > thd->net.max_packet &&
+      thd->net.write_pos == thd->net.buff &&
+      thd->net.max_packet < thd->net.max_packet_size - 1 &&
+      net_realloc(&thd->net,
+                  MY_MIN(thd->variables.net_send_buffer_size,
+                         thd->net.max_packet_size - 1)))
+    DBUG_RETURN(1);
+
   if (flags & SEND_NUM_ROWS)
   {				// Packet with number of elements
     uchar buff[MAX_INT_WIDTH];
@@ -0,0 +1,438 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include "mariadb.h"
+#include "rpl_prefetch.h"
+#include "slave.h"
+#include "rpl_mi.h"
+#include "sql_parse.h"
+
+/*
+  Read-ahead of the relay log for the slave SQL thread.
+
+  The prefetch thread follows the SQL thread in the relay log, staying at
+  most --slave-prefetch-window bytes ahead of the start of the event group
+  the SQL thread is currently applying. For every row event it opens the
+  table, unpacks the before image (after image for inserts) and does a
+  primary key lookup, which pulls the index pages the applier is about to
+  modify into the buffer pool. See Rows_log_event::prefetch().
+
+  The prefetcher has its own IO_CACHE on the relay log files and does not
+  take LOCK_log while reading, so it may see a partially written event at
+  the end of the active relay log. In that case it just waits and re-reads
+  from the same position.
+*/
+
+
+/* How long to sleep when there is nothing to prefetch, in microseconds. */
+#define PREFETCH_IDLE_WAIT_USEC 10000
+
+
+rpl_prefetch::rpl_prefetch()
+  : rli(NULL), thd(NULL), stop_requested(false), running(false),
+    log_pos(0), file(-1), description_event(NULL)
+{
+  log_name[0]= 0;
+  mysql_mutex_init(key_LOCK_rpl_prefetch, &LOCK_rpl_prefetch,
+                   MY_MUTEX_INIT_SLOW);
+  mysql_cond_init(key_COND_rpl_prefetch, &COND_rpl_prefetch, NULL);
+}
+
+
+rpl_prefetch::~rpl_prefetch()
+{
+  DBUG_ASSERT(!running);
+  mysql_mutex_destroy(&LOCK_rpl_prefetch);
+  mysql_cond_destroy(&COND_rpl_prefetch);
+}
+
+
+/*
+  Start the prefetch thread for a slave SQL thread.
+
+  Returns true on error. Failure to start is not fatal for replication, the
+  SQL thread just runs without read-ahead.
+*/
+bool
+rpl_prefetch::start(Relay_log_info *rli_arg)
+{
+  pthread_t th;
+  DBUG_ENTER("rpl_prefetch::start");
+
+  mysql_mutex_lock(&LOCK_rpl_prefetch);
+  DBUG_ASSERT(!running);
+  rli= rli_arg;
+  stop_requested= false;
+  if (mysql_thread_create(key_rpl_prefetch_thread, &th, &connection_attrib,
+                          handle_rpl_prefetch_thread, this))
+  {
+    mysql_mutex_unlock(&LOCK_rpl_prefetch);
+    sql_print_warning("Failed to start the relay log prefetch thread");
+    DBUG_RETURN(true);
+  }
+  while (!running)
+    mysql_cond_wait(&COND_rpl_prefetch, &LOCK_rpl_prefetch);
+  mysql_mutex_unlock(&LOCK_rpl_prefetch);
+  DBUG_RETURN(false);
+}
+
+
+/*
+  Stop the prefetch thread and wait for it to exit. Does nothing if the
+  thread is not running.
+*/
+void
+rpl_prefetch::stop()
+{
+  DBUG_ENTER("rpl_prefetch::stop");
+  mysql_mutex_lock(&LOCK_rpl_prefetch);
+  if (running)
+  {
+    stop_requested= true;
+    if (thd)
+      thd->awake(KILL_CONNECTION);
+    mysql_cond_broadcast(&COND_rpl_prefetch);
+    while (running)
+      mysql_cond_wait(&COND_rpl_prefetch, &LOCK_rpl_prefetch);
+  }
+  mysql_mutex_unlock(&LOCK_rpl_prefetch);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Sleep for up to usec microseconds, or until stop() is called.
+  Returns true if the thread should exit.
+*/
+bool
+rpl_prefetch::wait(ulong usec)
+{
+  struct timespec abstime;
+  bool stop_now;
+
+  set_timespec_nsec(abstime, (ulonglong)usec * 1000);
+  mysql_mutex_lock(&LOCK_rpl_prefetch);
+  if (!stop_requested)
+    mysql_cond_timedwait(&COND_rpl_prefetch, &LOCK_rpl_prefetch, &abstime);
+  stop_now= stop_requested;
+  mysql_mutex_unlock(&LOCK_rpl_prefetch);
+  return stop_now;
+}
+
+
+void
+rpl_prefetch::close_log()
+{
+  if (file >= 0)
+  {
+    end_io_cache(&cache);
+    mysql_file_close(file, MYF(MY_WME));
+    file= -1;
+  }
+  delete description_event;
+  description_event= NULL;
+  log_name[0]= 0;
+  log_pos= 0;
+}
+
+
+/*
+  Open a relay log file and position at pos.
+
+  The file is scanned from the start up to pos to find the format
+  description events that apply at that position, the same way
+  init_relay_log_pos() does it for the SQL thread.
+
+  Returns true on error.
+*/
+bool
+rpl_prefetch::open_log(const char *name, my_off_t pos)
+{
+  const char *errmsg;
+  DBUG_ENTER("rpl_prefetch::open_log");
+
+  close_log();
+  if ((file= open_binlog(&cache, name, &errmsg)) < 0)
+    DBUG_RETURN(true);
+  strmake_buf(log_name, name);
+  description_event= new Format_description_log_event(3);
+
+  while (my_b_tell(&cache) < pos)
+  {
+    Log_event *ev= Log_event::read_log_event(&cache, description_event,
+                                             opt_slave_sql_verify_checksum);
+    if (!ev)
+      goto err;
+    if (ev->get_type_code() == FORMAT_DESCRIPTION_EVENT)
+    {
+      Format_description_log_event *new_fdle=
+        (Format_description_log_event*) ev;
+      new_fdle->copy_crypto_data(description_event);
+      delete description_event;
+      description_event= new_fdle;
+      continue;
+    }
+    if (ev->get_type_code() == START_ENCRYPTION_EVENT &&
+        description_event->start_decryption((Start_encryption_log_event*) ev))
+    {
+      delete ev;
+      goto err;
+    }
+    delete ev;
+  }
+  if (my_b_tell(&cache) != pos)
+    goto err;
+  log_pos= pos;
+  DBUG_RETURN(false);
+
+err:
+  close_log();
+  DBUG_RETURN(true);
+}
+
+
+/*
+  Compare our position with the SQL thread's.
+
+  If we are behind the SQL thread (or have nothing open yet), jump to the
+  start of the event group it is applying. Returns true if we should not
+  read anything right now, either because we are a full window ahead or
+  because the relay log could not be opened.
+*/
+bool
+rpl_prefetch::sync_with_sql_thread(rpl_group_info *rgi)
+{
+  char sql_log_name[FN_REFLEN];
+  my_off_t sql_log_pos;
+  int cmp;
+
+  mysql_mutex_lock(&rli->data_lock);
+  strmake_buf(sql_log_name, rli->group_relay_log_name);
+  sql_log_pos= rli->group_relay_log_pos;
+  mysql_mutex_unlock(&rli->data_lock);
+
+  if (!sql_log_name[0])
+    return true;
+
+  /*
+    Relay log names only differ in the zero-padded numeric extension, so a
+    string compare orders them correctly.
+  */
+  cmp= file < 0 ? -1 : strcmp(log_name, sql_log_name);
+  if (cmp < 0 || (cmp == 0 && log_pos < sql_log_pos))
+  {
+    if (rgi->tables_to_lock)
+      end_statement(rgi);
+    if (cmp == 0)
+    {
+      my_b_seek(&cache, sql_log_pos);
+      log_pos= sql_log_pos;
+      return false;
+    }
+    return open_log(sql_log_name, sql_log_pos);
+  }
+
+  if (cmp == 0)
+    return log_pos - sql_log_pos >= opt_slave_prefetch_window;
+  /*
+    We are already in a later relay log file. We do not know how much is
+    left in the SQL thread's file, so just count what we read in ours.
+  */
+  return log_pos >= opt_slave_prefetch_window;
+}
+
+
+/*
+  Read the next event from the relay log, switching to the next relay log
+  file when we reach the end of one that is no longer being written to.
+
+  Returns NULL if there is nothing to read right now.
+*/
+Log_event *
+rpl_prefetch::read_event()
+{
+  Log_event *ev;
+  bool active;
+  mysql_mutex_t *log_lock= rli->relay_log.get_log_lock();
+
+  /*
+    Check this before reading; if the log is rotated after the check, we
+    just try once more before moving on to the next file.
+  */
+  mysql_mutex_lock(log_lock);
+  active= rli->relay_log.is_active(log_name);
+  mysql_mutex_unlock(log_lock);
+
+  if ((ev= Log_event::read_log_event(&cache, description_event,
+                                     opt_slave_sql_verify_checksum)))
+  {
+    log_pos= my_b_tell(&cache);
+    return ev;
+  }
+
+  if (!active)
+  {
+    LOG_INFO linfo;
+    if (!rli->relay_log.find_log_pos(&linfo, log_name, 1) &&
+        !rli->relay_log.find_next_log(&linfo, 1))
+      open_log(linfo.log_file_name, BIN_LOG_HEADER_SIZE);
+    return NULL;
+  }
+
+  /*
+    End of the active log, or an event that is not fully written yet. Drop
+    whatever the cache has read so far and retry from the same place later.
+  */
+  cache.error= 0;
+  reinit_io_cache(&cache, READ_CACHE, log_pos, 0, 0);
+  return NULL;
+}
+
+
+/*
+  Close the tables and forget the table maps of the current statement.
+*/
+void
+rpl_prefetch::end_statement(rpl_group_info *rgi)
+{
+  rgi->slave_close_thread_tables(thd);
+  rgi->m_table_map.clear_tables();
+  thd->clear_error();
+  free_root(thd->mem_root, MYF(MY_KEEP_PREALLOC));
+}
+
+
+void
+rpl_prefetch::handle_event(rpl_group_info *rgi, Log_event *ev)
+{
+  Log_event_type typ= ev->get_type_code();
+
+  if (typ == FORMAT_DESCRIPTION_EVENT)
+  {
+    Format_description_log_event *new_fdle=
+      (Format_description_log_event*) ev;
+    new_fdle->copy_crypto_data(description_event);
+    delete description_event;
+    description_event= new_fdle;
+    return;
+  }
+
+  if (typ == START_ENCRYPTION_EVENT)
+    description_event->start_decryption((Start_encryption_log_event*) ev);
+  else if (typ == TABLE_MAP_EVENT)
+  {
+    /* A new statement starts while the previous one is still open. */
+    if (thd->lock)
+      end_statement(rgi);
+    ev->thd= thd;
+    if (ev->prefetch(rgi))
+      end_statement(rgi);
+  }
+  else if (LOG_EVENT_IS_WRITE_ROW(typ) || LOG_EVENT_IS_UPDATE_ROW(typ) ||
+           LOG_EVENT_IS_DELETE_ROW(typ))
+  {
+    Rows_log_event *rev= (Rows_log_event*) ev;
+    ev->thd= thd;
+    if ((rgi->tables_to_lock && rev->prefetch(rgi)) ||
+        rev->get_flags(Rows_log_event::STMT_END_F))
+      end_statement(rgi);
+  }
+  else if (typ != ANNOTATE_ROWS_EVENT && rgi->tables_to_lock)
+    end_statement(rgi);
+
+  delete ev;
+}
+
+
+pthread_handler_t
+handle_rpl_prefetch_thread(void *arg)
+{
+  THD *thd;
+  rpl_group_info *rgi;
+  rpl_prefetch *pf= (rpl_prefetch *)arg;
+  Relay_log_info *rli= pf->rli;
+  rpl_sql_thread_info sql_info(rli->mi->rpl_filter);
+
+  my_thread_init();
+  thd= new THD(next_thread_id());
+  thd->thread_stack= (char*)&thd;
+  add_to_active_threads(thd);
+  set_current_thd(thd);
+  pthread_detach_this_thread();
+  thd->init_for_queries();
+  thd->variables.binlog_annotate_row_events= 0;
+  init_thr_lock();
+  thd->store_globals();
+  thd->system_thread= SYSTEM_THREAD_SLAVE_BACKGROUND;
+  thd->security_ctx->skip_grants();
+  thd->variables.max_allowed_packet= slave_max_allowed_packet;
+  thd->system_thread_info.rpl_sql_info= &sql_info;
+  /*
+    We only look rows up to bring their pages into memory, so the cheapest
+    isolation level will do; it needs no read view and takes no row locks.
+    Do not wait long for metadata locks either: if DDL holds the table, the
+    SQL thread will not be able to use the prefetched pages soon anyway.
+  */
+  thd->variables.tx_isolation= ISO_READ_UNCOMMITTED;
+  thd->variables.lock_wait_timeout= 1;
+  thd->variables.option_bits&= ~OPTION_BIN_LOG;
+  thd_proc_info(thd, "Prefetching rows from the relay log");
+
+  rgi= new rpl_group_info(rli);
+  rgi->thd= thd;
+
+  mysql_mutex_lock(&pf->LOCK_rpl_prefetch);
+  pf->thd= thd;
+  pf->running= true;
+  mysql_cond_broadcast(&pf->COND_rpl_prefetch);
+  mysql_mutex_unlock(&pf->LOCK_rpl_prefetch);
+
+  thd->set_command(COM_SLAVE_WORKER);
+  while (!pf->stop_requested && !thd->killed)
+  {
+    Log_event *ev;
+    if (pf->sync_with_sql_thread(rgi) || !(ev= pf->read_event()))
+    {
+      if (pf->wait(PREFETCH_IDLE_WAIT_USEC))
+        break;
+      continue;
+    }
+    pf->handle_event(rgi, ev);
+  }
+
+  pf->end_statement(rgi);
+  pf->close_log();
+  delete rgi;
+
+  mysql_mutex_lock(&pf->LOCK_rpl_prefetch);
+  pf->thd= NULL;
+  mysql_mutex_unlock(&pf->LOCK_rpl_prefetch);
+
+  thd->clear_error();
+  thd->catalog= 0;
+  thd->reset_query();
+  thd->reset_db(&null_clex_str);
+  THD_CHECK_SENTRY(thd);
+  unlink_not_visible_thd(thd);
+  delete thd;
+
+  mysql_mutex_lock(&pf->LOCK_rpl_prefetch);
+  pf->running= false;
+  mysql_cond_broadcast(&pf->COND_rpl_prefetch);
+  mysql_mutex_unlock(&pf->LOCK_rpl_prefetch);
+
+  my_thread_end();
+  return NULL;
+}
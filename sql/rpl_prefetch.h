@@ -0,0 +1,77 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef RPL_PREFETCH_H
+#define RPL_PREFETCH_H
+
+#include "log_event.h"
+
+
+class Relay_log_info;
+struct rpl_group_info;
+
+
+/*
+  Relay log prefetcher.
+
+  When --slave-prefetch-window is non-zero, each SQL thread starts a helper
+  thread that reads the relay log ahead of the applier. For row events, it
+  unpacks the row images and looks up the affected rows by primary key, so
+  that the pages the SQL thread is about to modify are already in the
+  storage engine's buffer pool by the time the event is applied.
+
+  The prefetcher never modifies anything. It reads with READ UNCOMMITTED
+  isolation and only holds metadata locks while looking up the rows of a
+  single statement, so it cannot block the applier for long. Any error it
+  runs into (missing table, definition mismatch, truncated event, ...) is
+  silently ignored: the worst outcome is that the SQL thread has to read the
+  page from disk itself, as it would without prefetching.
+*/
+struct rpl_prefetch {
+  mysql_mutex_t LOCK_rpl_prefetch;
+  mysql_cond_t COND_rpl_prefetch;
+  Relay_log_info *rli;
+  THD *thd;
+  /* Set by stop() to ask the prefetch thread to exit. */
+  bool stop_requested;
+  /* True while the prefetch thread is alive. */
+  bool running;
+
+  /* Current read position of the prefetcher in the relay log. */
+  char log_name[FN_REFLEN];
+  my_off_t log_pos;
+  IO_CACHE cache;
+  File file;
+  Format_description_log_event *description_event;
+
+  rpl_prefetch();
+  ~rpl_prefetch();
+  bool start(Relay_log_info *rli_arg);
+  void stop();
+
+  /* Helpers used by the prefetch thread itself. */
+  bool open_log(const char *name, my_off_t pos);
+  void close_log();
+  bool sync_with_sql_thread(rpl_group_info *rgi);
+  Log_event *read_event();
+  void handle_event(rpl_group_info *rgi, Log_event *ev);
+  void end_statement(rpl_group_info *rgi);
+  bool wait(ulong usec);
+};
+
+
+pthread_handler_t handle_rpl_prefetch_thread(void *arg);
+
+#endif  /* RPL_PREFETCH_H */
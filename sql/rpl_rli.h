@@ -24,6 +24,7 @@
 #include "sql_class.h"                   /* THD */
 #include "log_event.h"
 #include "rpl_parallel.h"
+#include "rpl_prefetch.h"
 
 struct RPL_TABLE_LIST;
 class Master_info;
@@ -370,6 +371,8 @@ class Relay_log_info : public Slave_reporting_capability
   size_t slave_patternload_file_size;  
 
   rpl_parallel parallel;
+  /* Relay log read-ahead, active when --slave-prefetch-window > 0. */
+  rpl_prefetch prefetch;
   /*
     The relay_log_state keeps track of the current binlog state of the
     execution of the relay log. This is used to know where to resume
@@ -984,6 +984,23 @@ table_def::compatible_with(THD *thd, rpl_group_info *rgi,
 }
 
 
+bool
+table_def::same_types_as(Relay_log_info *rli, TABLE *table) const
+{
+  uint const cols_to_check= MY_MIN(table->s->fields, size());
+
+  for (uint col= 0 ; col < cols_to_check ; ++col)
+  {
+    int order;
+    if (!can_convert_field_to(table->field[col], type(col),
+                              field_metadata(col), rli, m_flags, &order) ||
+        order != 0)
+      return false;
+  }
+  return true;
+}
+
+
 /**
   A wrapper to Virtual_tmp_table, to get access to its constructor,
   which is protected for safety purposes (against illegal use on stack).
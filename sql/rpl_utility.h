@@ -191,6 +191,23 @@ class table_def
   bool compatible_with(THD *thd, rpl_group_info *rgi, TABLE *table,
                       TABLE **conv_table_var) const;
 
+  /**
+    Check if rows can be unpacked straight into @c table, that is, each
+    column the master and slave tables have in common has the same type
+    and size, so no conversion table is needed.
+
+    Unlike compatible_with(), this does not report anything to the
+    relay log info; it is meant for callers that can just skip tables
+    that would need conversion.
+
+    @param rli   Pointer to relay log info
+    @param table Pointer to table to compare with.
+
+    @retval true  if no conversion is needed
+    @retval false otherwise
+  */
+  bool same_types_as(Relay_log_info *rli, TABLE *table) const;
+
   /**
    Create a virtual in-memory temporary table structure.
 
@@ -5492,6 +5492,9 @@ pthread_handler_t handle_slave_sql(void *arg)
   }
   mysql_mutex_unlock(&rli->data_lock);
 
+  if (opt_slave_prefetch_window)
+    rli->prefetch.start(rli);
+
   /* Read queries from the IO/THREAD until this thread is killed */
 
   thd->set_command(COM_SLAVE_SQL);
@@ -5548,6 +5551,7 @@ pthread_handler_t handle_slave_sql(void *arg)
   }
 
  err:
+  rli->prefetch.stop();
   if (mi->using_parallel())
     rli->parallel.wait_for_done(thd, rli);
 
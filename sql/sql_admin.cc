@@ -32,6 +32,7 @@
 #include "strfunc.h"
 #include "sql_admin.h"
 #include "sql_statistics.h"
+#include "sql_plan_cache.h"                  // plan_cache_flush
 
 /* Prepare, run and cleanup for mysql_recreate_table() */
 
@@ -1313,6 +1314,8 @@ bool Sql_cmd_analyze_table::execute(THD *thd)
   res= mysql_admin_table(thd, first_table, &m_lex->check_opt,
                          "analyze", lock_type, 1, 0, 0, 0,
                          &handler::ha_analyze, 0);
+  /* Join orders were chosen with the old statistics */
+  plan_cache_flush();
   /* ! we write after unlocking the table */
   if (!res && !m_lex->no_write_to_binlog)
   {
@@ -1708,6 +1708,9 @@ void add_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var)
   to_var->table_open_cache_hits+= from_var->table_open_cache_hits;
   to_var->table_open_cache_misses+= from_var->table_open_cache_misses;
   to_var->table_open_cache_overflows+= from_var->table_open_cache_overflows;
+  to_var->table_definition_cache_hits+= from_var->table_definition_cache_hits;
+  to_var->table_definition_cache_misses+=
+    from_var->table_definition_cache_misses;
 
   /*
     Update global_memory_used. We have to do this with atomic_add as the
@@ -1765,6 +1768,12 @@ void add_diff_to_status(STATUS_VAR *to_var, STATUS_VAR *from_var,
                                     dec_var->table_open_cache_misses;
   to_var->table_open_cache_overflows+= from_var->table_open_cache_overflows -
                                        dec_var->table_open_cache_overflows;
+  to_var->table_definition_cache_hits+=
+    from_var->table_definition_cache_hits -
+    dec_var->table_definition_cache_hits;
+  to_var->table_definition_cache_misses+=
+    from_var->table_definition_cache_misses -
+    dec_var->table_definition_cache_misses;
 
   /*
     We don't need to accumulate memory_used as these are not reset or used by
@@ -599,6 +599,7 @@ typedef struct system_variables
   ulong net_interactive_timeout;
   ulong net_read_timeout;
   ulong net_retry_count;
+  ulong net_send_buffer_size;
   ulong net_wait_timeout;
   ulong net_write_timeout;
   ulong optimizer_prune_level;
@@ -608,6 +609,7 @@ typedef struct system_variables
   ulong use_stat_tables;
   ulong histogram_size;
   ulong histogram_type;
+  ulong analyze_threads;
   ulong preload_buff_size;
   ulong profiling_history_size;
   ulong read_buff_size;
@@ -662,6 +664,7 @@ typedef struct system_variables
   my_bool big_tables;
   my_bool only_standard_compliant_cte;
   my_bool query_cache_strip_comments;
+  my_bool plan_cache_text_queries;
   my_bool sql_log_slow;
   my_bool sql_log_bin;
   /*
@@ -712,6 +715,7 @@ typedef struct system_variables
   ulong wsrep_retry_autocommit;
   ulong wsrep_OSU_method;
   double long_query_time_double, max_statement_time_double;
+  double analyze_sample_percentage;
 
   my_bool pseudo_slave_mode;
 
@@ -815,6 +819,8 @@ typedef struct system_status_var
   ulong filesort_rows_;
   ulong filesort_scan_count_;
   ulong filesort_pq_sorts_;
+  ulong plan_cache_hits;
+  ulong plan_cache_misses;
 
   /* Features used */
   ulong feature_custom_aggregate_functions; /* +1 when custom aggregate
@@ -860,6 +866,8 @@ typedef struct system_status_var
   ulonglong table_open_cache_hits;
   ulonglong table_open_cache_misses;
   ulonglong table_open_cache_overflows;
+  ulonglong table_definition_cache_hits;
+  ulonglong table_definition_cache_misses;
   double last_query_cost;
   double cpu_time, busy_time;
   uint32 threads_running;
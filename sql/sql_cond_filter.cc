@@ -0,0 +1,366 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Fast evaluation of simple conditions on table rows, see sql_cond_filter.h
+*/
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "item_cmpfunc.h"
+#include "sql_cond_filter.h"
+
+typedef Cond_filter::Predicate Predicate;
+typedef Cond_filter::check_func check_func;
+
+/*
+  Readers of the column types that are handled. They return the value the
+  same way as Field::val_int() and Field::val_real() of the type do.
+*/
+
+struct Read_tiny
+{ static longlong read(const uchar *ptr) { return (signed char) *ptr; } };
+struct Read_utiny
+{ static longlong read(const uchar *ptr) { return *ptr; } };
+struct Read_short
+{ static longlong read(const uchar *ptr) { return sint2korr(ptr); } };
+struct Read_ushort
+{ static longlong read(const uchar *ptr) { return uint2korr(ptr); } };
+struct Read_medium
+{ static longlong read(const uchar *ptr) { return sint3korr(ptr); } };
+struct Read_umedium
+{ static longlong read(const uchar *ptr) { return uint3korr(ptr); } };
+struct Read_long
+{ static longlong read(const uchar *ptr) { return sint4korr(ptr); } };
+struct Read_ulong
+{ static longlong read(const uchar *ptr) { return uint4korr(ptr); } };
+struct Read_longlong
+{ static longlong read(const uchar *ptr) { return sint8korr(ptr); } };
+struct Read_ulonglong
+{ static ulonglong read(const uchar *ptr) { return uint8korr(ptr); } };
+
+struct Read_float
+{
+  static double read(const uchar *ptr)
+  {
+    float nr;
+    float4get(nr, ptr);
+    return (double) nr;
+  }
+};
+
+struct Read_double
+{
+  static double read(const uchar *ptr)
+  {
+    double nr;
+    float8get(nr, ptr);
+    return nr;
+  }
+};
+
+
+template <typename T> struct Op_eq
+{ static bool test(T a, T b) { return a == b; } };
+template <typename T> struct Op_ne
+{ static bool test(T a, T b) { return a != b; } };
+template <typename T> struct Op_lt
+{ static bool test(T a, T b) { return a < b; } };
+template <typename T> struct Op_le
+{ static bool test(T a, T b) { return a <= b; } };
+template <typename T> struct Op_gt
+{ static bool test(T a, T b) { return a > b; } };
+template <typename T> struct Op_ge
+{ static bool test(T a, T b) { return a >= b; } };
+
+
+template <typename T> static inline T constant_value(const Predicate *pred);
+template <> inline longlong constant_value<longlong>(const Predicate *pred)
+{ return pred->int_value; }
+template <> inline ulonglong constant_value<ulonglong>(const Predicate *pred)
+{ return (ulonglong) pred->int_value; }
+template <> inline double constant_value<double>(const Predicate *pred)
+{ return pred->real_value; }
+
+
+static inline bool column_is_null(const Predicate *pred)
+{
+  return pred->null_ptr && (*pred->null_ptr & pred->null_bit);
+}
+
+
+/* column <op> constant, compared as T */
+
+template <class R, typename T, class Op>
+static bool check_compare(const Predicate *pred)
+{
+  return !column_is_null(pred) &&
+         Op::test((T) R::read(pred->ptr), constant_value<T>(pred));
+}
+
+
+static bool check_not_null(const Predicate *pred)
+{
+  return !column_is_null(pred);
+}
+
+
+static bool check_item(const Predicate *pred)
+{
+  return pred->item->val_bool();
+}
+
+
+template <class R, typename T>
+static check_func compare_func(Item_func::Functype op)
+{
+  switch (op) {
+  case Item_func::EQ_FUNC: return check_compare<R, T, Op_eq<T> >;
+  case Item_func::NE_FUNC: return check_compare<R, T, Op_ne<T> >;
+  case Item_func::LT_FUNC: return check_compare<R, T, Op_lt<T> >;
+  case Item_func::LE_FUNC: return check_compare<R, T, Op_le<T> >;
+  case Item_func::GT_FUNC: return check_compare<R, T, Op_gt<T> >;
+  case Item_func::GE_FUNC: return check_compare<R, T, Op_ge<T> >;
+  default:
+    break;
+  }
+  return NULL;
+}
+
+
+/* The function that compares a column of this type as T */
+
+template <typename T>
+static check_func compare_func(const Field *field, Item_func::Functype op)
+{
+  bool is_unsigned= ((const Field_num *) field)->unsigned_flag;
+  switch (field->type()) {
+  case MYSQL_TYPE_TINY:
+    return is_unsigned ? compare_func<Read_utiny, T>(op) :
+                         compare_func<Read_tiny, T>(op);
+  case MYSQL_TYPE_SHORT:
+    return is_unsigned ? compare_func<Read_ushort, T>(op) :
+                         compare_func<Read_short, T>(op);
+  case MYSQL_TYPE_INT24:
+    return is_unsigned ? compare_func<Read_umedium, T>(op) :
+                         compare_func<Read_medium, T>(op);
+  case MYSQL_TYPE_LONG:
+    return is_unsigned ? compare_func<Read_ulong, T>(op) :
+                         compare_func<Read_long, T>(op);
+  case MYSQL_TYPE_LONGLONG:
+    return is_unsigned ? compare_func<Read_ulonglong, T>(op) :
+                         compare_func<Read_longlong, T>(op);
+  case MYSQL_TYPE_FLOAT:
+    return compare_func<Read_float, T>(op);
+  case MYSQL_TYPE_DOUBLE:
+    return compare_func<Read_double, T>(op);
+  default:
+    break;
+  }
+  return NULL;
+}
+
+
+static bool is_handled_type(const Field *field)
+{
+  switch (field->type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_LONGLONG:
+  case MYSQL_TYPE_FLOAT:
+  case MYSQL_TYPE_DOUBLE:
+    return field->real_type() == field->type();
+  default:
+    break;
+  }
+  return FALSE;
+}
+
+
+static Item_func::Functype swap_operands(Item_func::Functype op)
+{
+  switch (op) {
+  case Item_func::LT_FUNC: return Item_func::GT_FUNC;
+  case Item_func::LE_FUNC: return Item_func::GE_FUNC;
+  case Item_func::GT_FUNC: return Item_func::LT_FUNC;
+  case Item_func::GE_FUNC: return Item_func::LE_FUNC;
+  default:
+    break;
+  }
+  return op;
+}
+
+
+/**
+  Try to prepare a conjunct for evaluation on the record buffer
+
+  @param item   the conjunct
+  @param table  table whose rows are checked
+  @param pred   [out] the prepared predicate
+
+  @retval TRUE   done
+  @retval FALSE  the conjunct has to be evaluated with val_bool()
+*/
+
+static bool prepare_predicate(Item *item, TABLE *table, Predicate *pred)
+{
+  Item_func *func;
+  Item *column, *value;
+  Field *field;
+  Item_func::Functype op;
+  const Item_const *constant;
+
+  if (item->type() != Item::FUNC_ITEM)
+    return FALSE;
+  func= (Item_func *) item;
+  op= func->functype();
+
+  if (op == Item_func::ISNOTNULL_FUNC)
+  {
+    column= func->arguments()[0];
+    if (column->type() != Item::FIELD_ITEM ||
+        (field= ((Item_field *) column)->field)->table != table)
+      return FALSE;
+    pred->check= check_not_null;
+    pred->null_ptr= field->null_ptr;
+    pred->null_bit= field->null_bit;
+    return TRUE;
+  }
+
+  switch (op) {
+  case Item_func::EQ_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    break;
+  default:
+    return FALSE;
+  }
+
+  column= func->arguments()[0];
+  value= func->arguments()[1];
+  if (column->type() != Item::FIELD_ITEM)
+  {
+    swap_variables(Item *, column, value);
+    op= swap_operands(op);
+  }
+  if (column->type() != Item::FIELD_ITEM ||
+      (field= ((Item_field *) column)->field)->table != table ||
+      !is_handled_type(field) ||
+      !(constant= value->get_item_const()) || constant->const_is_null())
+    return FALSE;
+
+  pred->ptr= field->ptr;
+  pred->null_ptr= field->null_ptr;
+  pred->null_bit= field->null_bit;
+
+  switch (((Item_bool_rowready_func2 *) func)->compare_type_handler()->
+          cmp_type()) {
+  case INT_RESULT:
+  {
+    const longlong *nr= constant->const_ptr_longlong();
+    if (!nr || field->result_type() != INT_RESULT)
+      return FALSE;
+    pred->int_value= *nr;
+    if (((Field_num *) field)->unsigned_flag &&
+        field->type() == MYSQL_TYPE_LONGLONG)
+    {
+      /* Compare as unsigned, the constant must not be negative */
+      if (!value->unsigned_flag && *nr < 0)
+        return FALSE;
+      pred->check= compare_func<ulonglong>(field, op);
+    }
+    else
+    {
+      /* All values of the column are in the range of longlong */
+      if (value->unsigned_flag && *nr < 0)
+        return FALSE;
+      pred->check= compare_func<longlong>(field, op);
+    }
+    break;
+  }
+  case REAL_RESULT:
+  {
+    const longlong *nr;
+    const double *real;
+    /* Arg_comparator::compare_real_fixed() compares with precision */
+    if (column->decimals < NOT_FIXED_DEC && value->decimals < NOT_FIXED_DEC)
+      return FALSE;
+    if ((real= constant->const_ptr_double()))
+      pred->real_value= *real;
+    else if ((nr= constant->const_ptr_longlong()))
+      pred->real_value= value->unsigned_flag ?
+                        ulonglong2double((ulonglong) *nr) : (double) *nr;
+    else
+      return FALSE;
+    pred->check= compare_func<double>(field, op);
+    break;
+  }
+  default:
+    return FALSE;
+  }
+  return pred->check != NULL;
+}
+
+
+/**
+  Prepare a condition for evaluation on the rows of a table
+
+  @param thd    thread handle
+  @param cond   the condition
+  @param table  the table whose rows are checked
+
+  @return the filter, or NULL if no part of the condition can be
+          evaluated faster than with cond->val_int()
+*/
+
+Cond_filter *Cond_filter::create(THD *thd, Item *cond, TABLE *table)
+{
+  Predicate *preds;
+  uint count= 1, prepared= 0;
+  List_iterator_fast<Item> it;
+  Item *item;
+  bool is_and= (cond->type() == Item::COND_ITEM &&
+                ((Item_cond *) cond)->functype() == Item_func::COND_AND_FUNC);
+
+  if (is_and)
+  {
+    count= ((Item_cond *) cond)->argument_list()->elements;
+    it.init(*((Item_cond *) cond)->argument_list());
+  }
+  if (!count ||
+      !(preds= (Predicate *) thd->calloc(sizeof(Predicate) * count)))
+    return NULL;
+
+  for (uint i= 0; i < count; i++)
+  {
+    item= is_and ? it++ : cond;
+    if (prepare_predicate(item, table, preds + i))
+      prepared++;
+    else
+    {
+      preds[i].check= check_item;
+      preds[i].item= item;
+    }
+  }
+  if (!prepared)
+    return NULL;
+  return new (thd->mem_root) Cond_filter(preds, count);
+}
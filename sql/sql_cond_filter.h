@@ -0,0 +1,87 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_COND_FILTER_INCLUDED
+#define SQL_COND_FILTER_INCLUDED
+
+/*
+  Cond_filter: a condition attached to a table, prepared for fast
+  evaluation on every row read from the table.
+
+  The condition is split into its conjuncts. A conjunct that compares a
+  numeric column of the table with a constant
+
+    column {=|<>|<|<=|>|>=} constant,  constant {...} column,
+    column IS NOT NULL
+
+  is checked by a function that reads the column directly from the record
+  buffer and compares it with a copy of the constant, with the same result
+  as Arg_comparator would give. This replaces the chain of virtual
+  val_int() calls through the Item tree. Other conjuncts are evaluated
+  with val_bool(), as Item_cond_and does, in their original order.
+
+  A Cond_filter is built for one execution of a statement: the constants
+  are copied when it is created.
+*/
+
+class Item;
+struct TABLE;
+
+class Cond_filter: public Sql_alloc
+{
+public:
+  struct Predicate;
+  typedef bool (*check_func)(const Predicate *pred);
+
+  struct Predicate
+  {
+    check_func check;
+    Item *item;                   /* Evaluated with val_bool() if set */
+    const uchar *ptr;             /* Column value in the record */
+    const uchar *null_ptr;        /* NULL if the column is NOT NULL */
+    uchar null_bit;
+    longlong int_value;
+    double real_value;
+  };
+
+  static Cond_filter *create(THD *thd, Item *cond, TABLE *table);
+
+  /**
+    Check the current row of the table
+
+    @retval TRUE   the condition is true
+    @retval FALSE  the condition is false or NULL
+  */
+  bool check() const
+  {
+    for (const Predicate *pred= m_preds, *end= m_preds + m_count;
+         pred < end; pred++)
+    {
+      if (!pred->check(pred))
+        return FALSE;
+    }
+    return TRUE;
+  }
+
+private:
+  Cond_filter(Predicate *preds, uint count)
+    :m_preds(preds), m_count(count)
+  {}
+
+  Predicate *m_preds;
+  uint m_count;
+};
+
+#endif /* SQL_COND_FILTER_INCLUDED */
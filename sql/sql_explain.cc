@@ -894,6 +894,28 @@ void Explain_select::print_explain_json(Explain_query *query,
       writer->add_member("r_total_time_ms").add_double(time_tracker.get_time_ms());
     }
 
+    if (is_analyze && reoptimized_tables.elements)
+    {
+      List_iterator<Explain_reoptimized_table> it(reoptimized_tables);
+      Explain_reoptimized_table *tbl;
+      char namebuf[NAME_LEN];
+      writer->add_member("r_reoptimization").start_object();
+      writer->add_member("derived_tables").start_array();
+      while ((tbl= it++))
+      {
+        my_snprintf(namebuf, sizeof(namebuf) - 1, "<derived%u>",
+                    tbl->derived_select_number);
+        writer->start_object();
+        writer->add_member("table_name").add_str(namebuf);
+        writer->add_member("rows").add_ll(tbl->rows);
+        writer->add_member("r_rows").add_ll(tbl->r_rows);
+        writer->end_object();
+      }
+      writer->end_array();
+      writer->add_member("join_order_changed").add_bool(reoptimized_join_order);
+      writer->end_object();
+    }
+
     if (exec_const_cond)
     {
       writer->add_member("const_condition");
@@ -1498,6 +1520,9 @@ void Explain_table_access::tag_to_json(Json_writer *writer, enum explain_extra_t
       else
         writer->add_bool(true);
       break;
+    case ET_USING_SKIP_SCAN:
+      writer->add_member("skip_scan").add_bool(true);
+      break;
 
     /*new:*/
     case ET_CONST_ROW_NOT_FOUND:
@@ -1727,6 +1752,8 @@ void Explain_table_access::print_explain_json(Explain_query *query,
     writer->add_member("join_type").add_str(bka_type.join_alg);
     if (bka_type.mrr_type.length())
       writer->add_member("mrr_type").add_str(bka_type.mrr_type);
+    if (bka_type.bloom_filter)
+      writer->add_member("bloom_filter").add_bool(true);
     if (where_cond)
     {
       writer->add_member("attached_condition");
@@ -1741,6 +1768,15 @@ void Explain_table_access::print_explain_json(Explain_query *query,
         writer->add_double(jbuf_tracker.get_filtered_after_where()*100.0);
       else
         writer->add_null();
+      if (bka_type.bloom_filter)
+      {
+        Table_access_tracker *tracker= &bka_type.bloom_filter_tracker;
+        writer->add_member("r_bloom_filtered");
+        if (tracker->has_scans())
+          writer->add_double(tracker->get_filtered_after_where()*100.0);
+        else
+          writer->add_null();
+      }
     }
   }
 
@@ -1808,6 +1844,7 @@ const char * extra_tag_text[]=
   "Scanned all databases",
 
   "Using index for group-by", // special handling
+  "Using skip scan",
 
   "USING MRR: DONT PRINT ME", // special handling
 
@@ -1905,7 +1942,8 @@ void Explain_quick_select::print_extra(String *str)
 {
   if (quick_type == QUICK_SELECT_I::QS_TYPE_RANGE || 
       quick_type == QUICK_SELECT_I::QS_TYPE_RANGE_DESC ||
-      quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)
+      quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX ||
+      quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
   {
     /* print nothing */
   }
@@ -1991,7 +2029,8 @@ void Explain_quick_select::print_key(String *str)
 {
   if (quick_type == QUICK_SELECT_I::QS_TYPE_RANGE || 
       quick_type == QUICK_SELECT_I::QS_TYPE_RANGE_DESC || 
-      quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)
+      quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX ||
+      quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
   {
     if (str->length() > 0)
       str->append(',');
@@ -2017,7 +2056,8 @@ void Explain_quick_select::print_key_len(String *str)
 {
   if (quick_type == QUICK_SELECT_I::QS_TYPE_RANGE || 
       quick_type == QUICK_SELECT_I::QS_TYPE_RANGE_DESC ||
-      quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)
+      quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX ||
+      quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
   {
     char buf[64];
     size_t length;
@@ -184,6 +184,24 @@ class Explain_basic_join : public Explain_node
 };
 
 
+/*
+  A materialized derived table that was filled before its join order was
+  finalized so that the join could be re-planned using the actual number of
+  rows in it instead of the estimate (the optimizer_switch flag
+  derived_reoptimization).
+*/
+
+class Explain_reoptimized_table : public Sql_alloc
+{
+public:
+  uint derived_select_number;
+  /* The estimate the join order was originally chosen with */
+  ha_rows rows;
+  /* The actual number of rows in the table */
+  ha_rows r_rows;
+};
+
+
 class Explain_aggr_node;
 /*
   EXPLAIN structure for a SELECT.
@@ -215,7 +233,8 @@ class Explain_select : public Explain_basic_join
     having(NULL), having_value(Item::COND_UNDEF),
     using_temporary(false), using_filesort(false),
     time_tracker(is_analyze),
-    aggr_tree(NULL)
+    aggr_tree(NULL),
+    reoptimized_join_order(false)
   {}
 
   void add_linkage(Json_writer *writer);
@@ -254,6 +273,11 @@ class Explain_select : public Explain_basic_join
   */
   Explain_aggr_node* aggr_tree;
 
+  /* Derived tables materialized to check the estimates of the join */
+  List<Explain_reoptimized_table> reoptimized_tables;
+  /* TRUE <=> the actual cardinalities changed the join order */
+  bool reoptimized_join_order;
+
   int print_explain(Explain_query *query, select_result_sink *output, 
                     uint8 explain_flags, bool is_analyze);
   void print_explain_json(Explain_query *query, Json_writer *writer, 
@@ -531,6 +555,7 @@ enum explain_extra_tag
   ET_SCANNED_ALL_DATABASES,
 
   ET_USING_INDEX_FOR_GROUP_BY,
+  ET_USING_SKIP_SCAN,
 
   ET_USING_MRR, // does not print "Using mrr". 
 
@@ -557,7 +582,7 @@ enum explain_extra_tag
 class EXPLAIN_BKA_TYPE
 {
 public:
-  EXPLAIN_BKA_TYPE() : join_alg(NULL) {}
+  EXPLAIN_BKA_TYPE() : join_alg(NULL), bloom_filter(false) {}
 
   size_t join_buffer_size;
 
@@ -571,6 +596,14 @@ class EXPLAIN_BKA_TYPE
 
   /* Information about MRR usage.  */
   StringBuffer<64> mrr_type;
+
+  /* TRUE <=> rows are checked against a bloom filter over the buffer */
+  bool bloom_filter;
+  /*
+    r_scans: the filter builds, r_rows: rows checked,
+    r_rows_after_where: rows that passed the filter
+  */
+  Table_access_tracker bloom_filter_tracker;
   
   bool is_using_jbuf() { return (join_alg != NULL); }
 };
@@ -619,7 +652,8 @@ class Explain_quick_select : public Sql_alloc
   {
     return (quick_type == QUICK_SELECT_I::QS_TYPE_RANGE || 
             quick_type == QUICK_SELECT_I::QS_TYPE_RANGE_DESC ||
-            quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX);
+            quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX ||
+            quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN);
   }
   
   /* This is used when quick_type == QUICK_SELECT_I::QS_TYPE_RANGE */
@@ -138,6 +138,16 @@ void Expression_cache_tmptable::init()
     goto error;
   }
 
+  /* The result may be a blob, but heap tables can't have keys on blobs */
+  for (Field **field= cache_table->field + 1; *field; field++)
+  {
+    if ((*field)->flags & BLOB_FLAG)
+    {
+      DBUG_PRINT("error", ("blob parameter, can't create index"));
+      goto error;
+    }
+  }
+
   field_counter= 1;
 
   if (cache_table->alloc_keys(1) ||
@@ -2247,6 +2247,9 @@ enum_nested_loop_state JOIN_CACHE::join_matching_records(bool skip_last)
   if ((rc= join_tab_execution_startup(join_tab)) < 0)
     goto finish2;
 
+  if (bloom_filter_keys)
+    build_bloom_filter();
+
   /* Prepare to retrieve all records of the joined table */
   if (unlikely((error= join_tab_scan->open())))
   { 
@@ -2266,6 +2269,10 @@ enum_nested_loop_state JOIN_CACHE::join_matching_records(bool skip_last)
       goto finish; 
     }
 
+    /* Skip the record if no record from the join buffer can match it */
+    if (bloom_filter_keys && !bloom_filter_may_match())
+      continue;
+
     if (join_tab->keep_current_rowid)
       join_tab->table->file->position(join_tab->table->record[0]);
     
@@ -2556,6 +2563,299 @@ enum_nested_loop_state JOIN_CACHE::join_null_complements(bool skip_last)
 }
 
 
+/*
+  Collect the equalities that must hold for any match of join_tab
+
+  SYNOPSIS
+    collect_join_key_equalities()
+      cond       the condition to look through
+      guard      the guard of the conjuncts that are always on when matches
+                 are looked for, or NULL
+      eqs    OUT the list to add the found equalities to
+
+  DESCRIPTION
+    The function adds to 'eqs' the equality predicates that are conjuncts of
+    'cond', including those that are wrapped into a trigger condition
+    with the guard 'guard'.
+
+  RETURN VALUE
+    TRUE    out of memory
+    FALSE   otherwise
+*/
+
+static bool collect_join_key_equalities(THD *thd, Item *cond, bool *guard,
+                                        List<Item_func_eq> *eqs)
+{
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond*) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator_fast<Item> li(*((Item_cond*) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+    {
+      if (collect_join_key_equalities(thd, item, guard, eqs))
+        return TRUE;
+    }
+    return FALSE;
+  }
+  if (cond->type() != Item::FUNC_ITEM)
+    return FALSE;
+  Item_func *func= (Item_func*) cond;
+  if (func->functype() == Item_func::TRIG_COND_FUNC && guard &&
+      ((Item_func_trig_cond*) func)->get_trig_var() == guard)
+    return collect_join_key_equalities(thd, func->arguments()[0], guard, eqs);
+  if (func->functype() == Item_func::EQ_FUNC)
+    return eqs->push_back((Item_func_eq*) func, thd->mem_root);
+  return FALSE;
+}
+
+
+/*
+  Check whether equal values of the arguments of an equality have equal hashes
+
+  DESCRIPTION
+    The bloom filter hashes the integer values of the join keys compared
+    as integers and the strings compared with the collation of both of them.
+    Other comparisons (e.g. of doubles or temporal values) may find equal
+    values with different binary images and are not used for the filter.
+*/
+
+static bool is_hashable_join_key_pair(Item_func_eq *eq, Item *a, Item *b)
+{
+  Item_result type= eq->compare_type_handler()->cmp_type();
+  CHARSET_INFO *cs= eq->compare_collation();
+  if (a->cmp_type() != type || b->cmp_type() != type)
+    return FALSE;
+  if (type == INT_RESULT)
+    return TRUE;
+  return type == STRING_RESULT &&
+         a->collation.collation == cs && b->collation.collation == cs;
+}
+
+
+/*
+  Find the equalities the bloom filter over the join buffer can use
+
+  SYNOPSIS
+    setup_bloom_filter()
+
+  DESCRIPTION
+    The function looks through the conjuncts of the condition that is checked
+    for the matches of join_tab for equalities between an expression over
+    join_tab and an expression over the tables whose records are stored
+    in the join buffers. The found equalities are used to build a bloom
+    filter over the join keys of the records in the join buffer every time
+    the buffer is refilled. A row of join_tab whose join key is not found in
+    the filter cannot match any record from the buffer. Such rows are skipped
+    right after they have been read, which saves the look through all records
+    of the buffer done by the BNL algorithm for each row of join_tab.
+    When join_tab is the first inner table of an outer join the conjuncts
+    guarded by join_tab->not_null_compl are used too: the guard is always on
+    when the matches are looked for.
+
+  RETURN VALUE
+    0   ok, including the case when no equalities can be used
+    1   out of memory
+*/
+
+bool JOIN_CACHE::setup_bloom_filter()
+{
+  THD *thd= join->thd;
+  Item *cond= join_tab->select ? join_tab->select->cond : NULL;
+  table_map buffered_tables= 0;
+  List<Item_func_eq> eqs;
+  DBUG_ENTER("JOIN_CACHE::setup_bloom_filter");
+
+  bloom_filter_keys= 0;
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_JOIN_CACHE_BLOOM_FILTER) || !cond)
+    DBUG_RETURN(0);
+
+  if (collect_join_key_equalities(thd, cond,
+                                  join_tab->is_first_inner_for_outer_join() ?
+                                  &join_tab->not_null_compl : NULL,
+                                  &eqs))
+    DBUG_RETURN(1);
+  if (eqs.is_empty())
+    DBUG_RETURN(0);
+
+  for (JOIN_CACHE *cache= this; cache; cache= cache->prev_cache)
+  {
+    for (JOIN_TAB *tab= cache->start_tab; tab != cache->join_tab;
+         tab= next_linear_tab(join, tab, WITHOUT_BUSH_ROOTS))
+      buffered_tables|= tab->table->map;
+  }
+
+  if (!(bloom_filter_outer_keys=
+          (Item **) thd->alloc(sizeof(Item *) * eqs.elements * 2)))
+    DBUG_RETURN(1);
+  bloom_filter_inner_keys= bloom_filter_outer_keys + eqs.elements;
+
+  List_iterator_fast<Item_func_eq> it(eqs);
+  Item_func_eq *eq;
+  while ((eq= it++))
+  {
+    for (uint i= 0; i < 2; i++)
+    {
+      Item *inner_key= eq->arguments()[i];
+      Item *outer_key= eq->arguments()[1 - i];
+      table_map outer_tables= outer_key->used_tables() &
+                              ~join->const_table_map;
+      if ((inner_key->used_tables() & ~join->const_table_map) !=
+            join_tab->table->map ||
+          !outer_tables || (outer_tables & ~buffered_tables) ||
+          !is_hashable_join_key_pair(eq, outer_key, inner_key))
+        continue;
+      bloom_filter_outer_keys[bloom_filter_keys]= outer_key;
+      bloom_filter_inner_keys[bloom_filter_keys]= inner_key;
+      bloom_filter_keys++;
+      break;
+    }
+  }
+  DBUG_RETURN(0);
+}
+
+
+/* Mix the bits of a hash value of the join keys */
+
+static inline ulonglong bloom_filter_mix_hash(ulonglong nr)
+{
+  nr^= nr >> 33;
+  nr*= 0xff51afd7ed558ccdULL;
+  nr^= nr >> 33;
+  nr*= 0xc4ceb9fe1a85ec53ULL;
+  nr^= nr >> 33;
+  return nr;
+}
+
+
+/*
+  Get the hash of the join keys of the bloom filter
+
+  SYNOPSIS
+    get_bloom_filter_hash()
+      keys      either bloom_filter_outer_keys or bloom_filter_inner_keys
+      nr   OUT  the hash value
+
+  RETURN VALUE
+    TRUE    one of the keys is NULL, so the equalities cannot be true
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE::get_bloom_filter_hash(Item **keys, ulonglong *nr)
+{
+  ulonglong hash= 0;
+  for (uint i= 0; i < bloom_filter_keys; i++)
+  {
+    Item *key= keys[i];
+    ulonglong key_nr;
+    if (key->cmp_type() == INT_RESULT)
+    {
+      key_nr= (ulonglong) key->val_int();
+      if (key->null_value)
+        return TRUE;
+    }
+    else
+    {
+      CHARSET_INFO *cs= key->collation.collation;
+      String *str= key->val_str(&bloom_filter_str);
+      ulong nr1= 1, nr2= 4;
+      if (!str)
+        return TRUE;
+      cs->coll->hash_sort(cs, (const uchar *) str->ptr(), str->length(),
+                          &nr1, &nr2);
+      key_nr= nr1;
+    }
+    hash= bloom_filter_mix_hash(hash ^ key_nr);
+  }
+  *nr= hash;
+  return FALSE;
+}
+
+
+/*
+  Build the bloom filter over all records in the join buffer
+
+  DESCRIPTION
+    The function reads all records from the join buffer into the record
+    buffers and sets two bits of the filter for the join key of each of them.
+    The filter has at least 8 bits per record, which gives about 5% of false
+    positives. If the memory for the filter cannot be allocated the rows of
+    join_tab are not filtered.
+*/
+
+void JOIN_CACHE::build_bloom_filter()
+{
+  ulonglong bits= 64;
+  size_t length;
+  DBUG_ENTER("JOIN_CACHE::build_bloom_filter");
+
+  bloom_filter_mask= 0;
+  while (bits < (ulonglong) records * 8)
+    bits<<= 1;
+  length= (size_t) (bits / 8);
+  if (length > bloom_filter_alloced)
+  {
+    my_free(bloom_filter);
+    bloom_filter_alloced= 0;
+    if (!(bloom_filter= (uchar *) my_malloc(length, MYF(MY_THREAD_SPECIFIC))))
+      DBUG_VOID_RETURN;
+    bloom_filter_alloced= length;
+  }
+  bzero(bloom_filter, length);
+
+  reset(FALSE);
+  for (size_t cnt= records; cnt; cnt--)
+  {
+    ulonglong nr;
+    get_record();
+    if (get_bloom_filter_hash(bloom_filter_outer_keys, &nr))
+      continue;
+    ulonglong bit1= nr & (bits - 1);
+    ulonglong bit2= (nr >> 32) & (bits - 1);
+    bloom_filter[bit1 / 8]|= (uchar) (1 << (bit1 % 8));
+    bloom_filter[bit2 / 8]|= (uchar) (1 << (bit2 % 8));
+  }
+  bloom_filter_mask= bits - 1;
+  if (bloom_filter_tracker)
+    bloom_filter_tracker->r_scans++;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Check whether the current row of join_tab can match a buffered record
+
+  RETURN VALUE
+    FALSE   the join key of the row is not in the bloom filter,
+            no record from the join buffer matches the row
+    TRUE    otherwise
+*/
+
+bool JOIN_CACHE::bloom_filter_may_match()
+{
+  ulonglong nr;
+  bool res;
+  if (!bloom_filter_mask)
+    return TRUE;
+  if (get_bloom_filter_hash(bloom_filter_inner_keys, &nr))
+    res= FALSE;
+  else
+  {
+    ulonglong bit1= nr & bloom_filter_mask;
+    ulonglong bit2= (nr >> 32) & bloom_filter_mask;
+    res= (bloom_filter[bit1 / 8] & (1 << (bit1 % 8))) &&
+         (bloom_filter[bit2 / 8] & (1 << (bit2 % 8)));
+  }
+  if (bloom_filter_tracker)
+  {
+    bloom_filter_tracker->r_rows++;
+    if (res)
+      bloom_filter_tracker->r_rows_after_where++;
+  }
+  return res;
+}
+
+
 /*
   Save data on the join algorithm employed by the join cache 
 
@@ -2579,6 +2879,9 @@ bool JOIN_CACHE::save_explain_data(EXPLAIN_BKA_TYPE *explain)
 
   explain->join_buffer_size= get_join_buffer_size();
 
+  explain->bloom_filter= MY_TEST(bloom_filter_keys);
+  bloom_filter_tracker= &explain->bloom_filter_tracker;
+
   switch (get_join_alg()) {
   case BNL_JOIN_ALG:
     explain->join_alg= "BNL";
@@ -2696,6 +2999,7 @@ int JOIN_CACHE_HASHED::init(bool for_explain)
 
   hash_func= &JOIN_CACHE_HASHED::get_hash_idx_simple;
   hash_cmp_func= &JOIN_CACHE_HASHED::equal_keys_simple;
+  set_fixed_key_funcs(key_length);
 
   KEY_PART_INFO *key_part= ref_key_info->key_part;
   KEY_PART_INFO *key_part_end= key_part+ref_used_key_parts;
@@ -3233,6 +3537,81 @@ bool JOIN_CACHE_HASHED::equal_keys_complex(uchar *key1, uchar *key2,
 }
 
 
+/*
+  Hash function for keys of the fixed length key_len compared as bytes
+
+  DESCRIPTION
+    The function is used instead of get_hash_idx_simple() for short keys,
+    as a common key of one or two integer columns. It returns the same
+    value, but as the length of the key is known at compile time the loop
+    over its bytes is unrolled.
+
+  RETURN VALUE
+    the calculated index of the hash entry for the given key
+*/
+
+template <uint key_len>
+uint JOIN_CACHE_HASHED::get_hash_idx_fixed(uchar *key,
+                                           uint not_used
+                                           __attribute__((unused)))
+{
+  ulong nr= 1;
+  ulong nr2= 4;
+  for (uint i= 0; i < key_len; i++)
+  {
+    nr^= (ulong) ((((uint) nr & 63)+nr2)*((uint) key[i]))+ (nr << 8);
+    nr2+= 3;
+  }
+  return nr % hash_entries;
+}
+
+
+/*
+  Compare two key entries of the fixed length key_len as bytes
+*/
+
+template <uint key_len>
+bool JOIN_CACHE_HASHED::equal_keys_fixed(uchar *key1, uchar *key2,
+                                         uint not_used
+                                         __attribute__((unused)))
+{
+  return memcmp(key1, key2, key_len) == 0;
+}
+
+
+/*
+  Use the hash and compare functions specialized for the key length
+
+  SYNOPSIS
+    set_fixed_key_funcs()
+      key_len         the length of the key values
+
+  DESCRIPTION
+    The function replaces get_hash_idx_simple() and equal_keys_simple()
+    with their versions for the given key length, if there are such.
+*/
+
+void JOIN_CACHE_HASHED::set_fixed_key_funcs(uint key_len)
+{
+  switch (key_len) {
+#define FIXED_KEY_FUNCS(N)                                        \
+  case N:                                                         \
+    hash_func= &JOIN_CACHE_HASHED::get_hash_idx_fixed<N>;         \
+    hash_cmp_func= &JOIN_CACHE_HASHED::equal_keys_fixed<N>;       \
+    break;
+  FIXED_KEY_FUNCS(1)  FIXED_KEY_FUNCS(2)  FIXED_KEY_FUNCS(3)
+  FIXED_KEY_FUNCS(4)  FIXED_KEY_FUNCS(5)  FIXED_KEY_FUNCS(6)
+  FIXED_KEY_FUNCS(7)  FIXED_KEY_FUNCS(8)  FIXED_KEY_FUNCS(9)
+  FIXED_KEY_FUNCS(10) FIXED_KEY_FUNCS(11) FIXED_KEY_FUNCS(12)
+  FIXED_KEY_FUNCS(13) FIXED_KEY_FUNCS(14) FIXED_KEY_FUNCS(15)
+  FIXED_KEY_FUNCS(16)
+#undef FIXED_KEY_FUNCS
+  default:
+    break;
+  }
+}
+
+
 /* 
   Clean up the hash table of the join buffer
 
@@ -3621,7 +4000,10 @@ int JOIN_CACHE_BNL::init(bool for_explain)
   if (!(join_tab_scan= new JOIN_TAB_SCAN(join, join_tab)))
     DBUG_RETURN(1);
 
-  DBUG_RETURN(JOIN_CACHE::init(for_explain));
+  if (JOIN_CACHE::init(for_explain))
+    DBUG_RETURN(1);
+
+  DBUG_RETURN(setup_bloom_filter());
 }
 
 
@@ -356,6 +356,28 @@ class JOIN_CACHE :public Sql_alloc
   */
   JOIN_TAB_SCAN *join_tab_scan;
 
+  /*
+    The join keys used to build a bloom filter over the records in the join
+    buffer: for each i the equality bloom_filter_outer_keys[i] =
+    bloom_filter_inner_keys[i] must hold for any match, the first expression
+    depends only on the tables stored in the join buffers, the second one
+    only on join_tab. A row of join_tab whose keys are not in the filter has
+    no matches in the buffer and is skipped without looking through it.
+  */
+  uint bloom_filter_keys;
+  Item **bloom_filter_outer_keys;
+  Item **bloom_filter_inner_keys;
+  /* The filter bitmap for the current content of the join buffer */
+  uchar *bloom_filter;
+  /* The number of bits in the filter minus 1, 0 when it's not built */
+  ulonglong bloom_filter_mask;
+  /* The number of bytes allocated for bloom_filter */
+  size_t bloom_filter_alloced;
+  /* Buffer for the values of string join keys */
+  StringBuffer<MAX_FIELD_WIDTH> bloom_filter_str;
+  /* ANALYZE counters of the rows checked against the filter and passed it */
+  Table_access_tracker *bloom_filter_tracker;
+
   void calc_record_fields();     
   void collect_info_on_key_args();
   int alloc_fields();
@@ -529,6 +551,15 @@ class JOIN_CACHE :public Sql_alloc
   /* Check matching to a partial join record from the join buffer */
   bool check_match(uchar *rec_ptr);
 
+  /* Find the equalities the bloom filter over the join buffer can use */
+  bool setup_bloom_filter();
+  /* Get the hash of the join keys of the bloom filter */
+  bool get_bloom_filter_hash(Item **keys, ulonglong *nr);
+  /* Build the bloom filter over all records in the join buffer */
+  void build_bloom_filter();
+  /* Check whether the current row of join_tab can match a buffered record */
+  bool bloom_filter_may_match();
+
   /* 
     This constructor creates an unlinked join cache. The cache is to be
     used to join table 'tab' to the result of joining the previous tables 
@@ -540,6 +571,11 @@ class JOIN_CACHE :public Sql_alloc
     join_tab= tab;
     prev_cache= next_cache= 0;
     buff= 0;
+    bloom_filter_keys= 0;
+    bloom_filter= 0;
+    bloom_filter_mask= 0;
+    bloom_filter_alloced= 0;
+    bloom_filter_tracker= 0;
   }
 
   /* 
@@ -555,6 +591,11 @@ class JOIN_CACHE :public Sql_alloc
     next_cache= 0;
     prev_cache= prev;
     buff= 0;
+    bloom_filter_keys= 0;
+    bloom_filter= 0;
+    bloom_filter_mask= 0;
+    bloom_filter_alloced= 0;
+    bloom_filter_tracker= 0;
     if (prev)
       prev->next_cache= this;
   }
@@ -672,6 +713,9 @@ class JOIN_CACHE :public Sql_alloc
   { 
     my_free(buff);
     buff= 0;
+    my_free(bloom_filter);
+    bloom_filter= 0;
+    bloom_filter_alloced= 0;
   }   
   
   friend class JOIN_CACHE_HASHED;
@@ -797,6 +841,13 @@ class JOIN_CACHE_HASHED: public JOIN_CACHE
   inline bool equal_keys_simple(uchar *key1, uchar *key2, uint key_len);
   inline bool equal_keys_complex(uchar *key1, uchar *key2, uint key_len);
 
+  /* Versions of the simple functions for keys of length key_len */
+  template <uint key_len>
+  uint get_hash_idx_fixed(uchar *key, uint not_used);
+  template <uint key_len>
+  bool equal_keys_fixed(uchar *key1, uchar *key2, uint not_used);
+  void set_fixed_key_funcs(uint key_len);
+
   int init_hash_table();
   void cleanup_hash_table();
   
@@ -706,6 +706,7 @@ void LEX::start(THD *thd_arg)
   column_list= NULL;
   index_list= NULL;
   prepared_stmt_params.empty();
+  plan_cache_key= null_clex_str;
   auxiliary_table_list.empty();
   unit.next= unit.master= unit.link_next= unit.return_to= 0;
   unit.prev= unit.link_prev= 0;
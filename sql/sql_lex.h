@@ -3192,6 +3192,11 @@ struct LEX: public Query_tables_list
   Item *prepared_stmt_code;
   /* Names of user variables holding parameters (in EXECUTE) */
   List<Item> prepared_stmt_params;
+  /*
+    Key of the statement in the plan cache (see sql_plan_cache.h), or
+    NULL if join orders of the statement are not cached
+  */
+  LEX_CSTRING plan_cache_key;
   sp_head *sphead;
   sp_name *spname;
   bool sp_lex_in_use;   // Keep track on lex usage in SPs for error handling
@@ -85,6 +85,7 @@
 #include "rpl_mi.h"
 
 #include "sql_digest.h"
+#include "sql_plan_cache.h"
 
 #include "sp_head.h"
 #include "sp.h"
@@ -8041,11 +8042,22 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
   if (query_cache_send_result_to_client(thd, rawbuf, length) <= 0)
   {
     LEX *lex= thd->lex;
+    bool plan_cache_digest= thd->m_digest && plan_cache_size &&
+                            thd->variables.plan_cache_text_queries;
+
+    if (plan_cache_digest)
+    {
+      /* The digest is the plan cache key, see plan_cache_set_digest_key() */
+      thd->m_digest->reset(thd->m_token_array, max_digest_length);
+      parser_state->m_input.m_compute_digest= true;
+    }
 
     bool err= parse_sql(thd, parser_state, NULL, true);
 
     if (likely(!err))
     {
+      if (plan_cache_digest)
+        plan_cache_set_digest_key(thd);
       thd->m_statement_psi=
         MYSQL_REFINE_STATEMENT(thd->m_statement_psi,
                                sql_statement_info[thd->lex->sql_command].
@@ -0,0 +1,356 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Join orders shared by all connections, see sql_plan_cache.h
+*/
+
+#include "mariadb.h"
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "sql_plan_cache.h"
+#include "sql_plist.h"
+#include "sql_digest.h"
+
+/*
+  A cached order is used only if the estimated number of rows of every
+  table is at most PLAN_CACHE_ROWS_FACTOR times (plus
+  PLAN_CACHE_ROWS_SLACK rows) different from the estimate it was found
+  with. The slack keeps small tables from invalidating the order all the
+  time.
+*/
+#define PLAN_CACHE_ROWS_FACTOR 2.0
+#define PLAN_CACHE_ROWS_SLACK  10.0
+
+/* Size of the optimizer settings appended to the statement key */
+#define PLAN_CACHE_KEY_SETTINGS (4 + 8 + 4 * 4)
+
+struct Plan_cache_table
+{
+  table_map map;
+  ulong ref_version;
+  ha_rows records;
+};
+
+
+/*
+  Join order of one SELECT. The key and the tables are allocated in the
+  same memory block, right after the object.
+*/
+
+class Plan_cache_entry
+{
+public:
+  Plan_cache_entry *next_in_lru, **prev_in_lru;
+  uchar *key;
+  size_t key_length;
+  table_map const_tables;
+  uint count;
+  /* Non-constant tables, in join order */
+  Plan_cache_table tables[1];
+};
+
+
+typedef I_P_List<Plan_cache_entry,
+                 I_P_List_adapter<Plan_cache_entry,
+                                  &Plan_cache_entry::next_in_lru,
+                                  &Plan_cache_entry::prev_in_lru>,
+                 I_P_List_null_counter,
+                 I_P_List_fast_push_back<Plan_cache_entry> >
+        Plan_cache_lru;
+
+static mysql_mutex_t LOCK_plan_cache;
+static HASH plan_cache;
+/* Least recently used entries are at the front */
+static Plan_cache_lru plan_cache_lru;
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_mutex_key key_LOCK_plan_cache;
+static PSI_mutex_info all_plan_cache_mutexes[]=
+{
+  { &key_LOCK_plan_cache, "LOCK_plan_cache", PSI_FLAG_GLOBAL }
+};
+#endif
+
+
+static uchar *plan_cache_get_key(const uchar *record, size_t *length,
+                                 my_bool not_used __attribute__((unused)))
+{
+  Plan_cache_entry *entry= (Plan_cache_entry*) record;
+  *length= entry->key_length;
+  return entry->key;
+}
+
+
+static ulong plan_cache_table_version(const TABLE *table)
+{
+  /* Temporary tables are created again for every execution */
+  return table->s->tmp_table == NO_TMP_TABLE ?
+         table->s->get_table_ref_version() : 0;
+}
+
+
+static bool plan_cache_similar_rows(ha_rows cached, ha_rows current)
+{
+  double low= (double) MY_MIN(cached, current);
+  double high= (double) MY_MAX(cached, current);
+  return high <= low * PLAN_CACHE_ROWS_FACTOR + PLAN_CACHE_ROWS_SLACK;
+}
+
+
+/* Remove an entry from the cache and free it. Must hold LOCK_plan_cache */
+
+static void plan_cache_evict(Plan_cache_entry *entry)
+{
+  mysql_mutex_assert_owner(&LOCK_plan_cache);
+  plan_cache_lru.remove(entry);
+  my_hash_delete(&plan_cache, (uchar*) entry);
+}
+
+
+static void plan_cache_evict_to(ulong size)
+{
+  mysql_mutex_assert_owner(&LOCK_plan_cache);
+  while (plan_cache.records > size)
+    plan_cache_evict(plan_cache_lru.front());
+}
+
+
+void plan_cache_init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  mysql_mutex_register("sql", all_plan_cache_mutexes,
+                       array_elements(all_plan_cache_mutexes));
+#endif
+  mysql_mutex_init(key_LOCK_plan_cache, &LOCK_plan_cache, MY_MUTEX_INIT_FAST);
+  my_hash_init(&plan_cache, &my_charset_bin, 64, 0, 0, plan_cache_get_key,
+               my_free, 0);
+  plan_cache_lru.empty();
+}
+
+
+void plan_cache_free()
+{
+  if (!my_hash_inited(&plan_cache))
+    return;
+  plan_cache_flush();
+  my_hash_free(&plan_cache);
+  mysql_mutex_destroy(&LOCK_plan_cache);
+}
+
+
+/**
+  Remove entries until there are at most 'size' of them
+*/
+
+void plan_cache_resize(ulong size)
+{
+  mysql_mutex_lock(&LOCK_plan_cache);
+  plan_cache_evict_to(size);
+  mysql_mutex_unlock(&LOCK_plan_cache);
+}
+
+
+/**
+  Remove all entries, e.g. when the statistics of a table have changed
+*/
+
+void plan_cache_flush()
+{
+  plan_cache_resize(0);
+}
+
+
+ulong plan_cache_entries()
+{
+  return plan_cache.records;
+}
+
+
+/**
+  Set the plan cache key of a statement that was just parsed from text
+
+  The key is the normalized statement, as computed for its digest, and
+  the current database. Literals are replaced by '?' in it, so the join
+  orders are shared by statements that differ only in constants. As the
+  row estimates still come from the actual constants, an order is not
+  reused if the constants select a very different number of rows.
+
+  @param thd  thread handle, thd->m_digest must have been computed
+*/
+
+void plan_cache_set_digest_key(THD *thd)
+{
+  const sql_digest_storage *digest= &thd->m_digest->m_digest_storage;
+  size_t length;
+  char *key;
+
+  /* A truncated digest does not identify the statement */
+  if (digest->m_full || !digest->m_byte_count)
+    return;
+  length= 4 + digest->m_byte_count + 1 + thd->db.length;
+  if (!(key= (char*) thd->alloc(length + 1)))
+    return;
+  int4store(key, digest->m_charset_number);
+  memcpy(key + 4, digest->m_token_array, digest->m_byte_count);
+  key[4 + digest->m_byte_count]= '\0';
+  if (thd->db.length)
+    memcpy(key + 4 + digest->m_byte_count + 1, thd->db.str, thd->db.length);
+  key[length]= '\0';
+  thd->lex->plan_cache_key.str= key;
+  thd->lex->plan_cache_key.length= length;
+}
+
+
+/**
+  Build the key of the join order of a SELECT
+
+  The key is the key of the statement (LEX::plan_cache_key), the number of
+  the SELECT in it and the optimizer settings that affect the join order.
+
+  @param join  join that is being optimized
+  @param key   [out] key, allocated in the statement memory root
+
+  @retval TRUE   the join order may be taken from and stored in the cache
+  @retval FALSE  the cache is disabled or not used for the statement
+*/
+
+bool plan_cache_make_key(JOIN *join, LEX_CUSTRING *key)
+{
+  THD *thd= join->thd;
+  const LEX_CSTRING *stmt_key= &thd->lex->plan_cache_key;
+  uchar *buff, *pos;
+
+  if (!plan_cache_size || !stmt_key->str)
+    return FALSE;
+  if (!(buff= (uchar*) thd->alloc(stmt_key->length +
+                                   PLAN_CACHE_KEY_SETTINGS)))
+    return FALSE;
+  memcpy(buff, stmt_key->str, stmt_key->length);
+  pos= buff + stmt_key->length;
+  int4store(pos, join->select_lex->select_number);
+  int8store(pos + 4, thd->variables.optimizer_switch);
+  int4store(pos + 12, (uint32) thd->variables.optimizer_search_depth);
+  int4store(pos + 16, (uint32) thd->variables.optimizer_prune_level);
+  int4store(pos + 20,
+            (uint32) thd->variables.optimizer_use_condition_selectivity);
+  int4store(pos + 24, (uint32) thd->variables.join_cache_level);
+  key->str= buff;
+  key->length= stmt_key->length + PLAN_CACHE_KEY_SETTINGS;
+  return TRUE;
+}
+
+
+/**
+  Find the cached join order of a SELECT
+
+  The order is returned only if the same tables are constant, the other
+  tables have the same definition as when the order was found, and their
+  row estimates are similar. The caller still has to check that the order
+  is allowed by the outer joins of the SELECT.
+
+  @param key    key made by plan_cache_make_key()
+  @param join   join that is being optimized
+  @param order  [out] the non-constant tables in join order
+
+  @retval TRUE   found
+  @retval FALSE  no usable join order
+*/
+
+bool plan_cache_lookup(const LEX_CUSTRING *key, JOIN *join, JOIN_TAB **order)
+{
+  Plan_cache_entry *entry;
+  uint count= join->table_count - join->const_tables;
+  bool found= FALSE;
+
+  mysql_mutex_lock(&LOCK_plan_cache);
+  if ((entry= (Plan_cache_entry*) my_hash_search(&plan_cache, key->str,
+                                                 key->length)) &&
+      entry->const_tables == join->const_table_map &&
+      entry->count == count)
+  {
+    uint i;
+    for (i= 0; i < count; i++)
+    {
+      Plan_cache_table *cached= entry->tables + i;
+      JOIN_TAB *tab= NULL;
+      for (JOIN_TAB **pos= join->best_ref + join->const_tables; *pos; pos++)
+      {
+        if ((*pos)->table->map == cached->map)
+        {
+          tab= *pos;
+          break;
+        }
+      }
+      if (!tab ||
+          plan_cache_table_version(tab->table) != cached->ref_version ||
+          !plan_cache_similar_rows(cached->records, tab->found_records))
+        break;
+      order[i]= tab;
+    }
+    if ((found= (i == count)))
+    {
+      plan_cache_lru.remove(entry);
+      plan_cache_lru.push_back(entry);
+    }
+  }
+  mysql_mutex_unlock(&LOCK_plan_cache);
+  return found;
+}
+
+
+/**
+  Remember the join order chosen for a SELECT
+
+  @param key   key made by plan_cache_make_key()
+  @param join  join with the chosen plan in join->best_positions
+*/
+
+void plan_cache_store(const LEX_CUSTRING *key, JOIN *join)
+{
+  Plan_cache_entry *entry, *old;
+  uint count= join->table_count - join->const_tables;
+  size_t size= sizeof(Plan_cache_entry) +
+               sizeof(Plan_cache_table) * (count ? count - 1 : 0);
+
+  if (!count ||
+      !(entry= (Plan_cache_entry*) my_malloc(size + key->length, MYF(0))))
+    return;
+
+  entry->key= (uchar*) entry + size;
+  entry->key_length= key->length;
+  memcpy(entry->key, key->str, key->length);
+  entry->const_tables= join->const_table_map;
+  entry->count= count;
+  for (uint i= 0; i < count; i++)
+  {
+    JOIN_TAB *tab= join->best_positions[join->const_tables + i].table;
+    entry->tables[i].map= tab->table->map;
+    entry->tables[i].ref_version= plan_cache_table_version(tab->table);
+    entry->tables[i].records= tab->found_records;
+  }
+
+  mysql_mutex_lock(&LOCK_plan_cache);
+  if ((old= (Plan_cache_entry*) my_hash_search(&plan_cache, key->str,
+                                               key->length)))
+    plan_cache_evict(old);
+  if (plan_cache_size)
+    plan_cache_evict_to(plan_cache_size - 1);
+  if (!plan_cache_size || my_hash_insert(&plan_cache, (uchar*) entry))
+    my_free(entry);
+  else
+    plan_cache_lru.push_back(entry);
+  mysql_mutex_unlock(&LOCK_plan_cache);
+}
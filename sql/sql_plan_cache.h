@@ -0,0 +1,70 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_PLAN_CACHE_INCLUDED
+#define SQL_PLAN_CACHE_INCLUDED
+
+/*
+  Plan cache: join orders picked by the cost based search, shared by all
+  connections.
+
+  A statement takes part when its LEX::plan_cache_key is set, which is
+  done for prepared statements, and for other statements when
+  plan_cache_text_queries is set (the key is then the digest of the
+  statement, so statements that differ only in literals share the
+  join orders). For every SELECT of such a statement
+  choose_plan() looks up the join order that was found the last time the
+  same statement was optimized with the same optimizer settings, in any
+  connection. When the tables are still the same (same table definition
+  version) and the estimated number of rows of every table is close to
+  the one the order was found with, the tables are put in that order and
+  only the access methods are chosen, which avoids greedy_search().
+
+  Only the order is cached: access methods, conditions and everything
+  that depends on parameter values is still done for every execution.
+
+  The cache is flushed by ANALYZE TABLE, and entries of tables that were
+  changed by DDL are not used any more and are replaced when the
+  statement is optimized next time.
+
+  Usage in the optimizer:
+
+    LEX_CUSTRING key;
+    if (plan_cache_make_key(join, &key) &&
+        plan_cache_lookup(&key, join, order))
+      ... use 'order' ...
+    else
+    {
+      ... search ...
+      plan_cache_store(&key, join);
+    }
+*/
+
+class JOIN;
+struct st_join_table;
+
+void plan_cache_init();
+void plan_cache_free();
+void plan_cache_resize(ulong size);
+void plan_cache_flush();
+ulong plan_cache_entries();
+
+void plan_cache_set_digest_key(THD *thd);
+bool plan_cache_make_key(JOIN *join, LEX_CUSTRING *key);
+bool plan_cache_lookup(const LEX_CUSTRING *key, JOIN *join,
+                       st_join_table **order);
+void plan_cache_store(const LEX_CUSTRING *key, JOIN *join);
+
+#endif /* SQL_PLAN_CACHE_INCLUDED */
@@ -187,6 +187,7 @@ class Prepared_statement: public Statement
   Prepared_statement(THD *thd_arg);
   virtual ~Prepared_statement();
   void setup_set_params();
+  void set_plan_cache_key();
   virtual Query_arena::Type type() const;
   virtual void cleanup_stmt();
   bool set_name(LEX_CSTRING *name);
@@ -3810,6 +3811,28 @@ void Prepared_statement::setup_set_params()
 }
 
 
+/**
+  Let executions of the same statement text in the same database share
+  the join orders in the plan cache, in any connection.
+*/
+
+void Prepared_statement::set_plan_cache_key()
+{
+  char *key;
+  size_t length= query_length() + 1 + db.length;
+
+  if (!(key= (char*) alloc_root(mem_root, length + 1)))
+    return;
+  memcpy(key, query(), query_length());
+  key[query_length()]= '\0';
+  if (db.length)
+    memcpy(key + query_length() + 1, db.str, db.length);
+  key[length]= '\0';
+  lex->plan_cache_key.str= key;
+  lex->plan_cache_key.length= length;
+}
+
+
 /**
   Destroy this prepared statement, cleaning up all used memory
   and resources.
@@ -4052,6 +4075,7 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
   if (likely(error == 0))
   {
     setup_set_params();
+    set_plan_cache_key();
     lex->context_analysis_only&= ~CONTEXT_ANALYSIS_ONLY_PREPARE;
     state= Query_arena::STMT_PREPARED;
     flags&= ~ (uint) IS_IN_USE;
@@ -233,6 +233,10 @@
 #define OPTIMIZER_SWITCH_COND_PUSHDOWN_FOR_DERIVED (1ULL << 30)
 #define OPTIMIZER_SWITCH_SPLIT_MATERIALIZED        (1ULL << 31)
 #define OPTIMIZER_SWITCH_COND_PUSHDOWN_FOR_SUBQUERY (1ULL << 32)
+#define OPTIMIZER_SWITCH_SKIP_SCAN                  (1ULL << 33)
+#define OPTIMIZER_SWITCH_MRR_IN_LISTS               (1ULL << 34)
+#define OPTIMIZER_SWITCH_JOIN_CACHE_BLOOM_FILTER    (1ULL << 35)
+#define OPTIMIZER_SWITCH_DERIVED_REOPTIMIZATION     (1ULL << 36)
 
 #define OPTIMIZER_SWITCH_DEFAULT   (OPTIMIZER_SWITCH_INDEX_MERGE | \
                                     OPTIMIZER_SWITCH_INDEX_MERGE_UNION | \
@@ -64,6 +64,8 @@
 #include "sys_vars_shared.h"
 #include "sp_head.h"
 #include "sp_rcontext.h"
+#include "sql_plan_cache.h"
+#include "sql_cond_filter.h"
 
 /*
   A key part number that means we're using a fulltext scan.
@@ -157,6 +159,8 @@ static COND *simplify_joins(JOIN *join, List<TABLE_LIST> *join_list,
 static bool check_interleaving_with_nj(JOIN_TAB *next);
 static void restore_prev_nj_state(JOIN_TAB *last);
 static uint reset_nj_counters(JOIN *join, List<TABLE_LIST> *join_list);
+static bool set_cached_join_order(JOIN *join, table_map join_tables,
+                                  const LEX_CUSTRING *key);
 static uint build_bitmap_for_nested_joins(List<TABLE_LIST> *join_list,
                                           uint first_unused);
 
@@ -4437,6 +4441,117 @@ static Item **get_sargable_cond(JOIN *join, TABLE *table)
 }
 
 
+/*
+  The join order is chosen again when the actual number of rows in a
+  materialized derived table differs from the estimate by this factor
+*/
+#define DERIVED_REOPTIMIZATION_FACTOR 10
+
+/**
+  @brief
+  Check the cardinality of materialized derived tables against the estimates
+  of the chosen join order and re-plan the join if they are badly wrong
+
+  @param join           the join whose join order has just been chosen
+  @param all_table_map  tables of the join
+
+  @details
+  The estimate of the number of rows in a materialized derived table can be
+  off by orders of magnitude (e.g. when the WHERE clause of its specification
+  has correlated conditions), which may make the join order chosen with it
+  run for hours. The function materializes the derived tables of the join
+  right away, instead of doing it at the first read at the execution, and
+  compares the actual number of rows in them with the estimates. If any of
+  them differs by more than DERIVED_REOPTIMIZATION_FACTOR times, the join
+  order is chosen again with the actual cardinalities. The execution doesn't
+  fill the tables again as their units are already executed.
+
+  Only derived tables that are filled once per execution of the statement
+  are checked, i.e. not dependent, recursive or splittable ones. Tables with
+  several generated keys are not checked either: the unused keys are dropped
+  only after the final join order has been chosen, and an internal temporary
+  table can't be created with more than one key. The checked tables are shown
+  in the output of ANALYZE FORMAT=JSON.
+
+  @retval FALSE  OK
+  @retval TRUE   Error
+*/
+
+static bool reoptimize_for_derived_tables(JOIN *join, table_map all_table_map)
+{
+  THD *thd= join->thd;
+  bool reoptimize= false;
+  DBUG_ENTER("reoptimize_for_derived_tables");
+
+  join->reoptimized_tables.empty();
+  join->reoptimized_join_order= false;
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_DERIVED_REOPTIMIZATION) ||
+      (join->select_options & SELECT_DESCRIBE) ||
+      join->with_two_phase_optimization)
+    DBUG_RETURN(FALSE);
+
+  for (uint i= 0; i < join->table_count; i++)
+  {
+    JOIN_TAB *s= join->join_tab + i;
+    TABLE *table= s->table;
+    TABLE_LIST *derived= table->pos_in_table_list;
+    if ((table->map & join->const_table_map) ||
+        !derived->is_materialized_derived() ||
+        derived->is_recursive_with_table() ||
+        derived->is_with_table_recursive_reference() ||
+        derived->get_unit()->uncacheable ||
+        derived->get_unit()->executed ||
+        table->is_splittable() || table->is_created() ||
+        table->s->keys > 1)
+      continue;
+
+    Explain_reoptimized_table *tbl= new (thd->mem_root)
+                                      Explain_reoptimized_table;
+    if (!tbl || join->reoptimized_tables.push_back(tbl, thd->mem_root))
+      DBUG_RETURN(TRUE);
+    tbl->derived_select_number= table->derived_select_number;
+    tbl->rows= s->records;
+
+    if (mysql_handle_single_derived(thd->lex, derived,
+                                    DT_CREATE | DT_FILL) ||
+        table->file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK))
+      DBUG_RETURN(TRUE);
+    tbl->r_rows= table->file->stats.records;
+
+    if (tbl->r_rows > tbl->rows * DERIVED_REOPTIMIZATION_FACTOR ||
+        tbl->r_rows * DERIVED_REOPTIMIZATION_FACTOR < tbl->rows)
+      reoptimize= true;
+
+    /* Use the same lower bound as TABLE_LIST::fetch_number_of_rows() */
+    table->used_stat_records= MY_MAX(tbl->r_rows, 2);
+    s->scan_time();
+    table->quick_condition_rows= s->records;
+    s->worst_seeks= MY_MIN((double) s->found_records / 10,
+                           (double) s->read_time * 3);
+    if (s->worst_seeks < 2.0)
+      s->worst_seeks= 2.0;
+  }
+
+  if (reoptimize)
+  {
+    JOIN_TAB *prev_order[MAX_TABLES];
+    for (uint i= join->const_tables; i < join->table_count; i++)
+      prev_order[i]= join->best_positions[i].table;
+
+    if (optimize_semijoin_nests(join, all_table_map) ||
+        choose_plan(join, all_table_map & ~join->const_table_map, FALSE))
+      DBUG_RETURN(TRUE);
+
+    for (uint i= join->const_tables; i < join->table_count; i++)
+    {
+      if (prev_order[i] != join->best_positions[i].table)
+        join->reoptimized_join_order= true;
+    }
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
 /**
   Calculate the best possible join and initialize the join structure.
 
@@ -5136,7 +5251,8 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
     /* Find an optimal join order of the non-constant tables. */
     if (join->const_tables != join->table_count)
     {
-      if (choose_plan(join, all_table_map & ~join->const_table_map))
+      if (choose_plan(join, all_table_map & ~join->const_table_map, TRUE) ||
+          reoptimize_for_derived_tables(join, all_table_map))
         goto error;
     }
     else
@@ -5527,6 +5643,13 @@ add_key_field(JOIN *join,
       if (is_const)
       {
         stat[0].const_keys.merge(possible_keys);
+        /* Skip scans use indexes where the field is not the first key part */
+        if (optimizer_flag(join->thd, OPTIMIZER_SWITCH_SKIP_SCAN))
+        {
+          key_map skip_scan_keys= field->part_of_key;
+          skip_scan_keys.intersect(field->table->keys_in_use_for_query);
+          stat[0].const_keys.merge(skip_scan_keys);
+        }
         bitmap_set_bit(&field->table->cond_set, field->field_index);
       }
       else if (!eq_func)
@@ -7575,6 +7698,9 @@ static void choose_initial_table_order(JOIN *join)
   @param join         pointer to the structure providing all context info for
                       the query
   @param join_tables  set of the tables in the query
+  @param cached_order_allowed
+                      TRUE <=> the join order may be taken from and stored in
+                      the plan cache (see sql_plan_cache.h)
 
   @retval
     FALSE       ok
@@ -7583,13 +7709,17 @@ static void choose_initial_table_order(JOIN *join)
 */
 
 bool
-choose_plan(JOIN *join, table_map join_tables)
+choose_plan(JOIN *join, table_map join_tables, bool cached_order_allowed)
 {
   uint search_depth= join->thd->variables.optimizer_search_depth;
   uint prune_level=  join->thd->variables.optimizer_prune_level;
   uint use_cond_selectivity= 
          join->thd->variables.optimizer_use_condition_selectivity;
   bool straight_join= MY_TEST(join->select_options & SELECT_STRAIGHT_JOIN);
+  LEX_CUSTRING plan_cache_key;
+  bool use_plan_cache= cached_order_allowed && !straight_join &&
+                       !join->emb_sjm_nest &&
+                       plan_cache_make_key(join, &plan_cache_key);
   DBUG_ENTER("choose_plan");
 
   join->cur_embedding_map= 0;
@@ -7636,6 +7766,12 @@ choose_plan(JOIN *join, table_map join_tables)
   {
     optimize_straight_join(join, join_tables);
   }
+  else if (use_plan_cache && set_cached_join_order(join, join_tables,
+                                                   &plan_cache_key))
+  {
+    status_var_increment(join->thd->status_var.plan_cache_hits);
+    optimize_straight_join(join, join_tables);
+  }
   else
   {
     DBUG_ASSERT(search_depth <= MAX_TABLES + 1);
@@ -7645,6 +7781,11 @@ choose_plan(JOIN *join, table_map join_tables)
     if (greedy_search(join, join_tables, search_depth, prune_level,
                       use_cond_selectivity))
       DBUG_RETURN(TRUE);
+    if (use_plan_cache)
+    {
+      status_var_increment(join->thd->status_var.plan_cache_misses);
+      plan_cache_store(&plan_cache_key, join);
+    }
   }
 
   /* 
@@ -7885,6 +8026,50 @@ determine_search_depth(JOIN *join)
 }
 
 
+/**
+  Put the tables in the join order found before for the same SELECT
+
+    The order is taken from the plan cache. It is used only if it is
+    allowed by the dependencies of the tables and by the nested outer
+    joins, which is checked the same way as greedy_search() does it.
+
+  @param join          the join being optimized
+  @param join_tables   set of the non-constant tables in the query
+  @param key           key of the join in the plan cache
+
+  @retval TRUE   join->best_ref is in the cached order
+  @retval FALSE  no usable order, join->best_ref is not changed
+*/
+
+static bool
+set_cached_join_order(JOIN *join, table_map join_tables,
+                      const LEX_CUSTRING *key)
+{
+  JOIN_TAB *order[MAX_TABLES];
+  uint count= join->table_count - join->const_tables;
+  table_map remaining_tables= join_tables;
+  bool valid= TRUE;
+
+  if (!plan_cache_lookup(key, join, order))
+    return FALSE;
+
+  for (uint i= 0; i < count && valid; i++)
+  {
+    valid= !(remaining_tables & order[i]->dependent) &&
+           !check_interleaving_with_nj(order[i]);
+    remaining_tables&= ~order[i]->table->map;
+  }
+  join->cur_embedding_map= 0;
+  reset_nj_counters(join, join->join_list);
+  if (!valid)
+    return FALSE;
+
+  memcpy(join->best_ref + join->const_tables, order,
+         sizeof(JOIN_TAB*) * count);
+  return TRUE;
+}
+
+
 /**
   Select the best ways to access the tables in a query without reordering them.
 
@@ -11252,6 +11437,12 @@ void JOIN::drop_unused_derived_keys()
       continue;
     if (!tmp_tbl->pos_in_table_list->is_materialized_derived())
       continue;
+    /*
+      The table has been filled by reoptimize_for_derived_tables(), its
+      indexes can't be dropped any more
+    */
+    if (tmp_tbl->is_created())
+      continue;
     if (tmp_tbl->max_keys > 1 && !tab->is_ref_for_hash_join())
       tmp_tbl->use_index(tab->ref.key);
     if (tmp_tbl->s->keys)
@@ -12170,6 +12361,8 @@ make_join_readinfo(JOIN *join, ulonglong options, uint no_jbuf_after)
     uint jcl= tab->used_join_cache_level;
     tab->read_record.table= table;
     tab->read_record.unlock_row= rr_unlock_row;
+    tab->select_cond_filter= NULL;
+    tab->select_cond_filter_for= NULL;
     tab->sorted= sorted;
     sorted= 0;                                  // only first must be sorted
     
@@ -17144,6 +17337,7 @@ create_tmp_table(THD *thd, TMP_TABLE_PARAM *param, List<Item> &fields,
   uint fieldnr= 0;
   ulong reclength, string_total_length;
   bool  using_unique_constraint= false;
+  bool  blob_in_key= false;
   bool  use_packed_rows= false;
   bool  not_all_columns= !(select_options & TMP_TABLE_ALL_COLUMNS);
   char  *tmpname,path[FN_REFLEN];
@@ -17529,9 +17723,24 @@ create_tmp_table(THD *thd, TMP_TABLE_PARAM *param, List<Item> &fields,
   share->fields= field_count;
   share->column_bitmap_size= bitmap_buffer_size(share->fields);
 
-  /* If result table is small; use a heap */
+  if (blob_count)
+  {
+    for (ORDER *tmp= group; tmp; tmp= tmp->next)
+    {
+      Field *field= (*tmp->item)->get_tmp_table_field();
+      if (field && (field->flags & BLOB_FLAG))
+        blob_in_key= true;
+    }
+    if (distinct)
+      blob_in_key= true;
+  }
+
+  /*
+    If result table is small; use a heap. Heap stores blobs of internal
+    temporary tables, but can't have keys on them.
+  */
   /* future: storage engine selection can be made dynamic? */
-  if (blob_count || using_unique_constraint
+  if (blob_in_key || using_unique_constraint
       || (thd->variables.big_tables && !(select_options & SELECT_SMALL_RESULT))
       || (select_options & TMP_TABLE_FORCE_MYISAM)
       || thd->variables.tmp_memory_table_size == 0)
@@ -18669,6 +18878,339 @@ create_internal_tmp_table_from_heap(THD *thd, TABLE *table,
 }
 
 
+/*
+  Partitioned spilling of GROUP BY temporary tables
+
+  end_update() groups rows in a HEAP table with a unique key over the
+  group fields. When the HEAP table gets full, converting all of it to
+  an on-disk table would make every following group update a B-tree
+  lookup on disk. Instead, groups are divided into GROUP_SPILL_PARTITIONS
+  partitions by the hash of the group key, and only the resident
+  partition with most groups is moved to the on-disk table. Later rows
+  of a moved partition are aggregated on disk, rows of the other
+  partitions keep using the HEAP table, which may spill again.
+
+  When all rows have been grouped, the groups left in the HEAP table are
+  copied to the on-disk table, and it replaces the HEAP table like in
+  create_internal_tmp_table_from_heap().
+*/
+
+#define GROUP_SPILL_PARTITIONS 16
+
+class Group_spill :public Sql_alloc
+{
+public:
+  TABLE table;                                  /* The on-disk table */
+  TABLE_SHARE share;
+  /* Number of groups of each partition in the HEAP table */
+  ha_rows groups[GROUP_SPILL_PARTITIONS];
+  bool spilled[GROUP_SPILL_PARTITIONS];
+
+  Group_spill()
+  {
+    bzero(groups, sizeof(groups));
+    bzero(spilled, sizeof(spilled));
+  }
+};
+
+
+/**
+  Get the partition of the group stored in 'record' of a GROUP BY table
+
+  The hash is computed with Field::hash() so that values that are equal
+  in the group key collation always get the same partition.
+*/
+
+static uint group_spill_partition(TABLE *table, uchar *record)
+{
+  ulong nr= 1, nr2= 4;
+  my_ptrdiff_t diff= record - table->record[0];
+  KEY *key_info= table->key_info;
+  KEY_PART_INFO *part= key_info->key_part;
+  KEY_PART_INFO *end= part + key_info->user_defined_key_parts;
+
+  for (; part < end; part++)
+  {
+    Field *field= part->field;
+    field->move_field_offset(diff);
+    field->hash(&nr, &nr2);
+    field->move_field_offset(-diff);
+  }
+  return (uint) (nr % GROUP_SPILL_PARTITIONS);
+}
+
+
+/**
+  Get the partition of the group key that end_update() has stored in
+  the group fields (the key fields over TMP_TABLE_PARAM::group_buff)
+*/
+
+static uint group_spill_partition(ORDER *group)
+{
+  ulong nr= 1, nr2= 4;
+  for (; group; group= group->next)
+    group->field->hash(&nr, &nr2);
+  return (uint) (nr % GROUP_SPILL_PARTITIONS);
+}
+
+
+/**
+  Create the on-disk table for a GROUP BY HEAP table that got full
+
+  @return 0 on error
+*/
+
+static Group_spill *
+create_group_spill(THD *thd, TABLE *table, TMP_TABLE_PARAM *param)
+{
+  Group_spill *spill;
+  TABLE *disk;
+  int error;
+  DBUG_ENTER("create_group_spill");
+
+  if (!(spill= new (&table->mem_root) Group_spill()))
+    DBUG_RETURN(0);
+  disk= &spill->table;
+  *disk= *table;
+  spill->share= *table->s;
+  disk->s= &spill->share;
+  disk->s->db_plugin= ha_lock_engine(thd, TMP_ENGINE_HTON);
+  if (unlikely(!(disk->file= get_new_handler(&spill->share, &disk->mem_root,
+                                             disk->s->db_type()))))
+    goto err2;
+  if (unlikely(disk->file->set_ha_share_ref(&spill->share.ha_share)))
+    goto err3;
+
+  THD_STAGE_INFO(thd, stage_converting_heap_to_myisam);
+  if (create_internal_tmp_table(disk, table->key_info, param->start_recinfo,
+                                &param->recinfo,
+                                thd->lex->first_select_lex()->options |
+                                thd->variables.option_bits))
+    goto err3;
+  if (open_tmp_table(disk))
+    goto err4;
+  if (unlikely((error= disk->file->ha_index_init(0, 0))))
+  {
+    disk->file->print_error(error, MYF(0));
+    (void) disk->file->ha_close();
+    goto err4;
+  }
+
+  /* Count the groups of each partition */
+  table->file->ha_index_or_rnd_end();
+  if (table->file->ha_rnd_init_with_error(1))
+    goto err5;
+  while (!table->file->ha_rnd_next(table->record[1]))
+    spill->groups[group_spill_partition(table, table->record[1])]++;
+  (void) table->file->ha_rnd_end();
+  if (unlikely((error= table->file->ha_index_init(0, 0))))
+  {
+    table->file->print_error(error, MYF(0));
+    goto err5;
+  }
+  if (unlikely(thd->is_error()))
+    goto err5;
+
+  table->mem_root= disk->mem_root;
+  table->group_spill= spill;
+  DBUG_RETURN(spill);
+
+err5:
+  (void) disk->file->ha_index_or_rnd_end();
+  (void) disk->file->ha_close();
+err4:
+  disk->file->ha_delete_table(disk->s->table_name.str);
+err3:
+  delete disk->file;
+err2:
+  table->mem_root= disk->mem_root;
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Move all groups of a partition from the HEAP table to the on-disk table
+*/
+
+static bool group_spill_partition_to_disk(THD *thd, TABLE *table,
+                                          uint partition)
+{
+  Group_spill *spill= table->group_spill;
+  handler *disk_file= spill->table.file;
+  int error= 0;
+  DBUG_ENTER("group_spill_partition_to_disk");
+  DBUG_PRINT("info", ("partition: %u  groups: %lu", partition,
+                      (ulong) spill->groups[partition]));
+
+  spill->spilled[partition]= true;
+  if (!spill->groups[partition])
+    DBUG_RETURN(0);
+
+  table->file->ha_index_or_rnd_end();
+  if (table->file->ha_rnd_init_with_error(1))
+    DBUG_RETURN(1);
+  while (!table->file->ha_rnd_next(table->record[1]))
+  {
+    if (group_spill_partition(table, table->record[1]) != partition)
+      continue;
+    if (unlikely((error= disk_file->ha_write_tmp_row(table->record[1]))))
+    {
+      disk_file->print_error(error, MYF(0));
+      break;
+    }
+    if (unlikely((error= table->file->ha_delete_tmp_row(table->record[1]))))
+    {
+      table->file->print_error(error, MYF(0));
+      break;
+    }
+  }
+  (void) table->file->ha_rnd_end();
+  if (unlikely(error || thd->is_error()))
+    DBUG_RETURN(1);
+  spill->groups[partition]= 0;
+
+  if (unlikely((error= table->file->ha_index_init(0, 0))))
+  {
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+/**
+  Write a new group to a GROUP BY HEAP table that is full
+
+  @param thd        Thread handle
+  @param table      The HEAP table. The new group is in table->record[0]
+                    and in the group fields
+  @param param      Its TMP_TABLE_PARAM
+  @param error      Error from writing table->record[0]
+
+  @detail
+    Partitions of the HEAP table are moved to disk, largest first, until
+    the row fits or its own partition has been moved.
+
+  @return
+    false  ok
+    true   error (reported)
+*/
+
+static bool group_spill_write_row(THD *thd, TABLE *table,
+                                  TMP_TABLE_PARAM *param, int error)
+{
+  Group_spill *spill= table->group_spill;
+  uint partition;
+  DBUG_ENTER("group_spill_write_row");
+
+  if (table->s->db_type() != heap_hton || error != HA_ERR_RECORD_FILE_FULL)
+  {
+    table->file->print_error(error, MYF(ME_FATAL));
+    DBUG_RETURN(1);
+  }
+  if (!spill && !(spill= create_group_spill(thd, table, param)))
+    DBUG_RETURN(1);
+  partition= group_spill_partition(table->group);
+
+  for (;;)
+  {
+    uint victim= partition;
+    for (uint i= 0; i < GROUP_SPILL_PARTITIONS; i++)
+    {
+      if (!spill->spilled[i] && spill->groups[i] > spill->groups[victim])
+        victim= i;
+    }
+    if (group_spill_partition_to_disk(thd, table, victim))
+      DBUG_RETURN(1);
+
+    if (victim == partition)
+    {
+      if (unlikely((error=
+                    spill->table.file->ha_write_tmp_row(table->record[0]))))
+      {
+        spill->table.file->print_error(error, MYF(0));
+        DBUG_RETURN(1);
+      }
+      DBUG_RETURN(0);
+    }
+    if (likely(!(error= table->file->ha_write_tmp_row(table->record[0]))))
+    {
+      spill->groups[partition]++;
+      DBUG_RETURN(0);
+    }
+    if (error != HA_ERR_RECORD_FILE_FULL)
+    {
+      table->file->print_error(error, MYF(ME_FATAL));
+      DBUG_RETURN(1);
+    }
+  }
+}
+
+
+/**
+  Copy the groups left in the HEAP table to the on-disk table and
+  replace the HEAP table with it
+*/
+
+static bool group_spill_finish(THD *thd, TABLE *table)
+{
+  Group_spill *spill= table->group_spill;
+  TABLE *disk= &spill->table;
+  MEM_ROOT mem_root;
+  int error= 0;
+  DBUG_ENTER("group_spill_finish");
+
+  table->file->ha_index_or_rnd_end();
+  if (table->file->ha_rnd_init_with_error(1))
+    DBUG_RETURN(1);
+  while (!table->file->ha_rnd_next(table->record[1]))
+  {
+    if (unlikely((error= disk->file->ha_write_tmp_row(table->record[1]))))
+    {
+      disk->file->print_error(error, MYF(0));
+      break;
+    }
+    if (unlikely(thd->check_killed()))
+      break;
+  }
+  if (unlikely(error || thd->is_error() || thd->killed))
+  {
+    (void) table->file->ha_rnd_end();
+    DBUG_RETURN(1);
+  }
+
+  /* remove heap table and change to use the on-disk table */
+  (void) table->file->ha_rnd_end();
+  (void) table->file->ha_close();
+  delete table->file;
+  table->file= 0;
+  plugin_unlock(0, table->s->db_plugin);
+  spill->share.db_plugin= my_plugin_lock(0, spill->share.db_plugin);
+  mem_root= table->mem_root;
+  disk->s= table->s;                            // Keep old share
+  *table= *disk;
+  *table->s= spill->share;
+  table->mem_root= mem_root;
+  table->group_spill= 0;
+
+  table->file->change_table_ptr(table, table->s);
+  table->use_all_columns();
+  DBUG_RETURN(0);
+}
+
+
+/* Drop the on-disk table of a GROUP BY table that was not finished */
+
+static void free_group_spill(TABLE *table)
+{
+  TABLE *disk= &table->group_spill->table;
+  disk->file->ha_index_or_rnd_end();
+  disk->file->ha_drop_table(disk->s->table_name.str);
+  delete disk->file;
+  table->group_spill= 0;
+}
+
+
 void
 free_tmp_table(THD *thd, TABLE *entry)
 {
@@ -18681,6 +19223,8 @@ free_tmp_table(THD *thd, TABLE *entry)
   save_proc_info=thd->proc_info;
   THD_STAGE_INFO(thd, stage_removing_tmp_table);
 
+  if (entry->group_spill)
+    free_group_spill(entry);
   if (entry->file && entry->is_created())
   {
     entry->file->ha_index_or_rnd_end();
@@ -19482,7 +20026,17 @@ evaluate_join_record(JOIN *join, JOIN_TAB *join_tab,
 
   if (select_cond)
   {
-    select_cond_result= MY_TEST(select_cond->val_int());
+    if (join_tab->select_cond_filter_for != select_cond)
+    {
+      /* The condition is new or has been changed since the last row */
+      join_tab->select_cond_filter=
+        Cond_filter::create(join->thd, select_cond, join_tab->table);
+      join_tab->select_cond_filter_for= select_cond;
+    }
+    if (join_tab->select_cond_filter)
+      select_cond_result= join_tab->select_cond_filter->check();
+    else
+      select_cond_result= MY_TEST(select_cond->val_int());
 
     /* check for errors evaluating the condition */
     if (unlikely(join->thd->is_error()))
@@ -20840,6 +21394,45 @@ end_write(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Update or add the group in table->record[0] of a GROUP BY table when its
+  partition has been moved to disk. Like end_unique_update().
+*/
+
+static bool update_spilled_group(JOIN *join, JOIN_TAB *join_tab)
+{
+  TABLE *table= join_tab->table;
+  handler *disk_file= table->group_spill->table.file;
+  int error;
+
+  init_tmptable_sum_functions(join->sum_funcs);
+  if (unlikely(copy_funcs(join_tab->tmp_table_param->items_to_copy,
+                          join->thd)))
+    return true;                                /* purecov: inspected */
+  if (likely(!(error= disk_file->ha_write_tmp_row(table->record[0]))))
+  {
+    join_tab->send_records++;                   // New group
+    return false;
+  }
+  if (unlikely((int) disk_file->get_dup_key(error) < 0 ||
+               (error= disk_file->ha_rnd_pos(table->record[1],
+                                             disk_file->dup_ref))))
+  {
+    disk_file->print_error(error, MYF(0));      /* purecov: inspected */
+    return true;                                /* purecov: inspected */
+  }
+  restore_record(table, record[1]);
+  update_tmptable_sum_func(join->sum_funcs, table);
+  if (unlikely((error= disk_file->ha_update_tmp_row(table->record[1],
+                                                    table->record[0]))))
+  {
+    disk_file->print_error(error, MYF(0));      /* purecov: inspected */
+    return true;                                /* purecov: inspected */
+  }
+  return false;
+}
+
+
 /*
   @brief
     Perform a GROUP BY operation over rows coming in arbitrary order. 
@@ -20849,6 +21442,9 @@ end_write(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 
   @detail
     Also applies HAVING, etc.
+
+    If the HEAP table gets full, groups are moved to disk one partition
+    at a time, see Group_spill.
 */
 
 static enum_nested_loop_state
@@ -20858,10 +21454,20 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
   TABLE *const table= join_tab->table;
   ORDER   *group;
   int	  error;
+  uint    partition= 0;
   DBUG_ENTER("end_update");
 
   if (end_of_records)
+  {
+    if (table->group_spill)
+    {
+      if (group_spill_finish(join->thd, table))
+        DBUG_RETURN(NESTED_LOOP_ERROR);
+      /* The table is on disk now, as after a conversion below */
+      join_tab->aggr->set_write_func(end_unique_update);
+    }
     DBUG_RETURN(NESTED_LOOP_OK);
+  }
 
   join->found_records++;
   copy_fields(join_tab->tmp_table_param);	// Groups are copied twice.
@@ -20883,6 +21489,16 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
     if (item->maybe_null)
       group->buff[-1]= (char) group->field->is_null();
   }
+  if (table->group_spill)
+  {
+    partition= group_spill_partition(table->group);
+    if (table->group_spill->spilled[partition])
+    {
+      if (update_spilled_group(join, join_tab))
+        DBUG_RETURN(NESTED_LOOP_ERROR);
+      goto end;
+    }
+  }
   if (!table->file->ha_index_read_map(table->record[1],
                                       join_tab->tmp_table_param->group_buff,
                                       HA_WHOLE_KEY,
@@ -20905,20 +21521,13 @@ end_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
     DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
   if (unlikely((error= table->file->ha_write_tmp_row(table->record[0]))))
   {
-    if (create_internal_tmp_table_from_heap(join->thd, table,
-                                       join_tab->tmp_table_param->start_recinfo,
-                                            &join_tab->tmp_table_param->recinfo,
-                                            error, 0, NULL))
+    /* Move some of the groups to disk */
+    if (group_spill_write_row(join->thd, table, join_tab->tmp_table_param,
+                              error))
       DBUG_RETURN(NESTED_LOOP_ERROR);            // Not a table_is_full error
-    /* Change method to update rows */
-    if (unlikely((error= table->file->ha_index_init(0, 0))))
-    {
-      table->file->print_error(error, MYF(0));
-      DBUG_RETURN(NESTED_LOOP_ERROR);
-    }
-
-    join_tab->aggr->set_write_func(end_unique_update);
   }
+  else if (table->group_spill)
+    table->group_spill->groups[partition]++;
   join_tab->send_records++;
 end:
   if (unlikely(join->thd->check_killed()))
@@ -22278,7 +22887,8 @@ test_if_skip_sort_order(JOIN_TAB *tab,ORDER *order,ha_rows select_limit,
           quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_INTERSECT ||
           quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT ||
           quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION ||
-          quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)
+          quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX ||
+          quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
       {
         tab->limit= 0;
         goto use_filesort;               // Use filesort
@@ -22684,8 +23294,8 @@ JOIN_TAB::remove_duplicates()
     thd->reset_killed();
 
   table->file->info(HA_STATUS_VARIABLE);
-  if (table->s->db_type() == heap_hton ||
-      (!table->s->blob_fields &&
+  if (!table->s->blob_fields &&
+      (table->s->db_type() == heap_hton ||
        ((ALIGN_SIZE(keylength) + HASH_OVERHEAD) * table->file->stats.records <
 	thd->variables.sortbuff_size)))
     error=remove_dup_with_hash_index(join->thd, table, field_count, first_field,
@@ -25409,6 +26019,8 @@ bool JOIN_TAB::save_explain_data(Explain_table_access *eta,
       else
         eta->push_extra(ET_USING_INDEX);
     }
+    if (quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
+      eta->push_extra(ET_USING_SKIP_SCAN);
     if (table->reginfo.not_exists_optimize)
       eta->push_extra(ET_NOT_EXISTS);
 
@@ -25663,6 +26275,18 @@ int JOIN::save_explain_data_intern(Explain_query *output,
       xpl_sel->having= having;
     xpl_sel->having_value= having_value;
 
+    {
+      List_iterator<Explain_reoptimized_table> it(reoptimized_tables);
+      Explain_reoptimized_table *tbl, *copy;
+      while ((tbl= it++))
+      {
+        if (!(copy= new (output->mem_root) Explain_reoptimized_table(*tbl)) ||
+            xpl_sel->reoptimized_tables.push_back(copy, output->mem_root))
+          DBUG_RETURN(1);
+      }
+      xpl_sel->reoptimized_join_order= reoptimized_join_order;
+    }
+
     JOIN_TAB* const first_top_tab= join->first_breadth_first_tab();
     JOIN_TAB* prev_bush_root_tab= NULL;
 
@@ -239,6 +239,7 @@ class AGGR_OP;
 class Filesort;
 struct SplM_plan_info;
 class SplM_opt_info;
+class Cond_filter;
 
 typedef struct st_join_table {
   st_join_table() {}
@@ -249,6 +250,9 @@ typedef struct st_join_table {
 				    not supported by any index                 */
   SQL_SELECT	*select;
   COND		*select_cond;
+  /* select_cond prepared for evaluation in evaluate_join_record() */
+  Cond_filter   *select_cond_filter;
+  COND          *select_cond_filter_for;
   COND          *on_precond;    /**< part of on condition to check before
 				     accessing the first inner table           */  
   QUICK_SELECT_I *quick;
@@ -1471,6 +1475,13 @@ class JOIN :public Sql_alloc
 
   /* Saved execution plan for this join */
   Join_plan_state *save_qep;
+  /*
+    Derived tables materialized to check the cardinality estimates of the
+    join order, see reoptimize_for_derived_tables()
+  */
+  List<Explain_reoptimized_table> reoptimized_tables;
+  /* TRUE <=> the actual cardinalities of reoptimized_tables changed the plan */
+  bool reoptimized_join_order;
   /* Info on splittability of the table materialized by this plan*/
   SplM_opt_info *spl_opt_info;
   /* Contains info on keyuses usable for splitting */
@@ -1528,6 +1539,8 @@ class JOIN :public Sql_alloc
     skip_sort_order= 0;
     with_two_phase_optimization= 0;
     save_qep= 0;
+    reoptimized_tables.empty();
+    reoptimized_join_order= false;
     spl_opt_info= 0;
     ext_keyuses_for_splitting= 0;
     spl_opt_info= 0;
@@ -2330,7 +2343,8 @@ inline Item * or_items(THD *thd, Item* cond, Item *item)
 {
   return (cond ? (new (thd->mem_root) Item_cond_or(thd, cond, item)) : item);
 }
-bool choose_plan(JOIN *join, table_map join_tables);
+bool choose_plan(JOIN *join, table_map join_tables,
+                 bool cached_order_allowed= FALSE);
 void optimize_wo_join_buffering(JOIN *join, uint first_tab, uint last_tab, 
                                 table_map last_remaining_tables, 
                                 bool first_alt, uint no_jbuf_before,
@@ -27,10 +27,19 @@
 #include "sql_base.h"
 #include "key.h"
 #include "sql_statistics.h"
+#include "opt_histogram_json.h"
 #include "opt_range.h"
 #include "uniques.h"
 #include "my_atomic.h"
 #include "sql_show.h"
+#include "transaction.h"
+#include "sql_plan_cache.h"
+
+/*
+  Tables with at most this number of rows are not sampled when
+  analyze_sample_percentage is 0
+*/
+#define MIN_ROWS_FOR_ANALYZE_SAMPLING 50000
 
 /*
   The system variable 'use_stat_tables' can take one of the
@@ -200,12 +209,12 @@ TABLE_FIELD_TYPE column_stat_fields[COLUMN_STAT_N_FIELDS] =
   },
   {
     { STRING_WITH_LEN("hist_type") },
-    { STRING_WITH_LEN("enum('SINGLE_PREC_HB','DOUBLE_PREC_HB')") },
+    { STRING_WITH_LEN("enum('SINGLE_PREC_HB','DOUBLE_PREC_HB','JSON_HB')") },
     { STRING_WITH_LEN("utf8") }
   },
   {
     { STRING_WITH_LEN("histogram") },
-    { STRING_WITH_LEN("varbinary(255)") },
+    { STRING_WITH_LEN("longblob") },
     { NULL, 0 }
   }
 };
@@ -325,7 +334,8 @@ class Column_statistics_collected :public Column_statistics
 
   inline void init(THD *thd, Field * table_field);
   inline bool add(ha_rows rowno);
-  inline void finish(ha_rows rows); 
+  inline void finish(ha_rows rows, double sample_fraction,
+                     MEM_ROOT *mem_root);
   inline void cleanup();
 };
 
@@ -1089,7 +1099,8 @@ class Column_stat: public Stat_table
           const char * col_histogram=
           (const char *) (table_field->collected_stats->histogram.get_values());
 	  stat_field->store(col_histogram,
-                            table_field->collected_stats->histogram.get_size(),
+                            table_field->collected_stats->histogram.
+                            get_stored_length(),
                             &my_charset_bin);
           break;           
         }
@@ -1209,6 +1220,43 @@ class Column_stat: public Stat_table
     }
   }
 
+
+  /**
+    @brief
+    Read a JSON_HB histogram from column_stats
+
+    @param
+    value_field  A copy of the column the values of the histogram are
+                 stored into
+    @param
+    mem_root     Where to allocate the histogram
+
+    @details
+    The method looks for the record of the column the same way as
+    get_histogram_value does, and then prepares the JSON text of the
+    histogram for the optimizer. A histogram that cannot be parsed is
+    ignored.
+  */
+
+  void get_json_histogram(Field *value_field, MEM_ROOT *mem_root)
+  {
+    if (find_stat())
+    {
+      String val;
+      Column_statistics *read_stats= table_field->read_stats;
+      Field *stat_field= stat_table->field[COLUMN_STAT_HISTOGRAM];
+      bool has_min_max= read_stats->min_max_values_are_provided();
+      stat_field->val_str(&val);
+      read_stats->histogram.set_json(
+        Histogram_json::create(mem_root, value_field,
+                               has_min_max ? read_stats->min_value : NULL,
+                               has_min_max ? read_stats->max_value : NULL,
+                               val.ptr(), val.length()));
+      if (read_stats->histogram.get_json())
+        read_stats->set_not_null(COLUMN_STAT_HISTOGRAM);
+    }
+  }
+
 };
 
 
@@ -1540,10 +1588,17 @@ class Histogram_builder
   uint curr_bucket;        /* number of the current bucket to be built     */
   ulonglong count;         /* number of values retrieved                   */
   ulonglong count_distinct;    /* number of distinct values retrieved      */
+  ulonglong count_singletons;  /* number of values retrieved only once     */
+  Histogram_json_builder *json; /* the builder of a JSON_HB histogram      */
+  /* Where to unpack the values of a packed Unique, NULL if not packed    */
+  uchar *unpack_buff;
 
 public: 
-  Histogram_builder(Field *col, uint col_len, ha_rows rows)
-    : column(col), col_length(col_len), records(rows)
+  Histogram_builder(Field *col, uint col_len, ha_rows rows,
+                    Histogram_json_builder *json_builder,
+                    uchar *unpack_buff_arg= NULL)
+    : column(col), col_length(col_len), records(rows), json(json_builder),
+      unpack_buff(unpack_buff_arg)
   {
     Column_statistics *col_stats= col->collected_stats;
     min_value= col_stats->min_value;
@@ -1554,14 +1609,31 @@ class Histogram_builder
     curr_bucket= 0;
     count= 0;
     count_distinct= 0;    
+    count_singletons= 0;
   }
 
   ulonglong get_count_distinct() { return count_distinct; }
+  ulonglong get_count_singletons() { return count_singletons; }
 
   int next(void *elem, element_count elem_cnt)
   {
     count_distinct++;
+    if (elem_cnt == 1)
+      count_singletons++;
     count+= elem_cnt;
+    if (unpack_buff)
+    {
+      uchar *key= (uchar *) elem;
+      memcpy(unpack_buff, key + Unique::PACKED_KEY_LENGTH_BYTES,
+             Unique::read_packed_length(key) -
+             Unique::PACKED_KEY_LENGTH_BYTES);
+      elem= unpack_buff;
+    }
+    if (json)
+    {
+      json->next(elem, elem_cnt);
+      return 0;
+    }
     if (curr_bucket == hist_width)
       return 0;
     if (count > bucket_capacity * (curr_bucket + 1))
@@ -1582,6 +1654,19 @@ class Histogram_builder
 };
 
 
+/*
+  Compare the values of a VARCHAR column packed by Count_distinct_field
+*/
+
+static
+int packed_str_key_cmp(void* arg, uchar* key1, uchar* key2)
+{
+  Field *f= (Field*) arg;
+  return f->cmp(key1 + Unique::PACKED_KEY_LENGTH_BYTES,
+                key2 + Unique::PACKED_KEY_LENGTH_BYTES);
+}
+
+
 C_MODE_START
 
 int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
@@ -1590,6 +1675,18 @@ int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
   return hist_builder->next(elem, elem_cnt);
 }
 
+
+static
+int count_distinct_singletons_walk(void *elem, element_count elem_cnt,
+                                   void *arg)
+{
+  ulonglong *counts= (ulonglong *) arg;
+  counts[0]++;
+  if (elem_cnt == 1)
+    counts[1]++;
+  return 0;
+}
+
 C_MODE_END
 
 
@@ -1610,10 +1707,15 @@ class Count_distinct_field: public Sql_alloc
   Field *table_field;  
   Unique *tree;       /* The helper object to contain distinct values */
   uint tree_key_length; /* The length of the keys for the elements of 'tree */
+  /*
+    The buffer for the keys of a VARCHAR column: only the actual data of
+    the values is kept in 'tree'. NULL for other columns.
+  */
+  uchar *packed_key;
 
 public:
   
-  Count_distinct_field() {}
+  Count_distinct_field() : packed_key(NULL) {}
 
   /**
     @param
@@ -1634,7 +1736,21 @@ class Count_distinct_field: public Sql_alloc
   {
     table_field= field;
     tree_key_length= field->pack_length();
+    packed_key= NULL;
 
+    if (field->type() == MYSQL_TYPE_VARCHAR)
+    {
+      tree_key_length+= Unique::PACKED_KEY_LENGTH_BYTES;
+      if (!(packed_key= (uchar *) my_malloc(tree_key_length,
+                                            MYF(MY_THREAD_SPECIFIC | MY_WME))))
+      {
+        tree= NULL;
+        return;
+      }
+      tree= new Unique((qsort_cmp2) packed_str_key_cmp, (void*) field,
+                       tree_key_length, max_heap_table_size, 1, true);
+      return;
+    }
     tree= new Unique((qsort_cmp2) simple_str_key_cmp, (void*) field,
                      tree_key_length, max_heap_table_size, 1);
   }
@@ -1643,6 +1759,7 @@ class Count_distinct_field: public Sql_alloc
   {
     delete tree;
     tree= NULL;
+    my_free(packed_key);
   }
 
   /* 
@@ -1660,16 +1777,37 @@ class Count_distinct_field: public Sql_alloc
   */
   virtual bool add()
   {
+    if (packed_key)
+    {
+      Field_varstring *f= (Field_varstring *) table_field;
+      uint length= f->length_bytes + f->get_length();
+      memcpy(packed_key + Unique::PACKED_KEY_LENGTH_BYTES, f->ptr, length);
+      Unique::store_packed_length(packed_key,
+                                  Unique::PACKED_KEY_LENGTH_BYTES + length);
+      return tree->unique_add(packed_key);
+    }
     return tree->unique_add(table_field->ptr);
   }
   
   /*
     @brief
     Calculate the number of elements accumulated in the container of 'tree'
+
+    @param
+    singletons    If not NULL, the number of the elements added only once
+                  is returned here
   */
-  ulonglong get_value()
+  ulonglong get_value(ulonglong *singletons)
   {
     ulonglong count;
+    if (singletons)
+    {
+      ulonglong counts[2]= { 0, 0 };
+      tree->walk(table_field->table, count_distinct_singletons_walk,
+                 (void*) counts);
+      *singletons= counts[1];
+      return counts[0];
+    }
     if (tree->elements == 0)
       return (ulonglong) tree->elements_in_tree();
     count= 0;  
@@ -1680,21 +1818,51 @@ class Count_distinct_field: public Sql_alloc
   /*
     @brief
     Build the histogram for the elements accumulated in the container of 'tree'
+
+    @param
+    mem_root   Where to allocate the text of a JSON_HB histogram
   */
-  ulonglong get_value_with_histogram(ha_rows rows)
+  ulonglong get_value_with_histogram(ha_rows rows, ulonglong *singletons,
+                                     MEM_ROOT *mem_root)
   {
-    Histogram_builder hist_builder(table_field, tree_key_length, rows);
+    Histogram *histogram= &table_field->collected_stats->histogram;
+    if (histogram->get_type() == JSON_HB)
+    {
+      uint length;
+      Histogram_json_builder json_builder(table_field, histogram->get_width(),
+                                          rows);
+      Histogram_builder hist_builder(table_field, table_field->pack_length(),
+                                     rows, &json_builder, packed_key);
+      tree->walk(table_field->table, histogram_build_walk,
+                 (void *) &hist_builder);
+      histogram->set_values((uchar *) json_builder.finish(mem_root, &length));
+      histogram->set_text_length(histogram->get_values() ? length : 0);
+      *singletons= hist_builder.get_count_singletons();
+      return hist_builder.get_count_distinct();
+    }
+    Histogram_builder hist_builder(table_field, table_field->pack_length(),
+                                   rows, NULL, packed_key);
     tree->walk(table_field->table,  histogram_build_walk, (void *) &hist_builder);
+    *singletons= hist_builder.get_count_singletons();
     return hist_builder.get_count_distinct();
   }
 
   /*
     @brief
     Get the size of the histogram in bytes built for table_field
+
+    @note
+    The values of BIT columns are kept as numbers, not in the record
+    format a JSON_HB histogram is built from, such columns get no
+    JSON_HB histogram.
   */
   uint get_hist_size()
   {
-    return table_field->collected_stats->histogram.get_size();
+    Histogram *histogram= &table_field->collected_stats->histogram;
+    if (histogram->get_type() == JSON_HB &&
+        table_field->type() == MYSQL_TYPE_BIT)
+      return 0;
+    return histogram->get_size();
   }
 
   /*
@@ -2111,11 +2279,14 @@ int alloc_statistics_for_table(THD* thd, TABLE *table)
   uint hist_size= thd->variables.histogram_size;
   Histogram_type hist_type= (Histogram_type) (thd->variables.histogram_type);
   uchar *histogram= NULL;
-  if (hist_size > 0)
-    histogram= (uchar *) alloc_root(&table->mem_root, hist_size * columns);
+  /* The text of a JSON_HB histogram is allocated when it is built */
+  uint hist_buff_size= hist_type == JSON_HB ? 0 : hist_size;
+  if (hist_buff_size > 0)
+    histogram= (uchar *) alloc_root(&table->mem_root,
+                                    hist_buff_size * columns);
 
   if (!table_stats || !column_stats || !index_stats || !idx_avg_frequency ||
-      (hist_size && !histogram))
+      (hist_buff_size && !histogram))
     DBUG_RETURN(1);
 
   table->collected_stats= table_stats;
@@ -2136,7 +2307,7 @@ int alloc_statistics_for_table(THD* thd, TABLE *table)
       column_stats->histogram.set_size(hist_size);
       column_stats->histogram.set_type(hist_type);
       column_stats->histogram.set_values(histogram);
-      histogram+= hist_size;
+      histogram+= hist_buff_size;
     }
   }
 
@@ -2407,18 +2578,21 @@ int alloc_histograms_for_table_share(THD* thd, TABLE_SHARE *table_share,
   Table_statistics *table_stats= stats_cb->table_stats;
   ulong total_hist_size= table_stats->total_hist_size;
 
-  if (total_hist_size && !table_stats->histograms)
+  if (!table_stats->histograms)
   {
-    uchar *histograms= (uchar *) alloc_root(&stats_cb->mem_root,
-                                            total_hist_size);
-    if (!histograms)
+    if (total_hist_size)
     {
-      if (!is_safe)
-        mysql_mutex_unlock(&table_share->LOCK_share);
-      DBUG_RETURN(1);
+      uchar *histograms= (uchar *) alloc_root(&stats_cb->mem_root,
+                                              total_hist_size);
+      if (!histograms)
+      {
+        if (!is_safe)
+          mysql_mutex_unlock(&table_share->LOCK_share);
+        DBUG_RETURN(1);
+      }
+      memset(histograms, 0, total_hist_size);
+      table_stats->histograms= histograms;
     }
-    memset(histograms, 0, total_hist_size);
-    table_stats->histograms= histograms;
     stats_cb->histograms_can_be_read= TRUE;
   }
 
@@ -2503,16 +2677,56 @@ bool Column_statistics_collected::add(ha_rows rowno)
 }
 
 
+/**
+  @brief
+  Estimate the number of distinct values in a column from a sample
+
+  @param
+  sampled       The number of non-null values in the sample
+  @param
+  distincts     The number of distinct values in the sample
+  @param
+  singletons    The number of values occurring only once in the sample
+  @param
+  total         The number of non-null values in the column
+
+  @details
+  The function uses the Duj1 estimator of Haas and Stokes:
+    D = n * d / (n - f1 + f1 * n / N)
+  Values that are seen only once in the sample are likely to be part of
+  many more values not seen at all, while the values seen many times are
+  likely to be all the values there are.
+*/
+
+static double estimate_distincts(double sampled, double distincts,
+                                 double singletons, double total)
+{
+  double estimate;
+  if (sampled >= total)
+    return distincts;
+  estimate= sampled * distincts /
+            (sampled - singletons + singletons * sampled / total);
+  set_if_bigger(estimate, distincts);
+  set_if_smaller(estimate, total);
+  return estimate;
+}
+
+
 /**
   @brief
   Get the results of aggregation when collecting the statistics on a column
   
   @param
-  rows          The total number of rows in the table 
+  rows             The number of rows the statistics was collected on
+  @param
+  sample_fraction  The fraction of the rows of the table these rows are
+  @param
+  mem_root         Where to allocate the text of a JSON_HB histogram
 */
 
 inline
-void Column_statistics_collected::finish(ha_rows rows)
+void Column_statistics_collected::finish(ha_rows rows, double sample_fraction,
+                                         MEM_ROOT *mem_root)
 {
   double val;
 
@@ -2530,20 +2744,33 @@ void Column_statistics_collected::finish(ha_rows rows)
   }
   if (count_distinct)
   {
-    ulonglong distincts;
+    ulonglong distincts, singletons= 0;
+    bool sampled= sample_fraction < 1.0;
     uint hist_size= count_distinct->get_hist_size();
     if (hist_size == 0)
-      distincts= count_distinct->get_value();
+      distincts= count_distinct->get_value(sampled ? &singletons : NULL);
     else
-      distincts= count_distinct->get_value_with_histogram(rows - nulls);
+      distincts= count_distinct->get_value_with_histogram(rows - nulls,
+                                                          &singletons,
+                                                          mem_root);
     if (distincts)
     {
-      val= (double) (rows - nulls) / distincts;
+      if (sampled)
+      {
+        double total= (rows - nulls) / sample_fraction;
+        val= total / estimate_distincts((double) (rows - nulls),
+                                        (double) distincts,
+                                        (double) singletons, total);
+      }
+      else
+        val= (double) (rows - nulls) / distincts;
       set_avg_frequency(val); 
       set_not_null(COLUMN_STAT_AVG_FREQUENCY);
     }
     else
       hist_size= 0;
+    if (!count_distinct->get_histogram())
+      hist_size= 0;
     histogram.set_size(hist_size);
     set_not_null(COLUMN_STAT_HIST_SIZE);
     if (hist_size && distincts)
@@ -2668,6 +2895,395 @@ int collect_statistics_for_index(THD *thd, TABLE *table, uint index)
 }
 
 
+/*
+  Column_stats_collector collects statistics on the columns of a table
+  in worker threads while the thread running ANALYZE TABLE scans the table.
+
+  The columns are divided among the workers. The scanning thread copies
+  the rows to be aggregated into a batch and hands a full batch to all
+  workers at once, then fills another batch while the workers are busy
+  with the first one. Every worker reads the values of its columns through
+  its own copies of the Field objects that are moved over the rows of the
+  batch, so the fields of the table are never touched by the workers.
+  When the scan is over each worker calculates the statistics on its
+  columns. Blob columns are left to the scanning thread, as their values
+  are not stored in the record buffer.
+*/
+
+#define COLLECT_STATS_BATCH_SIZE (128 * 1024)
+
+class Column_stats_collector: public Sql_alloc
+{
+public:
+  class Worker
+  {
+  public:
+    Column_stats_collector *collector;
+    Field **columns;        /* Copies of the fields of the worker's columns */
+    uint n_columns;
+    uchar *record;          /* The record the copies are moved to at the end */
+    const uchar *pos;       /* The record the copies currently point to */
+    MEM_ROOT mem_root;      /* For the JSON_HB histograms of the columns */
+    pthread_t thread;
+    bool error;
+  };
+
+private:
+  THD *thd;
+  TABLE *table;
+  Worker *workers;
+  uint n_workers;
+  uint started;
+  uchar *batches[2];
+  uint max_batch_rows;
+  uint cur_batch;           /* The batch filled by the scanning thread */
+  uint cur_batch_rows;
+  ha_rows cur_batch_rowno;  /* Number of the first row of the batch */
+
+  mysql_mutex_t LOCK_collect_stats;
+  mysql_cond_t COND_collect_stats;
+  /* The fields below are protected by LOCK_collect_stats */
+  const uchar *batch;       /* The batch the workers aggregate */
+  uint batch_rows;
+  ha_rows batch_rowno;
+  ulong batch_no;
+  uint busy;                /* Workers that have not done with the batch */
+  bool end_of_scan;
+  bool failed;
+  ha_rows rows;
+  double sample_fraction;
+
+  Column_stats_collector(THD *thd_arg, TABLE *table_arg)
+    :thd(thd_arg), table(table_arg), started(0), cur_batch(0),
+     cur_batch_rows(0), cur_batch_rowno(0), batch(NULL), batch_rows(0),
+     batch_rowno(0), batch_no(0), busy(0), end_of_scan(FALSE),
+     failed(FALSE), rows(0), sample_fraction(1.0)
+  {}
+
+  void dispatch_batch();
+  bool aggregate(Worker *worker, const uchar *rec, uint count,
+                 ha_rows rowno);
+
+public:
+  static Column_stats_collector *create(THD *thd, TABLE *table);
+
+  /* Check whether the statistics on the column is collected by workers */
+  static bool is_collected(const Field *field)
+  {
+    return !(field->flags & BLOB_FLAG);
+  }
+
+  /**
+    @brief
+    Pass the current row of the table to the workers
+
+    @retval TRUE   a worker has failed
+  */
+  bool add_row()
+  {
+    memcpy(batches[cur_batch] + cur_batch_rows * table->s->reclength,
+           table->record[0], table->s->reclength);
+    if (++cur_batch_rows == max_batch_rows)
+      dispatch_batch();
+    return failed;
+  }
+
+  bool end(ha_rows rows_arg, double sample_fraction_arg, bool scan_failed);
+  void run(Worker *worker);
+};
+
+
+pthread_handler_t handle_collect_stats_thread(void *arg)
+{
+  THD *thd;
+  Column_stats_collector::Worker *worker=
+    (Column_stats_collector::Worker *) arg;
+
+  my_thread_init();
+  thd= new THD(next_thread_id());
+  thd->thread_stack= (char*) &thd;
+  thd->store_globals();
+  thd->system_thread= SYSTEM_THREAD_GENERIC;
+  thd->security_ctx->skip_grants();
+
+  worker->collector->run(worker);
+
+  delete thd;
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/**
+  @brief
+  Start the workers collecting statistics on the columns of a table
+
+  @param
+  thd         The thread handle
+  @param
+  table       The table to collect statistics on
+
+  @return
+  The collector, or NULL if the statistics is to be collected by the
+  scanning thread only
+*/
+
+Column_stats_collector *Column_stats_collector::create(THD *thd, TABLE *table)
+{
+  Column_stats_collector *collector;
+  Field **field_ptr;
+  uint n_columns= 0, col= 0;
+  size_t reclength= table->s->reclength;
+  DBUG_ENTER("Column_stats_collector::create");
+
+  if (!thd->variables.analyze_threads)
+    DBUG_RETURN(NULL);
+  for (field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    if (bitmap_is_set(table->read_set, (*field_ptr)->field_index) &&
+        is_collected(*field_ptr))
+      n_columns++;
+  }
+  if (!n_columns)
+    DBUG_RETURN(NULL);
+
+  if (!(collector= new (thd->mem_root) Column_stats_collector(thd, table)))
+    DBUG_RETURN(NULL);
+  collector->n_workers= (uint) MY_MIN(thd->variables.analyze_threads,
+                                      n_columns);
+  collector->max_batch_rows= (uint) MY_MAX(COLLECT_STATS_BATCH_SIZE /
+                                           reclength, 1);
+  if (!(collector->workers= (Worker *)
+        thd->calloc(sizeof(Worker) * collector->n_workers)) ||
+      !(collector->batches[0]= (uchar *)
+        thd->alloc(reclength * collector->max_batch_rows)) ||
+      !(collector->batches[1]= (uchar *)
+        thd->alloc(reclength * collector->max_batch_rows)))
+    DBUG_RETURN(NULL);
+
+  /* Give the columns to the workers in turn */
+  for (uint i= 0; i < collector->n_workers; i++)
+  {
+    Worker *worker= collector->workers + i;
+    worker->collector= collector;
+    worker->pos= table->record[0];
+    init_alloc_root(&worker->mem_root, "Column_stats_collector", 1024, 0,
+                    MYF(0));
+    if (!(worker->columns= (Field **)
+          thd->alloc(sizeof(Field *) *
+                     ((n_columns + collector->n_workers - 1 - i) /
+                      collector->n_workers))) ||
+        !(worker->record= (uchar *) thd->memdup(table->s->default_values,
+                                                reclength)))
+      DBUG_RETURN(NULL);
+  }
+  for (field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    Worker *worker;
+    if (!bitmap_is_set(table->read_set, (*field_ptr)->field_index) ||
+        !is_collected(*field_ptr))
+      continue;
+    worker= collector->workers + col++ % collector->n_workers;
+    if (!(worker->columns[worker->n_columns++]=
+          (*field_ptr)->clone(thd->mem_root, (my_ptrdiff_t) 0)))
+      DBUG_RETURN(NULL);
+  }
+
+  mysql_mutex_init(key_LOCK_collect_stats, &collector->LOCK_collect_stats,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_collect_stats, &collector->COND_collect_stats,
+                  NULL);
+  for (uint i= 0; i < collector->n_workers; i++)
+  {
+    if (mysql_thread_create(key_thread_collect_stats,
+                            &collector->workers[i].thread, NULL,
+                            handle_collect_stats_thread,
+                            collector->workers + i))
+    {
+      /* Let the started workers go and collect everything serially */
+      collector->end(0, 1.0, TRUE);
+      DBUG_RETURN(NULL);
+    }
+    collector->started++;
+  }
+  DBUG_RETURN(collector);
+}
+
+
+/**
+  @brief
+  Hand the rows copied by the scanning thread to the workers
+
+  @details
+  The function waits for the workers to be done with the previous batch,
+  so the scanning thread can go on with filling it.
+*/
+
+void Column_stats_collector::dispatch_batch()
+{
+  mysql_mutex_lock(&LOCK_collect_stats);
+  while (busy)
+    mysql_cond_wait(&COND_collect_stats, &LOCK_collect_stats);
+  for (uint i= 0; i < started; i++)
+    failed|= workers[i].error;
+  batch= batches[cur_batch];
+  batch_rows= cur_batch_rows;
+  batch_rowno= cur_batch_rowno;
+  batch_no++;
+  busy= started;
+  mysql_cond_broadcast(&COND_collect_stats);
+  mysql_mutex_unlock(&LOCK_collect_stats);
+
+  cur_batch^= 1;
+  cur_batch_rowno+= cur_batch_rows;
+  cur_batch_rows= 0;
+}
+
+
+/**
+  @brief
+  Wait for the workers to finish the statistics on their columns
+
+  @param
+  rows             The number of rows the statistics was collected on
+  @param
+  sample_fraction  The fraction of the rows of the table these rows are
+  @param
+  scan_failed      TRUE if the scan has failed, then the collected data
+                   is only cleaned up
+
+  @retval
+  TRUE    a worker has failed
+  @retval
+  FALSE   otherwise
+*/
+
+bool Column_stats_collector::end(ha_rows rows_arg, double sample_fraction_arg,
+                                 bool scan_failed)
+{
+  bool res;
+  if (!scan_failed && cur_batch_rows)
+    dispatch_batch();
+
+  mysql_mutex_lock(&LOCK_collect_stats);
+  while (busy)
+    mysql_cond_wait(&COND_collect_stats, &LOCK_collect_stats);
+  for (uint i= 0; i < started; i++)
+    failed|= workers[i].error;
+  failed|= scan_failed;
+  res= failed;
+  rows= rows_arg;
+  sample_fraction= sample_fraction_arg;
+  end_of_scan= TRUE;
+  mysql_cond_broadcast(&COND_collect_stats);
+  mysql_mutex_unlock(&LOCK_collect_stats);
+
+  for (uint i= 0; i < started; i++)
+    pthread_join(workers[i].thread, NULL);
+  mysql_cond_destroy(&COND_collect_stats);
+  mysql_mutex_destroy(&LOCK_collect_stats);
+
+  /* The JSON_HB histograms built by the workers are moved to the table */
+  for (uint i= 0; i < n_workers; i++)
+  {
+    Worker *worker= workers + i;
+    for (uint j= 0; !res && j < worker->n_columns; j++)
+    {
+      Histogram *histogram= &worker->columns[j]->collected_stats->histogram;
+      uchar *text;
+      if (histogram->get_type() != JSON_HB || !histogram->get_values())
+        continue;
+      text= (uchar *) memdup_root(&table->mem_root, histogram->get_values(),
+                                  histogram->get_text_length());
+      histogram->set_values(text);
+      res= !text;
+    }
+    free_root(&worker->mem_root, MYF(0));
+  }
+  return res;
+}
+
+
+/**
+  @brief
+  Aggregate the values of the worker's columns from a batch of rows
+*/
+
+bool Column_stats_collector::aggregate(Worker *worker, const uchar *rec,
+                                       uint count, ha_rows rowno)
+{
+  size_t reclength= table->s->reclength;
+  for (uint k= 0; k < count; k++, rec+= reclength)
+  {
+    my_ptrdiff_t diff= (my_ptrdiff_t) (rec - worker->pos);
+    worker->pos= rec;
+    for (uint i= 0; i < worker->n_columns; i++)
+    {
+      Field *column= worker->columns[i];
+      column->move_field_offset(diff);
+      if (column->collected_stats->add(rowno + k))
+        return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+
+/**
+  @brief
+  The loop of a worker: aggregate the batches until the scan is over,
+  then calculate the statistics on the worker's columns
+*/
+
+void Column_stats_collector::run(Worker *worker)
+{
+  ulong done_batch_no= 0;
+  my_ptrdiff_t diff;
+
+  for (uint i= 0; i < worker->n_columns; i++)
+    worker->columns[i]->collected_stats->init(thd, worker->columns[i]);
+
+  mysql_mutex_lock(&LOCK_collect_stats);
+  for (;;)
+  {
+    const uchar *rec;
+    uint count;
+    ha_rows rowno;
+    while (batch_no == done_batch_no && !end_of_scan)
+      mysql_cond_wait(&COND_collect_stats, &LOCK_collect_stats);
+    if (batch_no == done_batch_no)
+      break;
+    done_batch_no= batch_no;
+    rec= batch;
+    count= batch_rows;
+    rowno= batch_rowno;
+    mysql_mutex_unlock(&LOCK_collect_stats);
+
+    if (!worker->error)
+      worker->error= aggregate(worker, rec, count, rowno);
+
+    mysql_mutex_lock(&LOCK_collect_stats);
+    if (!--busy)
+      mysql_cond_broadcast(&COND_collect_stats);
+  }
+  mysql_mutex_unlock(&LOCK_collect_stats);
+
+  /* Building a histogram stores values into the column */
+  diff= (my_ptrdiff_t) (worker->record - worker->pos);
+  for (uint i= 0; i < worker->n_columns; i++)
+  {
+    Field *column= worker->columns[i];
+    column->move_field_offset(diff);
+    if (!failed)
+      column->collected_stats->finish(rows, sample_fraction,
+                                      &worker->mem_root);
+    else
+      column->collected_stats->cleanup();
+  }
+}
+
+
 /**
   @brief 
   Collect statistical data for a table
@@ -2703,6 +3319,9 @@ int collect_statistics_for_index(THD *thd, TABLE *table, uint index)
   (or its derivation). Currently this class cannot count the number of
   distinct values for blob columns. So the value of 'avg_frequency' for
   blob columns is always null.
+  If analyze_threads is set, the statistics on all columns but blobs is
+  collected by worker threads that get the rows from the scan, see
+  Column_stats_collector.
   After the full table scan the function calls collect_statistics_for_index
   for each table index. The latter performs full index scan for each index.
 
@@ -2725,25 +3344,49 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
   int rc;
   Field **field_ptr;
   Field *table_field;
-  ha_rows rows= 0;
+  ha_rows rows= 0, sampled_rows= 0;
   handler *file=table->file;
+  double sample_fraction;
+  Column_stats_collector *collector;
 
   DBUG_ENTER("collect_statistics_for_table");
 
   table->collected_stats->cardinality_is_null= TRUE;
   table->collected_stats->cardinality= 0;
 
+  collector= Column_stats_collector::create(thd, table);
+
   for (field_ptr= table->field; *field_ptr; field_ptr++)
   {
     table_field= *field_ptr;   
-    if (!bitmap_is_set(table->read_set, table_field->field_index))
+    if (!bitmap_is_set(table->read_set, table_field->field_index) ||
+        (collector && collector->is_collected(table_field)))
       continue; 
     table_field->collected_stats->init(thd, table_field);
   }
 
   restore_record(table, s->default_values);
 
-  /* Perform a full table scan to collect statistics on 'table's columns */
+  if (thd->variables.analyze_sample_percentage == 0)
+  {
+    /* Sample enough rows for good estimates, a bit more for big tables */
+    ha_rows records;
+    file->info(HA_STATUS_VARIABLE);
+    records= file->stats.records;
+    if (records <= MIN_ROWS_FOR_ANALYZE_SAMPLING)
+      sample_fraction= 1.0;
+    else
+      sample_fraction= MY_MIN(1.0, (MIN_ROWS_FOR_ANALYZE_SAMPLING +
+                                    4096 * log(200.0 * records)) / records);
+  }
+  else
+    sample_fraction= thd->variables.analyze_sample_percentage / 100;
+
+  /*
+    Perform a full table scan to collect statistics on 'table's columns.
+    When sampling, the statistics on the columns is collected only on
+    the rows picked at random, the rest of the rows are only counted.
+  */
   if (!(rc= file->ha_rnd_init(TRUE)))
   {  
     DEBUG_SYNC(table->in_use, "statistics_collection_start");
@@ -2756,17 +3399,22 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
       if (rc)
         break;
 
+      rows++;
+      if (sample_fraction < 1.0 && my_rnd(&thd->rand) >= sample_fraction)
+        continue;
+
       for (field_ptr= table->field; *field_ptr; field_ptr++)
       {
         table_field= *field_ptr;
-        if (!bitmap_is_set(table->read_set, table_field->field_index))
+        if (!bitmap_is_set(table->read_set, table_field->field_index) ||
+            (collector && collector->is_collected(table_field)))
           continue;  
-        if ((rc= table_field->collected_stats->add(rows)))
+        if ((rc= table_field->collected_stats->add(sampled_rows)))
           break;
       }
-      if (rc)
+      if (rc || (collector && (rc= collector->add_row())))
         break;
-      rows++;
+      sampled_rows++;
     }
     file->ha_rnd_end();
   }
@@ -2775,23 +3423,38 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
   /* 
     Calculate values for all statistical characteristics on columns and
     and for each field f of 'table' save them in the write_stat structure
-    from the Field object for f. 
+    from the Field object for f. The workers do it for their columns
+    when they are told that the scan is over.
   */
+  bitmap_clear_all(table->write_set);
+  for (field_ptr= table->field; *field_ptr; field_ptr++)
+  {
+    table_field= *field_ptr;
+    if (bitmap_is_set(table->read_set, table_field->field_index))
+      bitmap_set_bit(table->write_set, table_field->field_index);
+  }
+  if (collector && collector->end(sampled_rows,
+                                  rows ? (double) sampled_rows / rows : 1.0,
+                                  rc))
+    rc= 1;
+
   if (!rc)
   {
     table->collected_stats->cardinality_is_null= FALSE;
     table->collected_stats->cardinality= rows;
   }
 
-  bitmap_clear_all(table->write_set);
   for (field_ptr= table->field; *field_ptr; field_ptr++)
   {
     table_field= *field_ptr;
-    if (!bitmap_is_set(table->read_set, table_field->field_index))
+    if (!bitmap_is_set(table->read_set, table_field->field_index) ||
+        (collector && collector->is_collected(table_field)))
       continue;
-    bitmap_set_bit(table->write_set, table_field->field_index); 
     if (!rc)
-      table_field->collected_stats->finish(rows);
+      table_field->collected_stats->finish(sampled_rows,
+                                           rows ? (double) sampled_rows / rows :
+                                                  1.0,
+                                           &table->mem_root);
     else
       table_field->collected_stats->cleanup();
   }
@@ -2989,7 +3652,9 @@ int read_statistics_for_table(THD *thd, TABLE *table, TABLE_LIST *stat_tables)
     table_field= *field_ptr;
     column_stat.set_key_fields(table_field);
     column_stat.get_stat_values();
-    total_hist_size+= table_field->read_stats->histogram.get_size();
+    /* JSON_HB histograms are allocated when they are read */
+    if (table_field->read_stats->histogram.get_type() != JSON_HB)
+      total_hist_size+= table_field->read_stats->histogram.get_size();
   }
   read_stats->total_hist_size= total_hist_size;
 
@@ -3210,11 +3875,34 @@ int read_histograms_for_table(THD *thd, TABLE *table, TABLE_LIST *stat_tables)
     uchar *histogram= table_share->stats_cb.table_stats->histograms;
     TABLE *stat_table= stat_tables[COLUMN_STAT].table;
     Column_stat column_stat(stat_table, table);
+    uchar *record= NULL;
     for (field_ptr= table_share->field; *field_ptr; field_ptr++)
     {
       Field *table_field= *field_ptr;
       uint hist_size= table_field->read_stats->histogram.get_size();
-      if (hist_size)
+      if (hist_size &&
+          table_field->read_stats->histogram.get_type() == JSON_HB)
+      {
+        /*
+          The values of the histogram are converted to the record format
+          in a buffer of their own, so the record of the table is not
+          touched.
+        */
+        Field *value_field;
+        if (!record &&
+            !(record= (uchar *) thd->calloc(table_share->reclength)))
+          break;
+        if (!(value_field=
+              table->field[table_field->field_index]->
+                clone(thd->mem_root, record - table->record[0])))
+          break;
+        column_stat.set_key_fields(table_field);
+        mysql_mutex_lock(&table_share->LOCK_share);
+        column_stat.get_json_histogram(value_field,
+                                       &table_share->stats_cb.mem_root);
+        mysql_mutex_unlock(&table_share->LOCK_share);
+      }
+      else if (hist_size)
       {
         column_stat.set_key_fields(table_field);
         table_field->read_stats->histogram.set_values(histogram);
@@ -3855,11 +4543,19 @@ double get_column_range_cardinality(Field *field,
         {
           store_key_image_to_rec(field, (uchar *) min_endp->key,
                                  field->key_length());
-          double pos= field->pos_in_interval(col_stats->min_value,
-                                             col_stats->max_value);
-          res= col_non_nulls * 
-	       hist->point_selectivity(pos,
-                                       avg_frequency / col_non_nulls);
+          if (hist->get_json())
+            res= col_non_nulls *
+                 hist->get_json()->point_selectivity(field,
+                                                     avg_frequency /
+                                                     col_non_nulls);
+          else
+          {
+            double pos= field->pos_in_interval(col_stats->min_value,
+                                               col_stats->max_value);
+            res= col_non_nulls * 
+                 hist->point_selectivity(pos,
+                                         avg_frequency / col_non_nulls);
+          }
         }
       }
       else if (avg_frequency == 0.0)
@@ -3874,6 +4570,10 @@ double get_column_range_cardinality(Field *field,
     if (col_stats->min_max_values_are_provided())
     {
       double sel, min_mp_pos, max_mp_pos;
+      Histogram *hist= &col_stats->histogram;
+      Histogram_json *json= hist->get_json();
+      /* Fractions of the values below the ends of the range, for JSON_HB */
+      double min_fraction= 0.0, max_fraction= 1.0;
 
       if (min_endp && !(field->null_ptr && min_endp->key[0]))
       {
@@ -3881,6 +4581,9 @@ double get_column_range_cardinality(Field *field,
                                field->key_length());
         min_mp_pos= field->pos_in_interval(col_stats->min_value,
                                            col_stats->max_value);
+        if (json)
+          min_fraction= json->fraction_below(field, min_mp_pos,
+                                             range_flag & NEAR_MIN);
       }
       else
         min_mp_pos= 0.0;
@@ -3890,12 +4593,16 @@ double get_column_range_cardinality(Field *field,
                                field->key_length());
         max_mp_pos= field->pos_in_interval(col_stats->min_value,
                                            col_stats->max_value);
+        if (json)
+          max_fraction= json->fraction_below(field, max_mp_pos,
+                                             !(range_flag & NEAR_MAX));
       }
       else
         max_mp_pos= 1.0;
 
-      Histogram *hist= &col_stats->histogram;
-      if (!hist->is_available())
+      if (json)
+        sel= MY_MAX(max_fraction - min_fraction, 0.0);
+      else if (!hist->is_available())
         sel= (max_mp_pos - min_mp_pos);
       else
         sel= hist->range_selectivity(min_mp_pos, max_mp_pos);
@@ -4043,3 +4750,288 @@ bool is_stat_table(const LEX_CSTRING *db, LEX_CSTRING *table)
   }
   return false;
 }
+
+
+/*
+  Statistics on a table changed a lot since it was collected is collected
+  again by the background thread handle_stats_recalc.
+
+  Every table share counts the rows changed in the table. When the count
+  reaches analyze_auto_recalc_percentage percent of the cardinality of the
+  table from table_stats, the table is put into the queue of the thread.
+  The thread collects the statistics on all columns and indexes of the
+  table the way ANALYZE TABLE ... PERSISTENT FOR ALL does, with the global
+  values of the system variables. Only tables whose statistics has been
+  read from the statistical tables are counted, the count starts anew when
+  the share is loaded again.
+*/
+
+struct stats_recalc_request
+{
+  stats_recalc_request *next;
+  char db[NAME_LEN + 1];
+  char table_name[NAME_LEN + 1];
+};
+
+static mysql_mutex_t LOCK_stats_recalc;
+static mysql_cond_t COND_stats_recalc;
+/* The fields below are protected by LOCK_stats_recalc */
+static stats_recalc_request *stats_recalc_queue;
+static bool stats_recalc_thread_running;
+static bool stats_recalc_thread_stop;
+static THD *stats_recalc_thd;
+/* Set when LOCK_stats_recalc and COND_stats_recalc are initialized */
+static bool stats_recalc_inited;
+
+
+/**
+  @brief
+  Count the rows changed in a table by a statement
+
+  @param
+  table   The table the rows are changed in
+  @param
+  rows    The number of the changed rows
+
+  @details
+  The function queues the table for the collection of its statistics
+  when enough of its rows have been changed.
+*/
+
+void note_rows_changed_for_statistics(TABLE *table, ulonglong rows)
+{
+  TABLE_SHARE *share= table->s;
+  TABLE_STATISTICS_CB *stats_cb= &share->stats_cb;
+  ulonglong percentage= analyze_auto_recalc_percentage;
+  ulonglong changed;
+  stats_recalc_request *request, **last;
+
+  if (!percentage || !stats_recalc_inited ||
+      share->tmp_table != NO_TMP_TABLE ||
+      share->table_category != TABLE_CATEGORY_USER ||
+      !stats_cb->stats_is_read ||
+      stats_cb->table_stats->cardinality_is_null)
+    return;
+
+  changed= (ulonglong) my_atomic_add64(&stats_cb->rows_changed,
+                                       (int64) rows) + rows;
+  if (changed * 100 < percentage * stats_cb->table_stats->cardinality ||
+      my_atomic_fas32(&stats_cb->recalc_requested, 1))
+    return;
+
+  if (!(request= (stats_recalc_request *) my_malloc(sizeof(*request),
+                                                    MYF(0))))
+    return;
+  request->next= NULL;
+  strmake(request->db, share->db.str, NAME_LEN);
+  strmake(request->table_name, share->table_name.str, NAME_LEN);
+
+  mysql_mutex_lock(&LOCK_stats_recalc);
+  for (last= &stats_recalc_queue; *last; last= &(*last)->next)
+  {
+    if (!strcmp((*last)->db, request->db) &&
+        !strcmp((*last)->table_name, request->table_name))
+      break;
+  }
+  if (stats_recalc_thread_running && !stats_recalc_thread_stop && !*last)
+  {
+    *last= request;
+    request= NULL;
+    mysql_cond_signal(&COND_stats_recalc);
+  }
+  mysql_mutex_unlock(&LOCK_stats_recalc);
+  my_free(request);
+}
+
+
+/**
+  @brief
+  Collect the statistics on a table queued by note_rows_changed_for_statistics
+
+  @param
+  thd       The thread handle of the background thread
+  @param
+  request   The table to collect the statistics on
+*/
+
+static void recalc_table_statistics(THD *thd, stats_recalc_request *request)
+{
+  TABLE_LIST tables;
+  LEX_CSTRING db= { request->db, strlen(request->db) };
+  LEX_CSTRING table_name= { request->table_name,
+                            strlen(request->table_name) };
+  int rc= 1;
+  DBUG_ENTER("recalc_table_statistics");
+
+  thd->reset_for_next_command();
+  tables.init_one_table(&db, &table_name, NULL, TL_READ);
+  if (!open_and_lock_tables(thd, &tables, FALSE, 0))
+  {
+    TABLE *table= tables.table;
+    /* The same columns as ANALYZE TABLE ... PERSISTENT FOR ALL takes */
+    bitmap_clear_all(table->read_set);
+    for (Field **field_ptr= table->field; *field_ptr; field_ptr++)
+    {
+      enum enum_field_types type= (*field_ptr)->type();
+      if (type < MYSQL_TYPE_MEDIUM_BLOB || type > MYSQL_TYPE_BLOB)
+        bitmap_set_bit(table->read_set, (*field_ptr)->field_index);
+    }
+    if (!(rc= alloc_statistics_for_table(thd, table)) &&
+        !(rc= collect_statistics_for_table(thd, table)))
+      rc= update_statistics_for_table(thd, table);
+  }
+  if (rc)
+  {
+    trans_rollback_stmt(thd);
+    trans_rollback(thd);
+  }
+  else
+  {
+    trans_commit_stmt(thd);
+    trans_commit(thd);
+  }
+  close_thread_tables(thd);
+  thd->mdl_context.release_transactional_locks();
+  /*
+    Start counting the changed rows anew, also when the collection failed:
+    the share may stay in use and otherwise would never be queued again.
+  */
+  TDC_element *element= tdc_lock_share(thd, db.str, table_name.str);
+  if (element && element != MY_ERRPTR)
+  {
+    TABLE_STATISTICS_CB *stats_cb= &element->share->stats_cb;
+    my_atomic_store64(&stats_cb->rows_changed, 0);
+    my_atomic_store32(&stats_cb->recalc_requested, 0);
+    tdc_unlock_share(element);
+  }
+  /* The new statistics is read when the share is loaded again */
+  if (!rc)
+  {
+    tdc_remove_table(thd, TDC_RT_REMOVE_UNUSED, db.str, table_name.str,
+                     FALSE);
+    /* Join orders were chosen with the old statistics */
+    plan_cache_flush();
+  }
+  thd->clear_error();
+  DBUG_VOID_RETURN;
+}
+
+
+pthread_handler_t handle_stats_recalc(void *arg __attribute__((unused)))
+{
+  stats_recalc_request *request;
+
+  my_thread_init();
+  mysql_mutex_lock(&LOCK_stats_recalc);
+  for (;;)
+  {
+    THD *thd;
+    while (!stats_recalc_queue && !stats_recalc_thread_stop)
+      mysql_cond_wait(&COND_stats_recalc, &LOCK_stats_recalc);
+    if (stats_recalc_thread_stop)
+      break;
+    request= stats_recalc_queue;
+    stats_recalc_queue= request->next;
+    mysql_mutex_unlock(&LOCK_stats_recalc);
+
+    /* A new THD takes the current global values of the variables */
+    thd= new THD(next_thread_id());
+    thd->thread_stack= (char*) &thd;
+    thd->system_thread= SYSTEM_THREAD_GENERIC;
+    thread_safe_increment32(&service_thread_count);
+    thd->store_globals();
+    thd->security_ctx->skip_grants();
+    thd->set_command(COM_DAEMON);
+    /* The statistics is collected by every server on its own */
+    thd->variables.option_bits&= ~OPTION_BIN_LOG;
+
+    mysql_mutex_lock(&LOCK_stats_recalc);
+    stats_recalc_thd= thd;
+    if (stats_recalc_thread_stop)
+      thd->set_killed(KILL_CONNECTION);
+    mysql_mutex_unlock(&LOCK_stats_recalc);
+
+    recalc_table_statistics(thd, request);
+    my_free(request);
+
+    mysql_mutex_lock(&LOCK_stats_recalc);
+    stats_recalc_thd= NULL;
+    mysql_mutex_unlock(&LOCK_stats_recalc);
+    delete thd;
+    thread_safe_decrement32(&service_thread_count);
+    signal_thd_deleted();
+
+    mysql_mutex_lock(&LOCK_stats_recalc);
+  }
+
+  while ((request= stats_recalc_queue))
+  {
+    stats_recalc_queue= request->next;
+    my_free(request);
+  }
+  stats_recalc_thread_running= false;
+  mysql_cond_broadcast(&COND_stats_recalc);
+  mysql_mutex_unlock(&LOCK_stats_recalc);
+
+  my_thread_end();
+  return 0;
+}
+
+
+/*
+  Start the thread collecting the statistics on the tables changed
+  since their statistics was collected
+*/
+
+void start_stats_recalc_thread()
+{
+  pthread_t th;
+  DBUG_ENTER("start_stats_recalc_thread");
+
+  mysql_mutex_init(key_LOCK_stats_recalc, &LOCK_stats_recalc,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_stats_recalc, &COND_stats_recalc, NULL);
+  stats_recalc_inited= true;
+  stats_recalc_thread_running= true;
+  stats_recalc_thread_stop= false;
+  if (mysql_thread_create(key_thread_stats_recalc, &th, &connection_attrib,
+                          handle_stats_recalc, NULL))
+  {
+    sql_print_warning("Can't create the thread collecting statistics "
+                      "on changed tables");
+    stats_recalc_thread_running= false;
+  }
+  DBUG_VOID_RETURN;
+}
+
+
+void stop_stats_recalc_thread()
+{
+  DBUG_ENTER("stop_stats_recalc_thread");
+  if (!stats_recalc_inited)
+    DBUG_VOID_RETURN;
+  mysql_mutex_lock(&LOCK_stats_recalc);
+  stats_recalc_thread_stop= true;
+  if (stats_recalc_thd)
+    stats_recalc_thd->set_killed(KILL_CONNECTION);
+  mysql_cond_broadcast(&COND_stats_recalc);
+  while (stats_recalc_thread_running)
+    mysql_cond_wait(&COND_stats_recalc, &LOCK_stats_recalc);
+  mysql_mutex_unlock(&LOCK_stats_recalc);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Free the synchronization objects of the thread. Must be called when no
+  other thread can close tables any more.
+*/
+
+void free_stats_recalc_thread()
+{
+  if (!stats_recalc_inited)
+    return;
+  stats_recalc_inited= false;
+  mysql_cond_destroy(&COND_stats_recalc);
+  mysql_mutex_destroy(&LOCK_stats_recalc);
+}
@@ -28,7 +28,8 @@ typedef
 enum enum_histogram_type
 {
   SINGLE_PREC_HB,
-  DOUBLE_PREC_HB
+  DOUBLE_PREC_HB,
+  JSON_HB
 } Histogram_type;
 
 enum enum_stat_tables
@@ -112,14 +113,22 @@ double get_column_range_cardinality(Field *field,
                                     key_range *max_endp,
                                     uint range_flag);
 bool is_stat_table(const LEX_CSTRING *db, LEX_CSTRING *table);
+void note_rows_changed_for_statistics(TABLE *table, ulonglong rows);
+void start_stats_recalc_thread();
+void stop_stats_recalc_thread();
+void free_stats_recalc_thread();
+
+class Histogram_json;
 
 class Histogram
 {
 
 private:
   Histogram_type type;
-  uint8 size; /* Size of values array, in bytes */
+  uint8 size; /* Size of values array, in bytes, or number of JSON buckets */
   uchar *values;
+  uint text_length;     /* Length of the JSON text in values */
+  Histogram_json *json; /* JSON_HB histogram prepared for the optimizer */
 
   uint prec_factor()
   {
@@ -128,6 +137,8 @@ class Histogram
       return ((uint) (1 << 8) - 1);
     case DOUBLE_PREC_HB:
       return ((uint) (1 << 16) - 1);
+    case JSON_HB:
+      break;
     }
     return 1;
   }
@@ -140,6 +151,8 @@ class Histogram
       return size;
     case DOUBLE_PREC_HB:
       return size / 2;
+    case JSON_HB:
+      return size;
     }
     return 0;
   }
@@ -153,6 +166,8 @@ class Histogram
       return (uint) (((uint8 *) values)[i]);
     case DOUBLE_PREC_HB:
       return (uint) uint2korr(values + i * 2);
+    case JSON_HB:
+      break;
     }
     return 0;
   }
@@ -210,7 +225,26 @@ class Histogram
 
   void set_values (uchar *vals) { values= (uchar *) vals; }
 
-  bool is_available() { return get_size() > 0 && get_values(); }
+  uint get_text_length() { return text_length; }
+
+  void set_text_length(uint length) { text_length= length; }
+
+  Histogram_json *get_json() { return json; }
+
+  void set_json(Histogram_json *hist) { json= hist; }
+
+  /* The length of the value stored in column_stats.histogram */
+  uint get_stored_length()
+  {
+    return type == JSON_HB ? text_length : get_size();
+  }
+
+  bool is_available()
+  {
+    if (type == JSON_HB)
+      return json != NULL;
+    return get_size() > 0 && get_values();
+  }
 
   void set_value(uint i, double val)
   {
@@ -221,6 +255,8 @@ class Histogram
     case DOUBLE_PREC_HB:
       int2store(values + i * 2, val * prec_factor());
       return;
+    case JSON_HB:
+      return;
     }
   }
 
@@ -233,6 +269,8 @@ class Histogram
     case DOUBLE_PREC_HB:
       int2store(values + i * 2, uint2korr(values + i * 2 - 2));
       return;
+    case JSON_HB:
+      return;
     }
   }
 
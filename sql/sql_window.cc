@@ -2763,20 +2763,53 @@ bool compute_window_func(THD *thd,
   while ((cursor_manager= iter_cursor_managers++))
     cursor_manager->initialize_cursors(&info);
 
-  /* One partition tracker for each window function. */
+  /*
+    One partition tracker for each distinct PARTITION BY list. Window
+    functions that use the same list share the tracker, so that the
+    partition columns of a row are compared only once.
+  */
+  uint n_funcs= window_functions.elements;
+  uint *func_tracker= (uint*) thd->alloc(sizeof(uint) * n_funcs);
+  bool *new_partition= (bool*) thd->alloc(sizeof(bool) * n_funcs);
+  Item_window_func **funcs= (Item_window_func**)
+    thd->alloc(sizeof(Item_window_func*) * n_funcs);
+  if (!func_tracker || !new_partition || !funcs)
+  {
+    end_read_record(&info);
+    return true;
+  }
+
   List<Group_bound_tracker> partition_trackers;
   Item_window_func *win_func;
+  uint i= 0;
   while ((win_func= iter_win_funcs++))
   {
-    Group_bound_tracker *tracker= new Group_bound_tracker(thd,
-                                        win_func->window_spec->partition_list);
-    // TODO(cvicentiu) This should be removed and placed in constructor.
-    tracker->init();
-    partition_trackers.push_back(tracker);
+    uint j;
+    funcs[i]= win_func;
+    for (j= 0; j < i; j++)
+    {
+      if (compare_order_lists(funcs[j]->window_spec->partition_list,
+                              win_func->window_spec->partition_list) ==
+          CMP_EQ)
+        break;
+    }
+    if (j < i)
+      func_tracker[i]= func_tracker[j];
+    else
+    {
+      Group_bound_tracker *tracker= new Group_bound_tracker(thd,
+                                          win_func->window_spec->partition_list);
+      // TODO(cvicentiu) This should be removed and placed in constructor.
+      tracker->init();
+      func_tracker[i]= partition_trackers.elements;
+      partition_trackers.push_back(tracker);
+    }
+    i++;
   }
 
   List_iterator_fast<Group_bound_tracker> iter_part_trackers(partition_trackers);
   ha_rows rownum= 0;
+  bool is_error= false;
   uchar *rowid_buf= (uchar*) my_malloc(tbl->file->ref_length, MYF(0));
 
   while (true)
@@ -2789,16 +2822,17 @@ bool compute_window_func(THD *thd,
     tbl->file->position(tbl->record[0]);
     memcpy(rowid_buf, tbl->file->ref, tbl->file->ref_length);
 
-    iter_win_funcs.rewind();
+    Group_bound_tracker *tracker;
     iter_part_trackers.rewind();
-    iter_cursor_managers.rewind();
+    for (i= 0; (tracker= iter_part_trackers++); i++)
+      new_partition[i]= tracker->check_if_next_group() || (rownum == 0);
 
-    Group_bound_tracker *tracker;
-    while ((win_func= iter_win_funcs++) &&
-           (tracker= iter_part_trackers++) &&
-           (cursor_manager= iter_cursor_managers++))
+    iter_cursor_managers.rewind();
+    for (i= 0; i < n_funcs; i++)
     {
-      if (tracker->check_if_next_group() || (rownum == 0))
+      win_func= funcs[i];
+      cursor_manager= iter_cursor_managers++;
+      if (new_partition[func_tracker[i]])
       {
         /* TODO(cvicentiu)
            Clearing window functions should happen through cursors. */
@@ -2813,17 +2847,23 @@ bool compute_window_func(THD *thd,
       /* Check if we found any error in the window function while adding values
          through cursors. */
       if (unlikely(thd->is_error() || thd->is_killed()))
+      {
+        is_error= true;
         break;
-
+      }
 
       /* Return to current row after notifying cursors for each window
-         function. */
-      tbl->file->ha_rnd_pos(tbl->record[0], rowid_buf);
+         function. save_window_function_values() reads the row itself. */
+      if (i + 1 < n_funcs)
+        tbl->file->ha_rnd_pos(tbl->record[0], rowid_buf);
     }
 
     /* We now have computed values for each window function. They can now
        be saved in the current row. */
-    save_window_function_values(window_functions, tbl, rowid_buf);
+    if (is_error ||
+        (is_error= save_window_function_values(window_functions, tbl,
+                                               rowid_buf)))
+      break;
 
     rownum++;
   }
@@ -2832,7 +2872,7 @@ bool compute_window_func(THD *thd,
   partition_trackers.delete_elements();
   end_read_record(&info);
 
-  return false;
+  return is_error;
 }
 
 /* Make a list that is a concation of two lists of ORDER elements */
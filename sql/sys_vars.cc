@@ -61,6 +61,7 @@
 #include "threadpool.h"
 #include "sql_repl.h"
 #include "opt_range.h"
+#include "sql_plan_cache.h"                     // plan_cache_resize
 #include "rpl_parallel.h"
 #include "semisync_master.h"
 #include "semisync_slave.h"
@@ -2026,6 +2027,17 @@ static Sys_var_ulong Sys_slave_parallel_max_queued(
        VALID_RANGE(0,2147483647), DEFAULT(131072), BLOCK_SIZE(1));
 
 
+static Sys_var_ulong Sys_slave_prefetch_window(
+       "slave_prefetch_window",
+       "How many bytes of relay log a helper thread may read ahead of the "
+       "SQL thread, looking up the rows that row events will modify so that "
+       "their pages are already cached when the events are applied. "
+       "0 disables prefetching. Enabling or disabling it takes effect at "
+       "the next START SLAVE.",
+       GLOBAL_VAR(opt_slave_prefetch_window), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0,2147483647), DEFAULT(0), BLOCK_SIZE(1));
+
+
 bool
 Sys_var_slave_parallel_mode::global_update(THD *thd, set_var *var)
 {
@@ -2335,6 +2347,16 @@ static Sys_var_ulong Sys_net_buffer_length(
        VALID_RANGE(1024, 1024*1024), DEFAULT(16384), BLOCK_SIZE(1024),
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(check_net_buffer_length));
 
+static Sys_var_ulong Sys_net_send_buffer_size(
+       "net_send_buffer_size",
+       "Size of the buffer that result set rows are collected in before "
+       "they are written to the client. A larger buffer means fewer and "
+       "bigger writes for large result sets. The buffer never shrinks "
+       "during the connection and is at most max_allowed_packet big. "
+       "0 means net_buffer_length",
+       SESSION_VAR(net_send_buffer_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024*1024*1024), DEFAULT(0), BLOCK_SIZE(1024));
+
 static bool fix_net_read_timeout(sys_var *self, THD *thd, enum_var_type type)
 {
   if (type != OPT_GLOBAL)
@@ -2497,6 +2519,10 @@ export const char *optimizer_switch_names[]=
   "condition_pushdown_for_derived",
   "split_materialized",
   "condition_pushdown_for_subquery",
+  "skip_scan",
+  "mrr_in_lists",
+  "join_cache_bloom_filter",
+  "derived_reoptimization",
   "default", 
   NullS
 };
@@ -3627,6 +3653,42 @@ static Sys_var_uint Sys_threadpool_threadpool_prio_kickup_timer(
   GLOBAL_VAR(threadpool_prio_kickup_timer), CMD_LINE(REQUIRED_ARG),
   VALID_RANGE(0, UINT_MAX), DEFAULT(1000), BLOCK_SIZE(1)
 );
+
+static bool check_threadpool_resource_groups(sys_var *self, THD *thd,
+                                             set_var *var)
+{
+  TP_resource_group groups[TP_MAX_RESOURCE_GROUPS];
+  uint count;
+  if (tp_parse_resource_groups(var->save_result.string_value.str,
+                               groups, &count))
+  {
+    my_error(ER_WRONG_VALUE_FOR_VAR, MYF(0), self->name.str,
+             var->save_result.string_value.str);
+    return true;
+  }
+  return false;
+}
+
+static bool fix_threadpool_resource_groups(sys_var*, THD*, enum_var_type)
+{
+  tp_set_resource_groups();
+  return false;
+}
+
+static Sys_var_charptr Sys_threadpool_resource_groups(
+ "thread_pool_resource_groups",
+ "Resource groups of the thread pool, as a ';' separated list of "
+ "name:option=value,... definitions. Options are user and schema, "
+ "which connections belong to the group, weight (1..1000), the group's "
+ "share of the pool when other groups compete for it, and max_active, "
+ "how many requests of the group may execute at the same time "
+ "(0 for no limit). Connections that match no group belong to the "
+ "group named 'default'",
+  GLOBAL_VAR(threadpool_resource_groups), CMD_LINE(REQUIRED_ARG),
+  IN_SYSTEM_CHARSET, DEFAULT(""), NO_MUTEX_GUARD, NOT_IN_BINLOG,
+  ON_CHECK(check_threadpool_resource_groups),
+  ON_UPDATE(fix_threadpool_resource_groups)
+);
 #endif /* HAVE_POOL_OF_THREADS */
 
 /**
@@ -5627,6 +5689,32 @@ static Sys_var_ulong Sys_sp_cache_size(
        GLOBAL_VAR(stored_program_cache_size), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, 512 * 1024), DEFAULT(256), BLOCK_SIZE(1));
 
+static bool fix_plan_cache_size(sys_var *self, THD *thd, enum_var_type type)
+{
+  plan_cache_resize(plan_cache_size);
+  return false;
+}
+
+static Sys_var_ulong Sys_plan_cache_size(
+       "plan_cache_size",
+       "Maximum number of join orders of prepared statements that are "
+       "kept for reuse by all connections. A join order is reused when the "
+       "same statement is executed again and the tables and their row "
+       "estimates have not changed much. 0 disables the cache",
+       GLOBAL_VAR(plan_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024 * 1024), DEFAULT(0), BLOCK_SIZE(1),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(fix_plan_cache_size));
+
+static Sys_var_mybool Sys_plan_cache_text_queries(
+       "plan_cache_text_queries",
+       "Also keep join orders of queries that are not prepared statements "
+       "in the plan cache. Queries share them when their digests are the "
+       "same, that is when they differ only in literals. Queries longer "
+       "than max_digest_length are not cached",
+       SESSION_VAR(plan_cache_text_queries), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 export const char *plugin_maturity_names[]=
 { "unknown", "experimental", "alpha", "beta", "gamma", "stable", 0 };
 static Sys_var_enum Sys_plugin_maturity(
@@ -5851,7 +5939,8 @@ static Sys_var_enum Sys_optimizer_use_stat_tables(
 
 static Sys_var_ulong Sys_histogram_size(
        "histogram_size",
-       "Number of bytes used for a histogram. "
+       "Number of bytes used for a histogram, or the number of buckets "
+       "of a JSON_HB histogram. "
        "If set to 0, no histograms are created by ANALYZE.",
        SESSION_VAR(histogram_size), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(0, 255), DEFAULT(0), BLOCK_SIZE(1));
@@ -5862,10 +5951,39 @@ static Sys_var_enum Sys_histogram_type(
        "Specifies type of the histograms created by ANALYZE. "
        "Possible values are: "
        "SINGLE_PREC_HB - single precision height-balanced, "
-       "DOUBLE_PREC_HB - double precision height-balanced.",
+       "DOUBLE_PREC_HB - double precision height-balanced, "
+       "JSON_HB - height-balanced with exact bucket endpoints and "
+       "the most common values, stored as JSON.",
        SESSION_VAR(histogram_type), CMD_LINE(REQUIRED_ARG),
        histogram_types, DEFAULT(0));
 
+static Sys_var_double Sys_analyze_sample_percentage(
+       "analyze_sample_percentage",
+       "Percentage of rows from the table ANALYZE TABLE will sample "
+       "to collect table statistics. Set to 0 to let MariaDB decide "
+       "what percentage of rows to sample.",
+       SESSION_VAR(analyze_sample_percentage),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, 100),
+       DEFAULT(100));
+
+static Sys_var_ulong Sys_analyze_threads(
+       "analyze_threads",
+       "Number of threads ANALYZE TABLE ... PERSISTENT starts to collect "
+       "statistics on the columns of a table while the table is scanned. "
+       "If set to 0 the statistics is collected by the scanning thread only.",
+       SESSION_VAR(analyze_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 64), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_analyze_auto_recalc_percentage(
+       "analyze_auto_recalc_percentage",
+       "Percentage of the rows of a table that have to be changed for the "
+       "engine-independent statistics on the table to be collected again "
+       "by a background thread, as ANALYZE TABLE ... PERSISTENT FOR ALL "
+       "would do. Only tables whose statistics is in use are considered. "
+       "If set to 0, the statistics is collected by ANALYZE TABLE only.",
+       GLOBAL_VAR(analyze_auto_recalc_percentage), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 100), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_no_thread_alarm(
        "debug_no_thread_alarm",
        "Disable system thread alarm calls. Disabling it may be useful "
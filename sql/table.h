@@ -575,6 +575,10 @@ struct TABLE_STATISTICS_CB
                                     from statistical tables */
   bool histograms_can_be_read;
   bool histograms_are_read;   
+  /* Rows changed in the table since the share was loaded */
+  volatile int64 rows_changed;
+  /* Statistics on the table is requested to be collected again */
+  volatile int32 recalc_requested;
 };
 
 /**
@@ -1073,6 +1077,7 @@ struct st_cond_statistic;
 typedef Bitmap<MAX_FIELDS> Field_map;
 
 class SplM_opt_info;
+class Group_spill;
 
 struct TABLE
 {
@@ -1359,6 +1364,12 @@ struct TABLE
   SplM_opt_info *spl_opt_info;
   key_map keys_usable_for_splitting;
 
+  /*
+    Set for a GROUP BY temporary table in HEAP that has moved some of
+    its groups to an on-disk table (see end_update())
+  */
+  Group_spill *group_spill;
+
   void init(THD *thd, TABLE_LIST *tl);
   bool fill_item_list(List<Item> *item_list) const;
   void reset_item_list(List<Item> *item_list, uint skip) const;
@@ -61,33 +61,16 @@ static uint32 tc_contention_warning_reported;
 
 /** Data collections. */
 static LF_HASH tdc_hash; /**< Collection of TABLE_SHARE objects. */
-/** Collection of unused TABLE_SHARE objects. */
-static
-I_P_List <TDC_element,
-          I_P_List_adapter<TDC_element, &TDC_element::next, &TDC_element::prev>,
-          I_P_List_null_counter,
-          I_P_List_fast_push_back<TDC_element> > unused_shares;
 
 static tdc_version_t tdc_version;  /* Increments on each reload */
 static bool tdc_inited;
 
-
-/**
-  Protects unused shares list.
-
-  TDC_element::prev
-  TDC_element::next
-  unused_shares
-*/
-
-static mysql_mutex_t LOCK_unused_shares;
-
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_LOCK_unused_shares, key_TABLE_SHARE_LOCK_table_share,
                      key_LOCK_table_cache;
 static PSI_mutex_info all_tc_mutexes[]=
 {
-  { &key_LOCK_unused_shares, "LOCK_unused_shares", PSI_FLAG_GLOBAL },
+  { &key_LOCK_unused_shares, "LOCK_unused_shares", 0 },
   { &key_TABLE_SHARE_LOCK_table_share, "TABLE_SHARE::tdc.LOCK_table_share", 0 },
   { &key_LOCK_table_cache, "LOCK_table_cache", 0 }
 };
@@ -215,6 +198,114 @@ struct Table_cache_instance
 static Table_cache_instance *tc;
 
 
+/**
+  Collection of unused TABLE_SHARE objects.
+
+  Unused shares are split into tc_instances lists, so that threads making
+  different shares used and unused don't serialize on a single mutex. The
+  list of a share is chosen by the address of its TDC_element, which
+  doesn't change while the share is in the cache. Each list is kept in
+  LRU order and tdc_purge() evicts from the lists in turn.
+*/
+
+struct Unused_shares_instance
+{
+  /**
+    Protects list, TDC_element::prev and TDC_element::next of the shares
+    in the list.
+  */
+  mysql_mutex_t LOCK_unused_shares;
+  I_P_List <TDC_element,
+            I_P_List_adapter<TDC_element, &TDC_element::next,
+                             &TDC_element::prev>,
+            I_P_List_null_counter,
+            I_P_List_fast_push_back<TDC_element> > list;
+  /** Number of times LOCK_unused_shares could not be acquired at once */
+  uint32 mutex_waits;
+  /** Number of acquires of the shares of this instance found in the cache */
+  int64 hits;
+  /** Number of acquires of the shares of this instance that loaded them */
+  int64 misses;
+  /** Avoid false sharing between instances */
+  char pad[CPU_LEVEL1_DCACHE_LINESIZE];
+
+  Unused_shares_instance(): mutex_waits(0), hits(0), misses(0)
+  {
+    mysql_mutex_init(key_LOCK_unused_shares, &LOCK_unused_shares,
+                     MY_MUTEX_INIT_FAST);
+  }
+
+  ~Unused_shares_instance()
+  {
+    mysql_mutex_destroy(&LOCK_unused_shares);
+  }
+
+  void lock()
+  {
+    if (mysql_mutex_trylock(&LOCK_unused_shares))
+    {
+      mysql_mutex_lock(&LOCK_unused_shares);
+      mutex_waits++;
+    }
+  }
+
+  void unlock() { mysql_mutex_unlock(&LOCK_unused_shares); }
+};
+
+
+static Unused_shares_instance *unused_shares;
+static uint32 unused_shares_purge_next;
+
+
+static Unused_shares_instance *get_unused_shares(TDC_element *element)
+{
+  return &unused_shares[((size_t) element / sizeof(TDC_element)) %
+                        tc_instances];
+}
+
+
+/**
+  Get number of waits for the unused shares mutexes of all instances.
+*/
+
+ulonglong tdc_unused_shares_waits(void)
+{
+  ulonglong waits= 0;
+  for (ulong i= 0; i < tc_instances; i++)
+    waits+= my_atomic_load32_explicit((int32*) &unused_shares[i].mutex_waits,
+                                      MY_MEMORY_ORDER_RELAXED);
+  return waits;
+}
+
+
+/**
+  Get statistics of the unused shares list of one instance.
+
+  @param      instance  Number of the instance
+  @param[out] hits      Acquires of its shares found in the cache
+  @param[out] misses    Acquires of its shares that loaded them
+  @param[out] waits     Waits for its LOCK_unused_shares
+
+  @retval false  Statistics returned
+  @retval true   No such instance
+*/
+
+bool tdc_get_unused_shares_stats(uint32 instance, ulonglong *hits,
+                                 ulonglong *misses, ulonglong *waits)
+{
+  if (instance >= tc_instances)
+    return true;
+  Unused_shares_instance *shares= &unused_shares[instance];
+  *hits= (ulonglong) my_atomic_load64_explicit(&shares->hits,
+                                               MY_MEMORY_ORDER_RELAXED);
+  *misses= (ulonglong) my_atomic_load64_explicit(&shares->misses,
+                                                 MY_MEMORY_ORDER_RELAXED);
+  *waits= my_atomic_load32_explicit((int32*) &shares->mutex_waits,
+                                    MY_MEMORY_ORDER_RELAXED);
+  return false;
+}
+
+
 static void intern_close_table(TABLE *table)
 {
   delete table->triggers;
@@ -621,9 +712,12 @@ bool tdc_init(void)
   /* Extra instance is allocated to avoid false sharing */
   if (!(tc= new Table_cache_instance[tc_instances + 1]))
     DBUG_RETURN(true);
+  if (!(unused_shares= new Unused_shares_instance[tc_instances + 1]))
+  {
+    delete [] tc;
+    DBUG_RETURN(true);
+  }
   tdc_inited= true;
-  mysql_mutex_init(key_LOCK_unused_shares, &LOCK_unused_shares,
-                   MY_MUTEX_INIT_FAST);
   tdc_version= 1L;  /* Increments on each reload */
   lf_hash_init(&tdc_hash, sizeof(TDC_element) +
                           sizeof(Share_free_tables) * (tc_instances - 1),
@@ -674,7 +768,7 @@ void tdc_deinit(void)
   {
     tdc_inited= false;
     lf_hash_destroy(&tdc_hash);
-    mysql_mutex_destroy(&LOCK_unused_shares);
+    delete [] unused_shares;
     delete [] tc;
   }
   DBUG_VOID_RETURN;
@@ -698,14 +792,23 @@ void tdc_purge(bool all)
   DBUG_ENTER("tdc_purge");
   while (all || tdc_records() > tdc_size)
   {
-    TDC_element *element;
+    TDC_element *element= 0;
+    Unused_shares_instance *instance;
+    uint32 i;
 
-    mysql_mutex_lock(&LOCK_unused_shares);
-    if (!(element= unused_shares.pop_front()))
+    /* Take the least recently used share of the next non-empty list */
+    for (i= 0; i < tc_instances; i++)
     {
-      mysql_mutex_unlock(&LOCK_unused_shares);
-      break;
+      uint32 n= my_atomic_add32_explicit((int32*) &unused_shares_purge_next, 1,
+                                         MY_MEMORY_ORDER_RELAXED);
+      instance= &unused_shares[n % tc_instances];
+      instance->lock();
+      if ((element= instance->list.pop_front()))
+        break;
+      instance->unlock();
     }
+    if (!element)
+      break;
 
     /* Concurrent thread may start using share again, reset prev and next. */
     element->prev= 0;
@@ -714,10 +817,10 @@ void tdc_purge(bool all)
     if (element->ref_count)
     {
       mysql_mutex_unlock(&element->LOCK_table_share);
-      mysql_mutex_unlock(&LOCK_unused_shares);
+      instance->unlock();
       continue;
     }
-    mysql_mutex_unlock(&LOCK_unused_shares);
+    instance->unlock();
 
     tdc_delete_share_from_hash(element);
   }
@@ -737,12 +840,17 @@ void tdc_purge(bool all)
 
   Caller is expected to unlock table share with tdc_unlock_share().
 
+  If instance is not 0, the unused shares list of the share is locked
+  before the share and returned in *instance.
+
   @retval 0 Share not found
   @retval MY_ERRPTR OOM
   @retval ptr Pointer to locked table share
 */
 
-TDC_element *tdc_lock_share(THD *thd, const char *db, const char *table_name)
+static TDC_element *tdc_lock_share(THD *thd, const char *db,
+                                   const char *table_name,
+                                   Unused_shares_instance **instance)
 {
   TDC_element *element;
   char key[MAX_DBKEY_LENGTH];
@@ -756,10 +864,18 @@ TDC_element *tdc_lock_share(THD *thd, const char *db, const char *table_name)
                                           tdc_create_key(key, db, table_name));
   if (element)
   {
+    /*
+      The element can't be freed while it is pinned, so its unused shares
+      list can be locked before the element.
+    */
+    if (instance)
+      (*instance= get_unused_shares(element))->lock();
     mysql_mutex_lock(&element->LOCK_table_share);
     if (unlikely(!element->share || element->share->error))
     {
       mysql_mutex_unlock(&element->LOCK_table_share);
+      if (instance)
+        (*instance)->unlock();
       element= 0;
     }
     lf_hash_search_unpin(thd->tdc_hash_pins);
@@ -769,6 +885,12 @@ TDC_element *tdc_lock_share(THD *thd, const char *db, const char *table_name)
 }
 
 
+TDC_element *tdc_lock_share(THD *thd, const char *db, const char *table_name)
+{
+  return tdc_lock_share(thd, db, table_name, 0);
+}
+
+
 /**
   Unlock share locked by tdc_lock_share().
 */
@@ -781,6 +903,18 @@ void tdc_unlock_share(TDC_element *element)
 }
 
 
+/**
+  Count a share returned by tdc_acquire_share() from the cache.
+*/
+
+static void tdc_count_hit(THD *thd, TDC_element *element)
+{
+  status_var_increment(thd->status_var.table_definition_cache_hits);
+  my_atomic_add64_explicit(&get_unused_shares(element)->hits, 1,
+                           MY_MEMORY_ORDER_RELAXED);
+}
+
+
 /*
   Get TABLE_SHARE for a table.
 
@@ -855,6 +989,9 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
     mysql_mutex_unlock(&element->LOCK_table_share);
 
     tdc_purge(false);
+    status_var_increment(thd->status_var.table_definition_cache_misses);
+    my_atomic_add64_explicit(&get_unused_shares(element)->misses, 1,
+                             MY_MEMORY_ORDER_RELAXED);
     if (out_table)
     {
       status_var_increment(thd->status_var.table_open_cache_misses);
@@ -871,11 +1008,12 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
   {
     if ((*out_table= tc_acquire_table(thd, element)))
     {
-      lf_hash_search_unpin(thd->tdc_hash_pins);
       DBUG_ASSERT(!(flags & GTS_NOLOCK));
       DBUG_ASSERT(element->share);
       DBUG_ASSERT(!element->share->error);
       DBUG_ASSERT(!element->share->is_view);
+      tdc_count_hit(thd, element);
+      lf_hash_search_unpin(thd->tdc_hash_pins);
       status_var_increment(thd->status_var.table_open_cache_hits);
       DBUG_RETURN(element->share);
     }
@@ -915,9 +1053,11 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
   was_unused= !element->ref_count;
   element->ref_count++;
   mysql_mutex_unlock(&element->LOCK_table_share);
+  tdc_count_hit(thd, element);
   if (was_unused)
   {
-    mysql_mutex_lock(&LOCK_unused_shares);
+    Unused_shares_instance *instance= get_unused_shares(element);
+    instance->lock();
     if (element->prev)
     {
       /*
@@ -925,11 +1065,11 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
         Unlink share from this list
       */
       DBUG_PRINT("info", ("Unlinking from not used list"));
-      unused_shares.remove(element);
+      instance->list.remove(element);
       element->next= 0;
       element->prev= 0;
     }
-    mysql_mutex_unlock(&LOCK_unused_shares);
+    instance->unlock();
   }
 
 end:
@@ -961,6 +1101,7 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, TABLE_LIST *tl, uint flags,
 
 void tdc_release_share(TABLE_SHARE *share)
 {
+  Unused_shares_instance *instance;
   DBUG_ENTER("tdc_release_share");
 
   mysql_mutex_lock(&share->tdc->LOCK_table_share);
@@ -980,28 +1121,29 @@ void tdc_release_share(TABLE_SHARE *share)
   }
   mysql_mutex_unlock(&share->tdc->LOCK_table_share);
 
-  mysql_mutex_lock(&LOCK_unused_shares);
+  instance= get_unused_shares(share->tdc);
+  instance->lock();
   mysql_mutex_lock(&share->tdc->LOCK_table_share);
   if (--share->tdc->ref_count)
   {
     if (!share->is_view)
       mysql_cond_broadcast(&share->tdc->COND_release);
     mysql_mutex_unlock(&share->tdc->LOCK_table_share);
-    mysql_mutex_unlock(&LOCK_unused_shares);
+    instance->unlock();
     DBUG_VOID_RETURN;
   }
   if (share->tdc->flushed || tdc_records() > tdc_size)
   {
-    mysql_mutex_unlock(&LOCK_unused_shares);
+    instance->unlock();
     tdc_delete_share_from_hash(share->tdc);
     DBUG_VOID_RETURN;
   }
   /* Link share last in used_table_share list */
   DBUG_PRINT("info", ("moving share to unused list"));
   DBUG_ASSERT(share->tdc->next == 0);
-  unused_shares.push_back(share->tdc);
+  instance->list.push_back(share->tdc);
   mysql_mutex_unlock(&share->tdc->LOCK_table_share);
-  mysql_mutex_unlock(&LOCK_unused_shares);
+  instance->unlock();
   DBUG_VOID_RETURN;
 }
 
@@ -1093,6 +1235,7 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
   Share_free_tables::List purge_tables;
   TABLE *table;
   TDC_element *element;
+  Unused_shares_instance *instance;
   uint my_refs= 1;
   DBUG_ENTER("tdc_remove_table");
   DBUG_PRINT("enter",("name: %s  remove_type: %d", table_name, remove_type));
@@ -1102,10 +1245,8 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
                                              MDL_EXCLUSIVE));
 
 
-  mysql_mutex_lock(&LOCK_unused_shares);
-  if (!(element= tdc_lock_share(thd, db, table_name)))
+  if (!(element= tdc_lock_share(thd, db, table_name, &instance)))
   {
-    mysql_mutex_unlock(&LOCK_unused_shares);
     DBUG_ASSERT(remove_type != TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE);
     DBUG_RETURN(false);
   }
@@ -1116,16 +1257,16 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
   {
     if (element->prev)
     {
-      unused_shares.remove(element);
+      instance->list.remove(element);
       element->prev= 0;
       element->next= 0;
     }
-    mysql_mutex_unlock(&LOCK_unused_shares);
+    instance->unlock();
 
     tdc_delete_share_from_hash(element);
     DBUG_RETURN(true);
   }
-  mysql_mutex_unlock(&LOCK_unused_shares);
+  instance->unlock();
 
   element->ref_count++;
 
@@ -78,6 +78,9 @@ extern void tdc_start_shutdown(void);
 extern void tdc_deinit(void);
 extern ulong tdc_records(void);
 extern void tdc_purge(bool all);
+extern ulonglong tdc_unused_shares_waits(void);
+extern bool tdc_get_unused_shares_stats(uint32 instance, ulonglong *hits,
+                                        ulonglong *misses, ulonglong *waits);
 extern TDC_element *tdc_lock_share(THD *thd, const char *db,
                                    const char *table_name);
 extern void tdc_unlock_share(TDC_element *element);
@@ -0,0 +1,95 @@
+/* Copyright (C) 2019, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02111-1301 USA */
+
+#define MYSQL_SERVER
+#include <my_global.h>
+#include <sql_class.h>
+#include <table.h>
+#include <sql_show.h>
+#include <table_cache.h>
+
+/*
+  INFORMATION_SCHEMA.TABLE_DEFINITION_CACHE_INSTANCES
+
+  One row per list of unused table shares of the table definition cache
+  (there are table_open_cache_instances of them). HITS and MISSES count
+  the acquires of the shares of the list that found the share in the
+  cache and that had to load it; WAITS counts how many times the mutex
+  of the list was found busy.
+*/
+
+static ST_FIELD_INFO tdc_instances_fields_info[] =
+{
+  { "INSTANCE_ID", 6, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, 0, 0 },
+  { "HITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+    MY_I_S_UNSIGNED, 0, 0 },
+  { "MISSES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+    MY_I_S_UNSIGNED, 0, 0 },
+  { "WAITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+    MY_I_S_UNSIGNED, 0, 0 },
+  { 0, 0, MYSQL_TYPE_NULL, 0, 0, 0, 0 }
+};
+
+
+static int tdc_instances_fill(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  Field **field= table->field;
+  ulonglong hits, misses, waits;
+
+  for (uint32 i= 0; !tdc_get_unused_shares_stats(i, &hits, &misses, &waits);
+       i++)
+  {
+    field[0]->store(i, true);
+    field[1]->store(hits, true);
+    field[2]->store(misses, true);
+    field[3]->store(waits, true);
+    if (schema_table_store_record(thd, table))
+      return 1;
+  }
+  return 0;
+}
+
+
+static int tdc_instances_init(void *p)
+{
+  ST_SCHEMA_TABLE *is= (ST_SCHEMA_TABLE *) p;
+  is->fields_info= tdc_instances_fields_info;
+  is->fill_table= tdc_instances_fill;
+  return 0;
+}
+
+
+static struct st_mysql_information_schema table_cache_info_descriptor=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+
+maria_declare_plugin(table_cache_info)
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &table_cache_info_descriptor,
+  "TABLE_DEFINITION_CACHE_INSTANCES",
+  "MariaDB Corporation",
+  "Statistics of the unused share lists of the table definition cache",
+  PLUGIN_LICENSE_GPL,
+  tdc_instances_init,
+  NULL,
+  0x0100,
+  NULL,
+  NULL,
+  "1.0",
+  MariaDB_PLUGIN_MATURITY_GAMMA
+}
+maria_declare_plugin_end;
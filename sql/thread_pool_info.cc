@@ -0,0 +1,102 @@
+/* Copyright (C) 2019, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02111-1301 USA */
+
+#define MYSQL_SERVER
+#include <my_global.h>
+#include <sql_class.h>
+#include <table.h>
+#include <sql_show.h>
+#include <threadpool.h>
+
+/*
+  INFORMATION_SCHEMA.THREAD_POOL_QUEUE_LATENCY
+
+  One row per thread group and histogram bucket, telling how many requests
+  waited in the group's queue for less than LATENCY_LIMIT_US microseconds
+  (and at least as long as the previous bucket's limit) before a worker
+  thread picked them up. The last bucket of every group has a NULL limit.
+
+  The table is empty unless thread_handling=pool-of-threads.
+*/
+
+static ST_FIELD_INFO queue_latency_fields_info[] =
+{
+  { "GROUP_ID", 6, MYSQL_TYPE_LONG, 0, MY_I_S_UNSIGNED, 0, 0 },
+  { "LATENCY_LIMIT_US", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+    MY_I_S_UNSIGNED | MY_I_S_MAYBE_NULL, 0, 0 },
+  { "COUNT", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+    MY_I_S_UNSIGNED, 0, 0 },
+  { 0, 0, MYSQL_TYPE_NULL, 0, 0, 0, 0 }
+};
+
+
+static int queue_latency_fill(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  Field **field= table->field;
+  ulonglong buckets[TP_QUEUE_LATENCY_BUCKETS];
+
+  for (uint group= 0; !tp_get_queue_latency(group, buckets); group++)
+  {
+    ulonglong limit= 10;
+    for (uint i= 0; i < TP_QUEUE_LATENCY_BUCKETS; i++, limit*= 10)
+    {
+      field[0]->store(group, true);
+      if (i < TP_QUEUE_LATENCY_BUCKETS - 1)
+      {
+        field[1]->store(limit, true);
+        field[1]->set_notnull();
+      }
+      else
+        field[1]->set_null();
+      field[2]->store(buckets[i], true);
+      if (schema_table_store_record(thd, table))
+        return 1;
+    }
+  }
+  return 0;
+}
+
+
+static int queue_latency_init(void *p)
+{
+  ST_SCHEMA_TABLE *is= (ST_SCHEMA_TABLE *) p;
+  is->fields_info= queue_latency_fields_info;
+  is->fill_table= queue_latency_fill;
+  return 0;
+}
+
+
+static struct st_mysql_information_schema thread_pool_info_descriptor=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+
+maria_declare_plugin(thread_pool_info)
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &thread_pool_info_descriptor,
+  "THREAD_POOL_QUEUE_LATENCY",
+  "MariaDB Corporation",
+  "Queue wait time histogram of the thread pool groups",
+  PLUGIN_LICENSE_GPL,
+  queue_latency_init,
+  NULL,
+  0x0100,
+  NULL,
+  NULL,
+  "1.0",
+  MariaDB_PLUGIN_MATURITY_GAMMA
+}
+maria_declare_plugin_end;
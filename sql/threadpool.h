@@ -24,6 +24,7 @@ extern uint threadpool_stall_limit;  /* time interval in 10 ms units for stall c
 extern uint threadpool_max_threads;  /* Maximum threads in pool */
 extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
 extern uint threadpool_prio_kickup_timer;  /* Time before low prio item gets prio boost */
+extern char *threadpool_resource_groups;  /* Resource group definitions */
 #ifdef _WIN32
 extern uint threadpool_mode; /* Thread pool implementation , windows or generic */
 #define TP_MODE_WINDOWS 0
@@ -44,6 +45,8 @@ struct TP_STATISTICS
 {
   /* Current number of worker thread. */
   volatile int32 num_worker_threads;
+  /* Connections dequeued by a worker of another, idle, thread group. */
+  volatile int64 num_stolen_connections;
 };
 
 extern TP_STATISTICS tp_stats;
@@ -57,6 +60,70 @@ extern void tp_set_threadpool_stall_limit(uint val);
 extern int tp_get_idle_thread_count();
 extern int tp_get_thread_count();
 
+/*
+  Queue wait time histogram. Bucket i counts the connections that waited
+  less than 10^(i+1) microseconds in a thread group's queue before a worker
+  picked them up, the last bucket counts everything longer.
+*/
+#define TP_QUEUE_LATENCY_BUCKETS 7
+extern bool tp_get_queue_latency(uint group, ulonglong *buckets);
+
+/*
+  Resource groups.
+
+  Connections are classified into resource groups by user and current
+  schema, see tp_parse_resource_groups() for the syntax. Group 0 is the
+  default group for connections that match no other. Within each priority,
+  queued requests of the different groups are dequeued in proportion to the
+  groups' weights, and no more than max_active requests of a group execute
+  at the same time.
+*/
+#define TP_MAX_RESOURCE_GROUPS 16
+
+struct TP_resource_group
+{
+  char name[NAME_LEN + 1];
+  char user[USERNAME_LENGTH + 1];  /* empty matches any user */
+  char db[NAME_LEN + 1];           /* empty matches any schema */
+  uint weight;
+  uint max_active;                 /* 0 for no limit */
+};
+
+struct TP_resource_groups
+{
+  uint count;
+  TP_resource_group group[TP_MAX_RESOURCE_GROUPS];
+};
+
+/*
+  The effective resource group definitions. They are never modified in
+  place: tp_set_resource_groups() publishes a new set by swapping the
+  pointer, so a reader that loads it once sees a consistent set.
+*/
+extern TP_resource_groups * volatile tp_resource_groups;
+/* Number of requests of each resource group currently executing */
+extern volatile int32 tp_resource_group_active[TP_MAX_RESOURCE_GROUPS];
+
+extern bool tp_parse_resource_groups(const char *str,
+                                     TP_resource_group *groups, uint *count);
+extern void tp_set_resource_groups();
+extern void tp_resource_group_admit(TP_connection *c);
+
+static inline TP_resource_groups *tp_get_resource_groups()
+{
+  return (TP_resource_groups *)
+    my_atomic_loadptr_explicit((void * volatile *) &tp_resource_groups,
+                               MY_MEMORY_ORDER_ACQUIRE);
+}
+
+static inline bool tp_resource_group_admits(const TP_resource_groups *groups,
+                                            uint group)
+{
+  uint max_active= groups->group[group].max_active;
+  return !max_active ||
+    (uint) my_atomic_load32(&tp_resource_group_active[group]) < max_active;
+}
+
 /* Activate threadpool scheduler */
 extern void tp_scheduler(void);
 
@@ -90,12 +157,27 @@ struct TP_connection
   CONNECT*    connect;
   TP_STATE    state;
   TP_PRIORITY priority;
+  /* Resource group of the next request */
+  uint        resource_group;
+  /* max_active of resource_group when the connection was classified */
+  uint        resource_group_max_active;
+  /* True while the request counts in tp_resource_group_active */
+  bool        resource_group_admitted;
+  /* Version of the resource groups and schema resource_group was found for */
+  int32       resource_group_version;
+  char        resource_group_db[NAME_LEN + 1];
   TP_connection(CONNECT *c) :
     thd(0),
     connect(c),
     state(TP_STATE_IDLE),
-    priority(TP_PRIORITY_HIGH)
-  {}
+    priority(TP_PRIORITY_HIGH),
+    resource_group(0),
+    resource_group_max_active(0),
+    resource_group_admitted(false),
+    resource_group_version(0)
+  {
+    resource_group_db[0]= 0;
+  }
 
   virtual ~TP_connection()
   {};
@@ -128,6 +210,9 @@ struct TP_pool
   virtual int set_stall_limit(uint){ return 0; }
   virtual int get_thread_count() { return tp_stats.num_worker_threads; }
   virtual int get_idle_thread_count(){ return 0; }
+  virtual bool get_queue_latency(uint, ulonglong *){ return true; }
+  virtual void resource_groups_changed() {}
+  virtual void resume_resource_group(uint) {}
 };
 
 #ifdef _WIN32
@@ -153,4 +238,7 @@ struct TP_pool_generic :TP_pool
   virtual int set_pool_size(uint);
   virtual int set_stall_limit(uint);
   virtual int get_idle_thread_count();
+  virtual bool get_queue_latency(uint group, ulonglong *buckets);
+  virtual void resource_groups_changed();
+  virtual void resume_resource_group(uint group);
 };
@@ -36,10 +36,24 @@ uint threadpool_max_threads;
 uint threadpool_oversubscribe;
 uint threadpool_mode;
 uint threadpool_prio_kickup_timer;
+char *threadpool_resource_groups;
 
 /* Stats */
 TP_STATISTICS tp_stats;
 
+/*
+  Resource groups. tp_set_resource_groups() fills the buffer that is not
+  in use and swaps tp_resource_groups to it, under
+  LOCK_global_system_variables.
+*/
+static TP_resource_groups tp_resource_group_buffers[2];
+TP_resource_groups * volatile tp_resource_groups= &tp_resource_group_buffers[0];
+volatile int32 tp_resource_group_active[TP_MAX_RESOURCE_GROUPS];
+/* Incremented on every change of the resource groups */
+static volatile int32 tp_resource_group_version;
+
+static TP_pool *pool;
+
 
 static void  threadpool_remove_connection(THD *thd);
 static int   threadpool_process_request(THD *thd);
@@ -160,6 +174,248 @@ static TP_PRIORITY get_priority(TP_connection *c)
 }
 
 
+/*
+  Determine the resource group of the connection's next request, from its
+  user and current schema.
+
+  The result is cached in the connection, so LOCK_global_system_variables
+  is only taken when the schema or the resource group definitions changed.
+*/
+static uint get_resource_group(TP_connection *c)
+{
+  THD *thd= c->thd;
+  int32 version= my_atomic_load32(&tp_resource_group_version);
+  const char *db= thd->db.str ? thd->db.str : "";
+  uint group= 0;
+  TP_resource_groups *groups;
+
+  DBUG_ASSERT(thd == current_thd);
+  if (version == c->resource_group_version &&
+      !strcmp(db, c->resource_group_db))
+    return c->resource_group;
+
+  c->resource_group_version= version;
+  strmake_buf(c->resource_group_db, db);
+
+  mysql_mutex_lock(&LOCK_global_system_variables);
+  groups= tp_resource_groups;
+  for (uint i= 1; i < groups->count; i++)
+  {
+    TP_resource_group *g= &groups->group[i];
+    if (g->user[0] &&
+        (!thd->security_ctx->user || strcmp(g->user, thd->security_ctx->user)))
+      continue;
+    if (g->db[0] && strcmp(g->db, db))
+      continue;
+    group= i;
+    break;
+  }
+  c->resource_group_max_active= groups->group[group].max_active;
+  mysql_mutex_unlock(&LOCK_global_system_variables);
+  return group;
+}
+
+
+/*
+  The pool picked a request of the connection for execution,
+  count it against its resource group's max_active.
+*/
+void tp_resource_group_admit(TP_connection *c)
+{
+  DBUG_ASSERT(!c->resource_group_admitted);
+  my_atomic_add32(&tp_resource_group_active[c->resource_group], 1);
+  c->resource_group_admitted= true;
+}
+
+
+/*
+  The request finished. If its resource group was at max_active, requests
+  of the group may be queued with no worker looking at them, let the pool
+  wake one.
+*/
+static void tp_resource_group_release(TP_connection *c)
+{
+  if (c->resource_group_admitted)
+  {
+    uint active= (uint)
+      my_atomic_add32(&tp_resource_group_active[c->resource_group], -1);
+    c->resource_group_admitted= false;
+    if (c->resource_group_max_active &&
+        active >= c->resource_group_max_active)
+      pool->resume_resource_group(c->resource_group);
+  }
+}
+
+
+static const char *rg_token(const char *p, const char *delims,
+                            LEX_CSTRING *token)
+{
+  while (my_isspace(system_charset_info, *p))
+    p++;
+  token->str= p;
+  while (*p && !strchr(delims, *p))
+    p++;
+  token->length= p - token->str;
+  while (token->length &&
+         my_isspace(system_charset_info, token->str[token->length - 1]))
+    token->length--;
+  return p;
+}
+
+
+static bool rg_name_is(const LEX_CSTRING *token, const char *name)
+{
+  return !my_strnncoll(system_charset_info,
+                       (const uchar *) token->str, token->length,
+                       (const uchar *) name, strlen(name));
+}
+
+
+static bool rg_set_option(TP_resource_group *g, bool is_default,
+                          const LEX_CSTRING *key, const LEX_CSTRING *value)
+{
+  if (rg_name_is(key, "user") || rg_name_is(key, "schema"))
+  {
+    bool is_user= rg_name_is(key, "user");
+    size_t max_length= is_user ? USERNAME_LENGTH : NAME_LEN;
+    if (is_default || !value->length || value->length > max_length)
+      return true;
+    strmake(is_user ? g->user : g->db, value->str, value->length);
+    return false;
+  }
+
+  char *end= (char *) value->str + value->length;
+  int error;
+  longlong num= my_strtoll10(value->str, &end, &error);
+  if (error || end != value->str + value->length)
+    return true;
+  if (rg_name_is(key, "weight") && num >= 1 && num <= 1000)
+    g->weight= (uint) num;
+  else if (rg_name_is(key, "max_active") && num >= 0 && num <= 100000)
+    g->max_active= (uint) num;
+  else
+    return true;
+  return false;
+}
+
+
+/*
+  Parse a thread_pool_resource_groups value.
+
+  The value is a ';' separated list of group definitions, each of the form
+
+    name[:option=value[,option=value...]]
+
+  Options are
+    user        connections of this user belong to the group
+    schema      connections whose current schema is this belong to the group
+    weight      1..1000, share of the pool the group gets when other groups
+                compete for it (default 1)
+    max_active  how many requests of the group may execute at the same
+                time, 0 for no limit (default)
+
+  A connection belongs to the first group whose user and schema both match,
+  if given, or to the group named "default" otherwise. The default group
+  has no user and schema, only weight and max_active can be set for it.
+
+  For example 'oltp:schema=shop,weight=8;report:user=bi,max_active=2'.
+
+  @return true on syntax error
+*/
+bool tp_parse_resource_groups(const char *str, TP_resource_group *groups,
+                              uint *count)
+{
+  const char *p= str ? str : "";
+
+  bzero(groups, sizeof(*groups) * TP_MAX_RESOURCE_GROUPS);
+  strmov(groups[0].name, "default");
+  groups[0].weight= 1;
+  *count= 1;
+
+  for (;;)
+  {
+    LEX_CSTRING name;
+    TP_resource_group *g;
+
+    p= rg_token(p, ":;", &name);
+    if (!name.length)
+    {
+      if (!*p)
+        break;
+      if (*p != ';')
+        return true;
+      p++;
+      continue;
+    }
+
+    if (rg_name_is(&name, "default"))
+      g= &groups[0];
+    else
+    {
+      if (*count == TP_MAX_RESOURCE_GROUPS || name.length > NAME_LEN)
+        return true;
+      for (uint i= 1; i < *count; i++)
+        if (rg_name_is(&name, groups[i].name))
+          return true;
+      g= &groups[(*count)++];
+      strmake(g->name, name.str, name.length);
+      g->weight= 1;
+    }
+
+    if (*p == ':')
+    {
+      do
+      {
+        LEX_CSTRING key, value;
+        p= rg_token(p + 1, "=,;", &key);
+        if (*p != '=')
+          return true;
+        p= rg_token(p + 1, ",;", &value);
+        if (rg_set_option(g, g == groups, &key, &value))
+          return true;
+      } while (*p == ',');
+    }
+
+    if (*p == ';')
+      p++;
+    else if (*p)
+      return true;
+  }
+  return false;
+}
+
+
+/*
+  Make the thread_pool_resource_groups value effective.
+  LOCK_global_system_variables must be held.
+
+  The pool reads the definitions without LOCK_global_system_variables, so
+  they are parsed into the spare buffer and published by swapping the
+  pointer. The pool returns from resource_groups_changed() only when no
+  thread reads the old buffer any more, which makes it the spare one.
+*/
+void tp_set_resource_groups()
+{
+  mysql_mutex_assert_owner(&LOCK_global_system_variables);
+  TP_resource_groups *groups= tp_resource_groups;
+  groups= groups == &tp_resource_group_buffers[0] ?
+    &tp_resource_group_buffers[1] : &tp_resource_group_buffers[0];
+
+  if (tp_parse_resource_groups(threadpool_resource_groups,
+                               groups->group, &groups->count))
+  {
+    sql_print_error("Invalid value of thread_pool_resource_groups: '%s'",
+                    threadpool_resource_groups);
+    tp_parse_resource_groups("", groups->group, &groups->count);
+  }
+  my_atomic_storeptr_explicit((void * volatile *) &tp_resource_groups,
+                              groups, MY_MEMORY_ORDER_RELEASE);
+  my_atomic_add32(&tp_resource_group_version, 1);
+  if (pool)
+    pool->resource_groups_changed();
+}
+
+
 void tp_callback(TP_connection *c)
 {
   DBUG_ASSERT(c);
@@ -189,8 +445,11 @@ void tp_callback(TP_connection *c)
     goto error;
   }
 
+  tp_resource_group_release(c);
+
   /* Set priority */
   c->priority= get_priority(c);
+  c->resource_group= get_resource_group(c);
 
   /* Read next command from client. */
   c->set_io_timeout(thd->get_net_wait_timeout());
@@ -202,6 +461,7 @@ void tp_callback(TP_connection *c)
   return;
 
 error:
+  tp_resource_group_release(c);
   c->thd= 0;
   delete c;
 
@@ -393,10 +653,11 @@ static bool tp_end_thread(THD *, bool)
   return 0;
 }
 
-static TP_pool *pool;
-
 static bool tp_init()
 {
+  mysql_mutex_lock(&LOCK_global_system_variables);
+  tp_set_resource_groups();
+  mysql_mutex_unlock(&LOCK_global_system_variables);
 
 #ifdef _WIN32
   if (threadpool_mode == TP_MODE_WINDOWS)
@@ -437,6 +698,15 @@ int tp_get_thread_count()
   return pool ? pool->get_thread_count() : 0;
 }
 
+/*
+  Copy the queue wait histogram of a thread group into buckets.
+  Returns true if there is no such group.
+*/
+bool tp_get_queue_latency(uint group, ulonglong *buckets)
+{
+  return pool ? pool->get_queue_latency(group, buckets) : true;
+}
+
 void tp_set_min_threads(uint val)
 {
   if (pool)
@@ -156,6 +156,8 @@ struct TP_connection_generic:public TP_connection
   TP_connection_generic **prev_in_queue;
   ulonglong abs_wait_timeout;
   ulonglong dequeue_time;
+  /* When the connection was queued, in microseconds, for queue_latency */
+  ulonglong enqueue_time;
   TP_file_handle fd;
   bool bound_to_poll_descriptor;
   int waiting;
@@ -178,10 +180,23 @@ connection_queue_t;
 
 const int NQUEUES=2; /* We have high and low priority queues*/
 
+/*
+  Stride of weighted fair queuing between resource groups: dequeuing a
+  request of a group advances the group's pass by TP_RG_STRIDE / weight,
+  and the group with the lowest pass is served first.
+*/
+#define TP_RG_STRIDE 1000000ULL
+
 struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) thread_group_t
 {
   mysql_mutex_t mutex;
-  connection_queue_t queues[NQUEUES];
+  /* One queue per priority and resource group */
+  connection_queue_t queues[NQUEUES][TP_MAX_RESOURCE_GROUPS];
+  /* Bitmaps of the non-empty resource group queues of each priority */
+  uint queue_mask[NQUEUES];
+  /* Weighted fair queuing state, see TP_RG_STRIDE */
+  ulonglong rg_pass[TP_MAX_RESOURCE_GROUPS];
+  ulonglong rg_vtime;
   worker_list_t waiting_threads; 
   worker_thread_t *listener;
   pthread_attr_t *pthread_attr;
@@ -196,6 +211,8 @@ struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) thread_group_t
   int  shutdown_pipe[2];
   bool shutdown;
   bool stalled; 
+  /* Queue wait time histogram, see TP_QUEUE_LATENCY_BUCKETS */
+  ulonglong queue_latency[TP_QUEUE_LATENCY_BUCKETS];
 };
 
 static thread_group_t *all_groups;
@@ -526,18 +543,58 @@ static void* native_event_get_userdata(native_event *event)
 #endif
 
 
-/* Dequeue element from a workqueue */
+/* Account the time a connection spent in the queue */
+
+static void record_queue_latency(thread_group_t *thread_group,
+                                 TP_connection_generic *c)
+{
+  ulonglong wait= microsecond_interval_timer() - c->enqueue_time;
+  ulonglong limit= 10;
+  int i;
+  for (i= 0; i < TP_QUEUE_LATENCY_BUCKETS - 1 && wait >= limit; i++)
+    limit*= 10;
+  thread_group->queue_latency[i]++;
+}
+
+
+/*
+  Dequeue element from a workqueue.
+
+  High priority requests go first. Among the requests of one priority, the
+  resource group with the lowest pass whose max_active limit is not reached
+  is served, so that each group gets a share of the workers proportional to
+  its weight.
+*/
 
 static TP_connection_generic *queue_get(thread_group_t *thread_group)
 {
   DBUG_ENTER("queue_get");
   thread_group->queue_event_count++;
   TP_connection_generic *c;
+  TP_resource_groups *groups= tp_get_resource_groups();
   for (int i=0; i < NQUEUES;i++)
   {
-    c= thread_group->queues[i].pop_front();
-    if (c)
-      DBUG_RETURN(c);
+    int best= -1;
+    uint mask= thread_group->queue_mask[i];
+    for (uint rg= 0; mask; rg++, mask>>= 1)
+    {
+      if (!(mask & 1) || !tp_resource_group_admits(groups, rg))
+        continue;
+      if (best < 0 || thread_group->rg_pass[rg] < thread_group->rg_pass[best])
+        best= rg;
+    }
+    if (best < 0)
+      continue;
+
+    c= thread_group->queues[i][best].pop_front();
+    if (thread_group->queues[i][best].is_empty())
+      thread_group->queue_mask[i]&= ~(1U << best);
+    thread_group->rg_vtime= thread_group->rg_pass[best];
+    thread_group->rg_pass[best]+=
+      TP_RG_STRIDE / MY_MAX(groups->group[best].weight, 1);
+    record_queue_latency(thread_group, c);
+    tp_resource_group_admit(c);
+    DBUG_RETURN(c);
   }
   DBUG_RETURN(0);  
 }
@@ -546,29 +603,68 @@ static bool is_queue_empty(thread_group_t *thread_group)
 {
   for (int i=0; i < NQUEUES; i++)
   {
-    if (!thread_group->queues[i].is_empty())
+    if (thread_group->queue_mask[i])
       return false;
   }
   return true;
 }
 
 
+/*
+  Check if queue_get() would return something, i.e. the queue has requests
+  of a resource group that is not at its max_active limit.
+*/
+static bool is_queue_runnable(thread_group_t *thread_group)
+{
+  TP_resource_groups *groups= tp_get_resource_groups();
+  for (int i=0; i < NQUEUES; i++)
+  {
+    uint mask= thread_group->queue_mask[i];
+    for (uint rg= 0; mask; rg++, mask>>= 1)
+    {
+      if ((mask & 1) && tp_resource_group_admits(groups, rg))
+        return true;
+    }
+  }
+  return false;
+}
+
+
 static void queue_init(thread_group_t *thread_group)
 {
   for (int i=0; i < NQUEUES; i++)
   {
-    thread_group->queues[i].empty();
+    for (int rg= 0; rg < TP_MAX_RESOURCE_GROUPS; rg++)
+      thread_group->queues[i][rg].empty();
+    thread_group->queue_mask[i]= 0;
   }
 }
 
+
+/* Append connection to the queue of its resource group */
+static void queue_push(thread_group_t *thread_group,
+                       TP_connection_generic *c, int prio)
+{
+  uint rg= c->resource_group;
+  if (thread_group->queues[prio][rg].is_empty())
+  {
+    thread_group->queue_mask[prio]|= 1U << rg;
+    /* A group that was idle does not get to catch up on its share. */
+    set_if_bigger(thread_group->rg_pass[rg], thread_group->rg_vtime);
+  }
+  thread_group->queues[prio][rg].push_back(c);
+}
+
 static void queue_put(thread_group_t *thread_group, native_event *ev, int cnt)
 {
   ulonglong now= pool_timer.current_microtime;
+  ulonglong enqueue_time= microsecond_interval_timer();
   for(int i=0; i < cnt; i++)
   {
     TP_connection_generic *c = (TP_connection_generic *)native_event_get_userdata(&ev[i]);
     c->dequeue_time= now;
-    thread_group->queues[c->priority].push_back(c);
+    c->enqueue_time= enqueue_time;
+    queue_push(thread_group, c, c->priority);
   }
 }
 
@@ -650,7 +746,7 @@ static void* timer_thread(void *param)
     struct timespec ts;
     int err;
 
-    set_timespec_nsec(ts,timer->tick_interval*1000000);
+    set_timespec_nsec(ts, (ulonglong) timer->tick_interval * 1000000);
     mysql_mutex_lock(&timer->mutex);
     err= mysql_cond_timedwait(&timer->cond, &timer->mutex, &ts);
     if (timer->shutdown)
@@ -692,16 +788,22 @@ void check_stall(thread_group_t *thread_group)
    time in low prio queue.
   */
   TP_connection_generic *c;
-  for (;;)
+  for (uint rg= 0; rg < TP_MAX_RESOURCE_GROUPS; rg++)
   {
-    c= thread_group->queues[TP_PRIORITY_LOW].front();
-    if (c && pool_timer.current_microtime - c->dequeue_time > 1000ULL * threadpool_prio_kickup_timer)
+    connection_queue_t *low= &thread_group->queues[TP_PRIORITY_LOW][rg];
+    for (;;)
     {
-      thread_group->queues[TP_PRIORITY_LOW].remove(c);
-      thread_group->queues[TP_PRIORITY_HIGH].push_back(c);
+      c= low->front();
+      if (c && pool_timer.current_microtime - c->dequeue_time > 1000ULL * threadpool_prio_kickup_timer)
+      {
+        low->remove(c);
+        queue_push(thread_group, c, TP_PRIORITY_HIGH);
+      }
+      else
+        break;
     }
-    else
-      break;
+    if (low->is_empty())
+      thread_group->queue_mask[TP_PRIORITY_LOW]&= ~(1U << rg);
   }
 
   /*
@@ -746,7 +848,7 @@ void check_stall(thread_group_t *thread_group)
     do wait and indicate that via thd_wait_begin/end callbacks, thread creation
     will be faster.
   */
-  if (!is_queue_empty(thread_group) && !thread_group->queue_event_count)
+  if (is_queue_runnable(thread_group) && !thread_group->queue_event_count)
   {
     thread_group->stalled= true;
     wake_or_create_thread(thread_group);
@@ -865,12 +967,18 @@ static TP_connection_generic * listener(worker_thread_t *current_thread,
      more workers.
     */
     
-    bool listener_picks_event=is_queue_empty(thread_group);
+    /*
+      Requests of resource groups at their max_active limit do not count,
+      no worker will take them either.
+    */
+    bool listener_picks_event= !is_queue_runnable(thread_group);
     queue_put(thread_group, ev, cnt);
-    if (listener_picks_event)
+    /*
+      Handle the first event, unless its resource group is at its
+      max_active limit.
+    */
+    if (listener_picks_event && (retval= queue_get(thread_group)))
     {
-      /* Handle the first event. */
-      retval= queue_get(thread_group);
       mysql_mutex_unlock(&thread_group->mutex);
       break;
     }
@@ -1177,7 +1285,8 @@ static void queue_put(thread_group_t *thread_group, TP_connection_generic *conne
   DBUG_ENTER("queue_put");
 
   connection->dequeue_time= pool_timer.current_microtime;
-  thread_group->queues[connection->priority].push_back(connection);
+  connection->enqueue_time= microsecond_interval_timer();
+  queue_push(thread_group, connection, connection->priority);
 
   if (thread_group->active_thread_count == 0)
     wake_or_create_thread(thread_group);
@@ -1198,6 +1307,70 @@ static bool too_many_threads(thread_group_t *thread_group)
 }
 
 
+#ifndef HAVE_IOCP
+/**
+  Take a queued connection from another, overloaded thread group.
+
+  Connections are assigned to groups by thread id, so a burst of requests
+  from clients that happen to share a group queues up there, while the
+  workers of other groups may have nothing to do. Before a worker goes to
+  sleep, it looks for a group that has queued work and no idle worker of its
+  own, and handles one of its connections instead. This avoids waiting for
+  the timer to detect the stall and create a new thread in the busy group.
+
+  The connection is moved into the current group for the time of the
+  request, so that wait_begin()/wait_end() account for the thread actually
+  executing it. Its next start_io() moves it back to its home group.
+
+  thread_group->mutex must be held. Other groups' mutexes are only tried,
+  never waited for, so two groups stealing from each other can't deadlock.
+
+  @return stolen connection, or NULL if there was nothing to steal
+*/
+
+static TP_connection_generic *queue_steal(thread_group_t *thread_group)
+{
+  uint self= (uint) (thread_group - all_groups);
+  uint count= group_count;
+  DBUG_ENTER("queue_steal");
+
+  if (self >= count)
+    DBUG_RETURN(NULL);
+
+  for (uint i= 1; i < count; i++)
+  {
+    thread_group_t *victim= &all_groups[(self + i) % count];
+    TP_connection_generic *c;
+
+    /* Unlocked pre-check, it is fine to miss work here. */
+    if (is_queue_empty(victim) || !victim->waiting_threads.is_empty())
+      continue;
+    if (mysql_mutex_trylock(&victim->mutex))
+      continue;
+    if (victim->shutdown || !victim->waiting_threads.is_empty() ||
+        !(c= queue_get(victim)))
+    {
+      mysql_mutex_unlock(&victim->mutex);
+      continue;
+    }
+    if (c->bound_to_poll_descriptor)
+    {
+      io_poll_disassociate_fd(victim->pollfd, c->fd);
+      c->bound_to_poll_descriptor= false;
+    }
+    victim->connection_count--;
+    mysql_mutex_unlock(&victim->mutex);
+
+    c->thread_group= thread_group;
+    thread_group->connection_count++;
+    my_atomic_add64(&tp_stats.num_stolen_connections, 1);
+    DBUG_RETURN(c);
+  }
+  DBUG_RETURN(NULL);
+}
+#endif
+
+
 /**
   Retrieve a connection with pending event.
   
@@ -1271,12 +1444,18 @@ TP_connection_generic *get_event(worker_thread_t *current_thread,
       if (cnt > 0)
       {
         queue_put(thread_group, ev, cnt);
-        connection= queue_get(thread_group);
-        break;
+        if ((connection= queue_get(thread_group)))
+          break;
       }
     }
 
 
+#ifndef HAVE_IOCP
+    /* Help out a group that has more work than threads. */
+    if (!oversubscribed && (connection= queue_steal(thread_group)))
+      break;
+#endif
+
     /* And now, finally sleep */ 
     current_thread->woken = false; /* wake() sets this to true */
 
@@ -1441,6 +1620,7 @@ TP_connection_generic::TP_connection_generic(CONNECT *c):
   next_in_queue(0),
   prev_in_queue(0),
   abs_wait_timeout(ULONGLONG_MAX),
+  enqueue_time(0),
   bound_to_poll_descriptor(false),
   waiting(false)
 #ifdef HAVE_IOCP
@@ -1736,6 +1916,73 @@ int TP_pool_generic::get_idle_thread_count()
 }
 
 
+/**
+  New resource group definitions were published.
+
+  The thread groups read the definitions only with their mutex held, so
+  once every mutex was taken, none of them uses the old ones. Requests that
+  waited for a max_active that was raised or removed get a worker.
+*/
+
+void TP_pool_generic::resource_groups_changed()
+{
+  for (uint i= 0; i < threadpool_max_size; i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    mysql_mutex_lock(&group->mutex);
+    if (!group->active_thread_count && is_queue_runnable(group))
+      wake_or_create_thread(group);
+    mysql_mutex_unlock(&group->mutex);
+  }
+}
+
+
+/**
+  A request of resource group rg finished while the group was at its
+  max_active limit.
+
+  Queued requests of the group can run now, but the workers of a thread
+  group that had nothing else to do are all waiting. Wake one, as
+  queue_put() does. A thread group with active workers gets to the request
+  when one of them looks at the queue again.
+*/
+
+void TP_pool_generic::resume_resource_group(uint rg)
+{
+  for (uint i= 0; i < threadpool_max_size; i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    uint mask= 0;
+    /* Dirty read, requests queued later are checked by queue_put() */
+    for (int prio= 0; prio < NQUEUES; prio++)
+      mask|= group->queue_mask[prio];
+    if (!(mask & (1U << rg)))
+      continue;
+    mysql_mutex_lock(&group->mutex);
+    if (!group->active_thread_count && is_queue_runnable(group))
+      wake_or_create_thread(group);
+    mysql_mutex_unlock(&group->mutex);
+  }
+}
+
+
+/**
+ Copy the queue wait time histogram of a thread group.
+
+ As for the idle thread count, no locking is done.
+ Returns true if the group does not exist.
+*/
+
+bool TP_pool_generic::get_queue_latency(uint group, ulonglong *buckets)
+{
+  if (group >= group_count)
+    return true;
+  memcpy(buckets, all_groups[group].queue_latency,
+         sizeof(all_groups[group].queue_latency));
+  return false;
+}
+
+
 /* Report threadpool problems */
 
 /** 
@@ -49,18 +49,19 @@ int unique_write_to_file(uchar* key, element_count count, Unique *unique)
     when tree implementation chooses to store pointer to key in TREE_ELEMENT
     (instead of storing the element itself there)
   */
-  return my_b_write(&unique->file, key, unique->size) ? 1 : 0;
+  return my_b_write(&unique->file, unique->padded_key(key),
+                    unique->size) ? 1 : 0;
 }
 
 int unique_write_to_file_with_count(uchar* key, element_count count, Unique *unique)
 {
-  return my_b_write(&unique->file, key, unique->size) ||
+  return my_b_write(&unique->file, unique->padded_key(key), unique->size) ||
          my_b_write(&unique->file, (uchar*)&count, sizeof(element_count)) ? 1 : 0;
 }
 
 int unique_write_to_ptrs(uchar* key, element_count count, Unique *unique)
 {
-  memcpy(unique->sort.record_pointers, key, unique->size);
+  memcpy(unique->sort.record_pointers, unique->padded_key(key), unique->size);
   unique->sort.record_pointers+=unique->size;
   return 0;
 }
@@ -69,7 +70,8 @@ int unique_intersect_write_to_ptrs(uchar* key, element_count count, Unique *uniq
 {
   if (count >= unique->min_dupl_count)
   {
-    memcpy(unique->sort.record_pointers, key, unique->size);
+    memcpy(unique->sort.record_pointers, unique->padded_key(key),
+           unique->size);
     unique->sort.record_pointers+=unique->size;
   }
   else
@@ -78,11 +80,26 @@ int unique_intersect_write_to_ptrs(uchar* key, element_count count, Unique *uniq
 }
 
 
+/*
+  The hash table of a Unique starts with this number of slots at most and
+  doubles when it gets 3/4 full
+*/
+#define UNIQUE_HASH_MAX_INITIAL_SIZE 1024
+
 Unique::Unique(qsort_cmp2 comp_func, void * comp_func_fixed_arg,
 	       uint size_arg, size_t max_in_memory_size_arg,
-               uint min_dupl_count_arg)
+               uint min_dupl_count_arg, bool packed_arg,
+               unique_hash_func hash_func_arg)
   :max_in_memory_size(max_in_memory_size_arg),
    size(size_arg),
+   packed(packed_arg),
+   packed_rec_buff(NULL),
+   hash_func(hash_func_arg),
+   hash_slots(NULL),
+   hash_size(0),
+   hash_elements(0),
+   hash_keys_size(0),
+   hash_sorted(false),
    elements(0)
 {
   my_b_clear(&file);
@@ -91,8 +108,12 @@ Unique::Unique(qsort_cmp2 comp_func, void * comp_func_fixed_arg,
   if (min_dupl_count_arg)
     full_size+= sizeof(element_count);
   with_counters= MY_TEST(min_dupl_count_arg);
-  init_tree(&tree, (max_in_memory_size / 16), 0, size, comp_func,
+  /* The hash table doesn't count duplicates */
+  DBUG_ASSERT(!hash_func || !with_counters);
+  init_tree(&tree, (max_in_memory_size / 16), 0, packed ? 0 : size, comp_func,
             NULL, comp_func_fixed_arg, MYF(MY_THREAD_SPECIFIC));
+  init_alloc_root(&hash_root, "Unique", (max_in_memory_size / 16), 0,
+                  MYF(MY_THREAD_SPECIFIC));
   /* If the following fail's the next add will also fail */
   my_init_dynamic_array(&file_ptrs, sizeof(BUFFPEK), 16, 16,
                         MYF(MY_THREAD_SPECIFIC));
@@ -369,6 +390,183 @@ Unique::~Unique()
   close_cached_file(&file);
   delete_tree(&tree, 0);
   delete_dynamic(&file_ptrs);
+  free_root(&hash_root, MYF(0));
+  my_free(hash_slots);
+  my_free(packed_rec_buff);
+}
+
+
+/*
+  Compare two keys of the hash table sorted by my_qsort2()
+*/
+
+C_MODE_START
+
+static int unique_hash_key_cmp(const void *arg, const void *key_ptr1,
+                               const void *key_ptr2)
+{
+  TREE *tree= (TREE *) arg;
+  return tree->compare(tree->custom_arg, *((uchar **) key_ptr1),
+                       *((uchar **) key_ptr2));
+}
+
+C_MODE_END
+
+
+/*
+  Spread the hash value of a key over all bits: the hash functions of the
+  collations don't mix the low bits much, and only they are used to pick
+  the slot
+*/
+
+static inline ulong unique_hash_mix(ulong nr)
+{
+  nr^= nr >> 16;
+  nr*= 0x45d9f3bUL;
+  nr^= nr >> 16;
+  return nr;
+}
+
+
+/*
+  Rebuild the hash table with new_size slots
+
+  @note
+    Works for the keys sorted by sort_hash() as well, as the slots with
+    no keys are NULL there too.
+*/
+
+bool Unique::resize_hash(ulong new_size)
+{
+  uchar **old_slots= hash_slots;
+  uchar **old_end= hash_slots + hash_size;
+  ulong mask= new_size - 1;
+  DBUG_ASSERT(!(new_size & mask));
+
+  if (!(hash_slots= (uchar **) my_malloc(new_size * sizeof(uchar *),
+                                         MYF(MY_THREAD_SPECIFIC | MY_WME |
+                                             MY_ZEROFILL))))
+  {
+    hash_slots= old_slots;
+    return 1;
+  }
+  hash_size= new_size;
+  for (uchar **slot= old_slots; slot < old_end; slot++)
+  {
+    if (*slot)
+    {
+      ulong idx= unique_hash_mix(hash_func(tree.custom_arg, *slot)) & mask;
+      while (hash_slots[idx])
+        idx= (idx + 1) & mask;
+      hash_slots[idx]= *slot;
+    }
+  }
+  my_free(old_slots);
+  hash_sorted= false;
+  return 0;
+}
+
+
+/*
+  Add a key to the hash table. Dump the table to the file first if the key
+  is new and there is no memory left for it.
+*/
+
+bool Unique::hash_add(uchar *key)
+{
+  size_t key_size= ALIGN_SIZE(packed ? read_packed_length(key) : size);
+  ulong nr, mask, idx;
+  uchar *elem;
+
+  if (!hash_slots)
+  {
+    ulong init_size= 16;
+    while (init_size < UNIQUE_HASH_MAX_INITIAL_SIZE &&
+           init_size * sizeof(uchar *) * 32 <= max_in_memory_size)
+      init_size*= 2;
+    if (resize_hash(init_size))
+      return 1;
+  }
+  else if (hash_sorted && resize_hash(hash_size))
+    return 1;
+
+  nr= unique_hash_mix(hash_func(tree.custom_arg, key));
+  mask= hash_size - 1;
+  for (idx= nr & mask; (elem= hash_slots[idx]); idx= (idx + 1) & mask)
+  {
+    if (!tree.compare(tree.custom_arg, elem, key))
+      return 0;                                 /* A duplicate */
+  }
+
+  bool grow= (hash_elements + 1) * 4 > hash_size * 3;
+  size_t slots_size= (grow ? hash_size * 2 : hash_size) * sizeof(uchar *);
+  if (hash_elements &&
+      hash_keys_size + key_size + slots_size > max_in_memory_size)
+  {
+    /* The table is empty after the flush */
+    if (flush())
+      return 1;
+    idx= nr & (hash_size - 1);
+  }
+  else if (grow)
+  {
+    if (resize_hash(hash_size * 2))
+      return 1;
+    mask= hash_size - 1;
+    for (idx= nr & mask; hash_slots[idx]; idx= (idx + 1) & mask)
+    {}
+  }
+
+  if (!(elem= (uchar *) alloc_root(&hash_root, key_size)))
+    return 1;
+  memcpy(elem, key, packed ? read_packed_length(key) : size);
+  hash_slots[idx]= elem;
+  hash_elements++;
+  hash_keys_size+= key_size;
+  return 0;
+}
+
+
+/*
+  Sort the keys of the hash table: they are moved to
+  hash_slots[0..hash_elements-1]
+*/
+
+void Unique::sort_hash()
+{
+  if (hash_sorted)
+    return;
+  uchar **to= hash_slots;
+  for (uchar **slot= hash_slots; slot < hash_slots + hash_size; slot++)
+  {
+    if (*slot)
+    {
+      uchar *key= *slot;
+      *slot= NULL;
+      *to++= key;
+    }
+  }
+  my_qsort2(hash_slots, hash_elements, sizeof(uchar *),
+            unique_hash_key_cmp, (void *) &tree);
+  hash_sorted= true;
+}
+
+
+/*
+  Call the action for each key kept in memory, in sorted order
+*/
+
+int Unique::walk_in_memory(tree_walk_action action, void *walk_action_arg)
+{
+  if (!hash_func)
+    return tree_walk(&tree, action, walk_action_arg, left_root_right);
+  sort_hash();
+  for (ulong i= 0; i < hash_elements; i++)
+  {
+    if (action(hash_slots[i], 1, walk_action_arg))
+      return 1;
+  }
+  return 0;
 }
 
 
@@ -376,18 +574,29 @@ Unique::~Unique()
 bool Unique::flush()
 {
   BUFFPEK file_ptr;
-  elements+= tree.elements_in_tree;
-  file_ptr.count=tree.elements_in_tree;
+  elements+= elements_in_tree();
+  file_ptr.count= elements_in_tree();
   file_ptr.file_pos=my_b_tell(&file);
 
+  if (packed && !packed_rec_buff &&
+      !(packed_rec_buff= (uchar *) my_malloc(size, MYF(MY_THREAD_SPECIFIC |
+                                                       MY_WME | MY_ZEROFILL))))
+    return 1;
   tree_walk_action action= min_dupl_count ?
 		           (tree_walk_action) unique_write_to_file_with_count :
 		           (tree_walk_action) unique_write_to_file;
-  if (tree_walk(&tree, action,
-		(void*) this, left_root_right) ||
+  if (walk_in_memory(action, (void*) this) ||
       insert_dynamic(&file_ptrs, (uchar*) &file_ptr))
     return 1;
   delete_tree(&tree, 0);
+  if (hash_func)
+  {
+    bzero(hash_slots, hash_size * sizeof(uchar *));
+    free_root(&hash_root, MYF(MY_MARK_BLOCKS_FREE));
+    hash_elements= 0;
+    hash_keys_size= 0;
+    hash_sorted= false;
+  }
   return 0;
 }
 
@@ -401,6 +610,17 @@ void
 Unique::reset()
 {
   reset_tree(&tree);
+  if (hash_func)
+  {
+    /* Don't keep a big table for the next, possibly small, set of keys */
+    my_free(hash_slots);
+    hash_slots= NULL;
+    hash_size= 0;
+    free_root(&hash_root, MYF(MY_MARK_BLOCKS_FREE));
+    hash_elements= 0;
+    hash_keys_size= 0;
+    hash_sorted= false;
+  }
   /*
     If elements != 0, some trees were stored in the file (see how
     flush() works). Note, that we can not count on my_b_tell(&file) == 0
@@ -640,9 +860,9 @@ bool Unique::walk(TABLE *table, tree_walk_action action, void *walk_action_arg)
   uchar *merge_buffer;
 
   if (elements == 0)                       /* the whole tree is in memory */
-    return tree_walk(&tree, action, walk_action_arg, left_root_right);
+    return walk_in_memory(action, walk_action_arg);
 
-  sort.return_rows= elements+tree.elements_in_tree;
+  sort.return_rows= elements + elements_in_tree();
   /* flush current tree to the file to have some memory for merge buffer */
   if (flush())
     return 1;
@@ -761,22 +981,24 @@ bool Unique::get(TABLE *table)
 {
   bool rc= 1;
   uchar *sort_buffer= NULL;
-  sort.return_rows= elements+tree.elements_in_tree;
+  sort.return_rows= elements + elements_in_tree();
   DBUG_ENTER("Unique::get");
 
   if (my_b_tell(&file) == 0)
   {
     /* Whole tree is in memory;  Don't use disk if you don't need to */
-    if ((sort.record_pointers= (uchar*)
-	 my_malloc(size * tree.elements_in_tree, MYF(MY_THREAD_SPECIFIC))))
+    if ((!packed || packed_rec_buff ||
+         (packed_rec_buff= (uchar *) my_malloc(size, MYF(MY_THREAD_SPECIFIC |
+                                                         MY_ZEROFILL)))) &&
+        (sort.record_pointers= (uchar*)
+	 my_malloc(size * elements_in_tree(), MYF(MY_THREAD_SPECIFIC))))
     {
       uchar *save_record_pointers= sort.record_pointers;
       tree_walk_action action= min_dupl_count ?
 		         (tree_walk_action) unique_intersect_write_to_ptrs :
 		         (tree_walk_action) unique_write_to_ptrs;
       filtered_out_elems= 0;
-      (void) tree_walk(&tree, action,
-		       this, left_root_right);
+      (void) walk_in_memory(action, this);
       /* Restore record_pointers that was changed in by 'action' above */
       sort.record_pointers= save_record_pointers;
       sort.return_rows-= filtered_out_elems;
@@ -18,12 +18,28 @@
 
 #include "filesort.h"
 
+/*
+  Hash function for the keys of a Unique: must return equal values for all
+  keys that the comparison function of the Unique finds equal
+*/
+typedef ulong (*unique_hash_func)(void *arg, const uchar *key);
+
 /*
    Unique -- class for unique (removing of duplicates).
    Puts all values to the TREE. If the tree becomes too big,
    it's dumped to the file. User can request sorted values, or
    just iterate through them. In the last case tree merging is performed in
    memory simultaneously with iteration, so it should be ~2-3x faster.
+
+   A packed Unique takes keys of variable length: every key starts with
+   its full length stored in PACKED_KEY_LENGTH_BYTES bytes, 'size' is the
+   maximal length. The tree keeps the keys with their actual lengths, the
+   trees dumped to the file are padded to 'size' bytes per key.
+
+   When a hash function is given, the values are collected in a hash
+   table instead of the tree, and sorted only when they are dumped to the
+   file or walked through. This is cheaper when most of the added values
+   are duplicates. It can't be used for intersections.
  */
 
 class Unique :public Sql_alloc
@@ -38,26 +54,69 @@ class Unique :public Sql_alloc
   uint full_size;
   uint min_dupl_count;   /* always 0 for unions, > 0 for intersections */
   bool with_counters;
+  bool packed;           /* keys are of variable length */
+  /* Buffer to pad packed keys to 'size' bytes when writing them out */
+  uchar *packed_rec_buff;
+
+  /* The hash table used instead of the tree if hash_func != NULL */
+  unique_hash_func hash_func;
+  uchar **hash_slots;    /* open addressing, pointers to the keys */
+  ulong hash_size;       /* number of slots, a power of 2 */
+  ulong hash_elements;
+  size_t hash_keys_size; /* memory allocated for the keys in hash_root */
+  MEM_ROOT hash_root;
+  /* TRUE <=> hash_slots[0..hash_elements-1] are the keys in sorted order */
+  bool hash_sorted;
 
   bool merge(TABLE *table, uchar *buff, bool without_last_merge);
   bool flush();
+  int walk_in_memory(tree_walk_action action, void *walk_action_arg);
+  bool hash_add(uchar *key);
+  bool resize_hash(ulong new_size);
+  void sort_hash();
+  uchar *padded_key(uchar *key)
+  {
+    if (!packed)
+      return key;
+    memcpy(packed_rec_buff, key, read_packed_length(key));
+    return packed_rec_buff;
+  }
 
 public:
   ulong elements;
   SORT_INFO sort;
   Unique(qsort_cmp2 comp_func, void *comp_func_fixed_arg,
 	 uint size_arg, size_t max_in_memory_size_arg,
-         uint min_dupl_count_arg= 0);
+         uint min_dupl_count_arg= 0, bool packed_arg= false,
+         unique_hash_func hash_func_arg= NULL);
   ~Unique();
-  ulong elements_in_tree() { return tree.elements_in_tree; }
+  ulong elements_in_tree()
+  {
+    return hash_func ? hash_elements : tree.elements_in_tree;
+  }
   inline bool unique_add(void *ptr)
   {
     DBUG_ENTER("unique_add");
     DBUG_PRINT("info", ("tree %u - %lu", tree.elements_in_tree, max_elements));
-    if (!(tree.flag & TREE_ONLY_DUPS) && 
-        tree.elements_in_tree >= max_elements && flush())
+    if (hash_func)
+      DBUG_RETURN(hash_add((uchar *) ptr));
+    if (!(tree.flag & TREE_ONLY_DUPS) &&
+        (packed ? tree.allocated >= max_in_memory_size :
+                  tree.elements_in_tree >= max_elements) &&
+        flush())
       DBUG_RETURN(1);
-    DBUG_RETURN(!tree_insert(&tree, ptr, 0, tree.custom_arg));
+    DBUG_RETURN(!tree_insert(&tree, ptr,
+                             packed ? read_packed_length((uchar *) ptr) : 0,
+                             tree.custom_arg));
+  }
+
+  /* Number of bytes used to store the length of a packed key */
+  static const uint PACKED_KEY_LENGTH_BYTES= 4;
+  /* Full length of a packed key, including the length bytes */
+  static uint read_packed_length(const uchar *key) { return uint4korr(key); }
+  static void store_packed_length(uchar *key, uint length)
+  {
+    int4store(key, length);
   }
 
   bool is_in_memory() { return (my_b_tell(&file) == 0); }
@@ -44,7 +44,7 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
 {
   int error;
   uint key;
-  ulong records=0, deleted=0, pos, next_block;
+  ulong records=0, deleted=0, chunks=0, pos, next_block;
   HP_SHARE *share=info->s;
   HP_INFO save_info= *info;			/* Needed because scan_init */
   DBUG_ENTER("heap_check_heap");
@@ -82,7 +82,17 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
     if (!info->current_ptr[share->visible])
       deleted++;
     else
+    {
       records++;
+      if (share->columns)
+      {
+        uchar *chunk;
+        memcpy(&chunk, info->current_ptr + share->fixed_length + 4,
+               sizeof(chunk));
+        for (; chunk; chunk= *((uchar**) chunk))
+          chunks++;
+      }
+    }
   }
 
   if (records != share->records || deleted != share->deleted)
@@ -92,6 +102,12 @@ int heap_check_heap(HP_INFO *info, my_bool print_status)
                         deleted, (ulong) share->deleted));
     error= 1;
   }
+  if (chunks + share->var_deleted != share->var_chunks)
+  {
+    DBUG_PRINT("error",("Found chunks: %lu  free %lu (%lu)",
+                        chunks, share->var_deleted, share->var_chunks));
+    error= 1;
+  }
   *info= save_info;
   DBUG_RETURN(error);
 }
@@ -21,9 +21,27 @@
 
 int hp_rectest(register HP_INFO *info, register const uchar *old)
 {
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  uint start= 0;
   DBUG_ENTER("hp_rectest");
 
-  if (memcmp(info->current_ptr,old,(size_t) info->s->reclength))
+  /*
+    For variable-length rows only the fixed part is compared, skipping the
+    pointers of BLOB columns stored in it.
+  */
+  for (column= share->columndef, end= column + share->columns;
+       column < end && column->offset < share->fixed_length; column++)
+  {
+    if (column->type != HP_COLUMN_BLOB)
+      continue;
+    if (memcmp(info->current_ptr + start, old + start,
+               column->offset - start))
+      DBUG_RETURN((my_errno=HA_ERR_RECORD_CHANGED));
+    start= column->offset + column->length;
+  }
+  if (memcmp(info->current_ptr + start, old + start,
+             (size_t) share->fixed_length - start))
   {
     DBUG_RETURN((my_errno=HA_ERR_RECORD_CHANGED)); /* Record have changed */
   }
@@ -103,6 +103,7 @@ int ha_heap::open(const char *name, int mode, uint test_if_locked)
 
     rc= heap_create(name, &create_info, &internal_share, &created_new_share);
     my_free(create_info.keydef);
+    my_free(create_info.columndef);
     if (rc)
       goto end;
 
@@ -349,6 +350,22 @@ int ha_heap::rnd_next(uchar *buf)
   return error;
 }
 
+int ha_heap::remember_rnd_pos()
+{
+  remember_record= file->current_record;
+  remember_next_block= file->next_block;
+  remember_ptr= file->current_ptr;
+  return 0;
+}
+
+int ha_heap::restart_rnd_next(uchar *buf)
+{
+  /* Continue the scan from the remembered row, starting with that row */
+  file->current_record= remember_record;
+  file->next_block= remember_next_block;
+  return heap_rrnd(file, buf, remember_ptr);
+}
+
 int ha_heap::rnd_pos(uchar * buf, uchar *pos)
 {
   int error;
@@ -599,12 +616,136 @@ ha_rows ha_heap::records_in_range(uint inx, key_range *min_key,
 }
 
 
+/*
+  Minimum number of bytes that packing VARCHAR columns must be able to
+  save per row before variable-length rows are used for a table without
+  blobs.
+*/
+#define HEAP_MIN_VAR_SAVING 128
+
+static int heap_columndef_cmp(const void *a, const void *b)
+{
+  uint offset_a= ((const HP_COLUMNDEF*) a)->offset;
+  uint offset_b= ((const HP_COLUMNDEF*) b)->offset;
+  return offset_a < offset_b ? -1 : offset_a > offset_b ? 1 : 0;
+}
+
+
+/*
+  Set up variable-length rows for an internal temporary table
+
+  SYNOPSIS
+    heap_prepare_hp_columndef()
+    table_arg       Table
+    fixed_length    Bytes at the start of the record that contain all
+                    key parts
+    hp_create_info  Columns to store packed are added here
+
+  DESCRIPTION
+    Everything after fixed_length and all BLOB columns are packed.
+    Nothing is done if there are no blobs and packing would save less
+    than HEAP_MIN_VAR_SAVING bytes per row.
+
+  RETURN
+    0   ok
+    #   error
+*/
+
+static int
+heap_prepare_hp_columndef(TABLE *table_arg, uint fixed_length,
+                          HP_CREATE_INFO *hp_create_info)
+{
+  TABLE_SHARE *share= table_arg->s;
+  HP_COLUMNDEF *columndef, *fields, *column, *end, *to;
+  uint i, pos, var_saving= 0;
+
+  /*
+    The result needs at most one gap before every column and one after
+    the last. The unsorted columns are collected after it.
+  */
+  if (!(columndef= (HP_COLUMNDEF*) my_malloc((share->fields * 3 + 1) *
+                                             sizeof(HP_COLUMNDEF),
+                                             MYF(MY_WME |
+                                                 MY_THREAD_SPECIFIC))))
+    return my_errno;
+  fields= columndef + share->fields * 2 + 1;
+
+  for (i= 0, end= fields; i < share->fields; i++)
+  {
+    Field *field= table_arg->field[i];
+    end->offset= (uint) (field->ptr - table_arg->record[0]);
+    end->length= field->pack_length();
+    end->type= HP_COLUMN_FIXED;
+    end->length_bytes= 0;
+    if (field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      end->type= HP_COLUMN_VARCHAR;
+      end->length_bytes= (uint8) ((Field_varstring*) field)->length_bytes;
+    }
+    else if (field->flags & BLOB_FLAG)
+    {
+      end->type= HP_COLUMN_BLOB;
+      end->length_bytes= (uint8) ((Field_blob*) field)->pack_length_no_ptr();
+    }
+    if (end->offset < fixed_length && end->type != HP_COLUMN_BLOB)
+      continue;                                 // Stored in the fixed part
+    if (end->type == HP_COLUMN_VARCHAR)
+      var_saving+= end->length - end->length_bytes;
+    end++;
+  }
+
+  if (!share->blob_fields && var_saving < HEAP_MIN_VAR_SAVING)
+  {
+    my_free(columndef);
+    return 0;
+  }
+
+  /*
+    Sort the columns by offset and fill the gaps after fixed_length
+    (null bytes, bits) with FIXED columns. Adjacent FIXED columns are
+    merged.
+  */
+  my_qsort(fields, end - fields, sizeof(HP_COLUMNDEF), heap_columndef_cmp);
+  for (column= fields, to= columndef, pos= fixed_length; column < end;
+       column++)
+  {
+    if (column->offset > pos)
+    {
+      to->offset= pos;
+      to->length= column->offset - pos;
+      to->type= HP_COLUMN_FIXED;
+      to->length_bytes= 0;
+      to++;
+    }
+    if (to > columndef && column->type == HP_COLUMN_FIXED &&
+        to[-1].type == HP_COLUMN_FIXED &&
+        to[-1].offset + to[-1].length == column->offset)
+      to[-1].length+= column->length;
+    else
+      *to++= *column;
+    pos= MY_MAX(pos, column->offset + column->length);
+  }
+  if (pos < share->reclength)
+  {
+    to->offset= pos;
+    to->length= share->reclength - pos;
+    to->type= HP_COLUMN_FIXED;
+    to->length_bytes= 0;
+    to++;
+  }
+  hp_create_info->columndef= columndef;
+  hp_create_info->columns= (uint) (to - columndef);
+  hp_create_info->fixed_length= fixed_length;
+  return 0;
+}
+
+
 static int
 heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
                             HP_CREATE_INFO *hp_create_info)
 {
   uint key, parts, mem_per_row= 0, keys= table_arg->s->keys;
-  uint auto_key= 0, auto_key_type= 0;
+  uint auto_key= 0, auto_key_type= 0, fixed_length= 0;
   ha_rows max_rows;
   HP_KEYDEF *keydef;
   HA_KEYSEG *seg;
@@ -649,6 +790,16 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
     {
       Field *field= key_part->field;
 
+      if (field->flags & BLOB_FLAG)
+      {
+        /* Keys on blobs are not supported */
+        my_free(keydef);
+        return my_errno= HA_ERR_UNSUPPORTED;
+      }
+      set_if_bigger(fixed_length,
+                    (uint) (field->ptr - table_arg->record[0]) +
+                    field->pack_length());
+
       if (pos->algorithm == HA_KEY_ALG_BTREE)
 	seg->type= field->key_type();
       else
@@ -673,6 +824,7 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
       {
 	seg->null_bit= field->null_bit;
 	seg->null_pos= (uint) (field->null_ptr - (uchar*) table_arg->record[0]);
+        set_if_bigger(fixed_length, seg->null_pos + 1);
       }
       else
       {
@@ -696,6 +848,8 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
         seg->bit_start= ((Field_bit *) field)->bit_ofs;
         seg->bit_pos= (uint) (((Field_bit *) field)->bit_ptr -
                                           (uchar*) table_arg->record[0]);
+        if (seg->bit_length)
+          set_if_bigger(fixed_length, seg->bit_pos + 1);
       }
       else
       {
@@ -704,7 +858,23 @@ heap_prepare_hp_create_info(TABLE *table_arg, bool internal_table,
       }
     }
   }
-  mem_per_row+= MY_ALIGN(MY_MAX(share->reclength, sizeof(char*)) + 1, sizeof(char*));
+  /*
+    Internal temporary tables may store the rest of the record after the
+    key parts packed, see hp_var.c
+  */
+  if (internal_table &&
+      heap_prepare_hp_columndef(table_arg, fixed_length, hp_create_info))
+  {
+    my_free(keydef);
+    return my_errno;
+  }
+  if (hp_create_info->columns)
+    mem_per_row+= MY_ALIGN(MY_MAX(fixed_length + HP_VAR_HEADER_LENGTH,
+                                  sizeof(char*)) + 1, sizeof(char*)) +
+                  HP_VAR_CHUNK_LENGTH;
+  else
+    mem_per_row+= MY_ALIGN(MY_MAX(share->reclength, sizeof(char*)) + 1,
+                           sizeof(char*));
   if (table_arg->found_next_number_field)
   {
     keydef[share->next_number_index].flag|= HA_AUTO_KEY;
@@ -744,6 +914,7 @@ int ha_heap::create(const char *name, TABLE *table_arg,
 				  create_info->auto_increment_value - 1 : 0);
   error= heap_create(name, &hp_create_info, &internal_share, &created);
   my_free(hp_create_info.keydef);
+  my_free(hp_create_info.columndef);
   DBUG_ASSERT(file == 0);
   return (error);
 }
@@ -819,7 +990,8 @@ int ha_heap::find_unique_row(uchar *record, uint unique_idx)
         We compare it only by record in the index, so better to read all
         records.
       */
-      memcpy(record, file->current_ptr, (size_t) share->reclength);
+      if (hp_extract_record(file, record, file->current_ptr))
+        DBUG_RETURN(-1);
 
       DBUG_RETURN(0); // found and position set
     }
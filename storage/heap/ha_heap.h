@@ -34,6 +34,9 @@ class ha_heap: public handler
   ulong   records_changed;
   uint    key_stat_version;
   my_bool internal_table;
+  /* Scan position saved by remember_rnd_pos() */
+  ulong   remember_record, remember_next_block;
+  uchar   *remember_ptr;
 public:
   ha_heap(handlerton *hton, TABLE_SHARE *table);
   ~ha_heap() {}
@@ -90,6 +93,8 @@ class ha_heap: public handler
   int rnd_init(bool scan);
   int rnd_next(uchar *buf);
   int rnd_pos(uchar * buf, uchar *pos);
+  int remember_rnd_pos();
+  int restart_rnd_next(uchar *buf);
   void position(const uchar *record);
   int can_continue_handler_scan();
   int info(uint);
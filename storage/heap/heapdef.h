@@ -33,6 +33,15 @@ C_MODE_START
 #define HP_MIN_RECORDS_IN_BLOCK 16
 #define HP_MAX_RECORDS_IN_BLOCK 8192
 
+/*
+  Packed part of variable-length rows is stored in chunks of this size
+  (including the pointer to the next chunk). The record in share->block
+  holds the total packed length and a pointer to the first chunk.
+*/
+
+#define HP_VAR_CHUNK_LENGTH 256
+#define HP_VAR_HEADER_LENGTH (4 + sizeof(uchar*))
+
 	/* Some extern variables */
 
 extern LIST *heap_open_list,*heap_share_list;
@@ -101,6 +110,9 @@ extern void hp_clear(HP_SHARE *info);
 extern void hp_clear_keys(HP_SHARE *info);
 extern uint hp_rb_pack_key(HP_KEYDEF *keydef, uchar *key, const uchar *old,
                            key_part_map keypart_map);
+extern int hp_write_var(HP_SHARE *share, uchar *pos, const uchar *record);
+extern void hp_free_var(HP_SHARE *share, const uchar *header);
+extern int hp_extract_record(HP_INFO *info, uchar *record, const uchar *pos);
 
 extern mysql_mutex_t THR_LOCK_heap;
 
@@ -35,6 +35,12 @@ void hp_clear(HP_SHARE *info)
     (void) hp_free_level(&info->block,info->block.levels,info->block.root,
 			(uchar*) 0);
   info->block.levels=0;
+  if (info->var_block.levels)
+    (void) hp_free_level(&info->var_block,info->var_block.levels,
+                         info->var_block.root, (uchar*) 0);
+  info->var_block.levels=0;
+  info->var_del_link=0;
+  info->var_chunks= info->var_deleted= 0;
   hp_clear_keys(info);
   info->records= info->deleted= 0;
   info->data_length= 0;
@@ -33,6 +33,8 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
   uint keys= create_info->keys;
   ulong min_records= create_info->min_records;
   ulong max_records= create_info->max_records;
+  uint columns= create_info->columns;
+  uint fixed_length= columns ? create_info->fixed_length : reclength;
   uint visible_offset;
   DBUG_ENTER("heap_create");
 
@@ -59,9 +61,12 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     
     /*
       We have to store sometimes uchar* del_link in records,
-      so the visible_offset must be least at sizeof(uchar*)
+      so the visible_offset must be least at sizeof(uchar*).
+      Variable-length rows keep the header of the packed part after
+      the fixed part.
     */
-    visible_offset= MY_MAX(reclength, sizeof (char*));
+    visible_offset= MY_MAX(fixed_length + (columns ? HP_VAR_HEADER_LENGTH : 0),
+                           sizeof (char*));
     
     for (i= key_segs= max_length= 0, keyinfo= keydef; i < keys; i++, keyinfo++)
     {
@@ -161,7 +166,8 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     }
     if (!(share= (HP_SHARE*) my_malloc((uint) sizeof(HP_SHARE)+
 				       keys*sizeof(HP_KEYDEF)+
-				       key_segs*sizeof(HA_KEYSEG),
+				       key_segs*sizeof(HA_KEYSEG)+
+				       columns*sizeof(HP_COLUMNDEF),
 				       MYF(MY_ZEROFILL |
                                            (create_info->internal_table ?
                                             MY_THREAD_SPECIFIC : 0)))))
@@ -170,6 +176,28 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     share->key_stat_version= 1;
     keyseg= (HA_KEYSEG*) (share->keydef + keys);
     init_block(&share->block, visible_offset + 1, min_records, max_records);
+    if (columns)
+    {
+      uint max_var_length= 0;
+      share->columndef= (HP_COLUMNDEF*) (keyseg + key_segs);
+      memcpy(share->columndef, create_info->columndef,
+             (size_t) (sizeof(HP_COLUMNDEF) * columns));
+      for (i= 0; i < columns; i++)
+      {
+        if (share->columndef[i].type == HP_COLUMN_BLOB)
+          share->blobs++;
+        max_var_length+= share->columndef[i].length;
+      }
+      /*
+        Without blobs the packed part is never longer than the columns,
+        so don't use chunks bigger than needed for that.
+      */
+      init_block(&share->var_block,
+                 share->blobs ? HP_VAR_CHUNK_LENGTH :
+                 MY_MIN(HP_VAR_CHUNK_LENGTH,
+                        max_var_length + sizeof(uchar*)),
+                 min_records, max_records);
+    }
 	/* Fix keys */
     memcpy(share->keydef, keydef, (size_t) (sizeof(keydef[0]) * keys));
     for (i= 0, keyinfo= share->keydef; i < keys; i++, keyinfo++)
@@ -211,6 +239,8 @@ int heap_create(const char *name, HP_CREATE_INFO *create_info,
     share->max_table_size= create_info->max_table_size;
     share->data_length= share->index_length= 0;
     share->reclength= reclength;
+    share->fixed_length= fixed_length;
+    share->columns= columns;
     share->visible= visible_offset;
     share->blength= 1;
     share->keys= keys;
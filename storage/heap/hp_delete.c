@@ -43,6 +43,8 @@ int heap_delete(HP_INFO *info, const uchar *record)
   }
 
   info->update=HA_STATE_DELETED;
+  if (share->columns)
+    hp_free_var(share, pos + share->fixed_length);
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
   pos[share->visible]=0;		/* Record deleted */
@@ -24,6 +24,7 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
   uchar *pos;
   my_bool auto_key_changed= 0, key_changed= 0;
   HP_SHARE *share= info->s;
+  uchar old_header[HP_VAR_HEADER_LENGTH];
   DBUG_ENTER("heap_update");
 
   test_active(info);
@@ -31,6 +32,13 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
 
   if (info->opt_flag & READ_CHECK_USED && hp_rectest(info,old))
     DBUG_RETURN(my_errno);				/* Record changed */
+  if (share->columns)
+  {
+    /* Store the new packed part first; the old one is freed on success */
+    memcpy(old_header, pos + share->fixed_length, HP_VAR_HEADER_LENGTH);
+    if (hp_write_var(share, pos, heap_new))
+      DBUG_RETURN(my_errno);
+  }
   if (--(share->records) < share->blength >> 1) share->blength>>= 1;
   share->changed=1;
 
@@ -47,7 +55,9 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
     }
   }
 
-  memcpy(pos,heap_new,(size_t) share->reclength);
+  memcpy(pos,heap_new,(size_t) share->fixed_length);
+  if (share->columns)
+    hp_free_var(share, old_header);
   if (++(share->records) == share->blength) share->blength+= share->blength;
 
 #if !defined(DBUG_OFF) && defined(EXTRA_HEAP_DEBUG)
@@ -60,6 +70,11 @@ int heap_update(HP_INFO *info, const uchar *old, const uchar *heap_new)
   DBUG_RETURN(0);
 
  err:
+  if (share->columns)
+  {
+    hp_free_var(share, pos + share->fixed_length);
+    memcpy(pos + share->fixed_length, old_header, HP_VAR_HEADER_LENGTH);
+  }
   if (my_errno == HA_ERR_FOUND_DUPP_KEY)
   {
     info->errkey = (int) (keydef - share->keydef);
@@ -0,0 +1,322 @@
+/* Copyright (c) 2018, MariaDB Corporation.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Variable-length rows.
+
+  For tables created with columndef, only the first share->fixed_length
+  bytes of a record (which contain all key parts) are stored in
+  share->block. They are followed by a header of HP_VAR_HEADER_LENGTH
+  bytes: the length of the packed rest of the record and a pointer to the
+  first chunk holding it.
+
+  The rest of the record is packed column by column:
+    HP_COLUMN_FIXED    The bytes as they are in the record
+    HP_COLUMN_VARCHAR  The length bytes and the used part of the string
+    HP_COLUMN_BLOB     The length bytes and the blob data
+
+  and stored in a chain of chunks allocated from share->var_block.
+  Every chunk starts with a pointer to the next chunk in the chain.
+  Free chunks are linked through the same pointer from share->var_del_link.
+*/
+
+#include "heapdef.h"
+
+typedef struct st_hp_var_writer
+{
+  HP_SHARE *share;
+  uchar *first;				/* First chunk of the chain */
+  uchar *chunk;				/* Chunk we are writing to */
+  uchar *pos, *end;			/* Free space in 'chunk' */
+  ulonglong length;			/* Bytes written so far */
+} HP_VAR_WRITER;
+
+
+static ulong hp_blob_length(uint length_bytes, const uchar *pos)
+{
+  switch (length_bytes) {
+  case 1:
+    return (ulong) *pos;
+  case 2:
+    return (ulong) uint2korr(pos);
+  case 3:
+    return (ulong) uint3korr(pos);
+  case 4:
+    return (ulong) uint4korr(pos);
+  default:
+    break;
+  }
+  DBUG_ASSERT(0);
+  return 0;
+}
+
+
+	/* Find where to place a new chunk */
+
+static uchar *hp_alloc_chunk(HP_SHARE *share)
+{
+  ulong block_pos;
+  size_t length;
+  uchar *pos;
+
+  if ((pos= share->var_del_link))
+  {
+    share->var_del_link= *((uchar**) pos);
+    share->var_deleted--;
+    return pos;
+  }
+  if (!(block_pos= (share->var_chunks % share->var_block.records_in_block)))
+  {
+    if (share->data_length + share->index_length >= share->max_table_size)
+    {
+      DBUG_PRINT("error",
+                 ("record file full. chunks: %lu  data_length: %llu  "
+                  "index_length: %llu  max_table_size: %llu",
+                  share->var_chunks, share->data_length,
+                  share->index_length, share->max_table_size));
+      my_errno= HA_ERR_RECORD_FILE_FULL;
+      return NULL;
+    }
+    if (hp_get_new_block(share, &share->var_block, &length))
+      return NULL;
+    share->data_length+= length;
+  }
+  share->var_chunks++;
+  return ((uchar*) share->var_block.level_info[0].last_blocks +
+          block_pos * share->var_block.recbuffer);
+}
+
+
+static void hp_free_chain(HP_SHARE *share, uchar *chunk)
+{
+  uchar *next;
+  for (; chunk; chunk= next)
+  {
+    next= *((uchar**) chunk);
+    *((uchar**) chunk)= share->var_del_link;
+    share->var_del_link= chunk;
+    share->var_deleted++;
+  }
+}
+
+
+static int hp_put(HP_VAR_WRITER *writer, const uchar *from, size_t length)
+{
+  if ((writer->length+= length) > UINT_MAX32)
+    return (my_errno= HA_ERR_RECORD_FILE_FULL);
+  while (length)
+  {
+    size_t part;
+    if (writer->pos == writer->end)
+    {
+      uchar *chunk;
+      if (!(chunk= hp_alloc_chunk(writer->share)))
+        return my_errno;
+      *((uchar**) chunk)= 0;
+      if (writer->chunk)
+        *((uchar**) writer->chunk)= chunk;
+      else
+        writer->first= chunk;
+      writer->chunk= chunk;
+      writer->pos= chunk + sizeof(uchar*);
+      writer->end= chunk + writer->share->var_block.recbuffer;
+    }
+    part= MY_MIN(length, (size_t) (writer->end - writer->pos));
+    memcpy(writer->pos, from, part);
+    writer->pos+= part;
+    from+= part;
+    length-= part;
+  }
+  return 0;
+}
+
+
+/*
+  Store the packed part of a record
+
+  SYNOPSIS
+    hp_write_var()
+    share      Heap table share
+    pos        Record in share->block. The header after the first
+               share->fixed_length bytes is only written on success
+    record     Record to store
+
+  RETURN
+    0      ok
+    #      error. Nothing is allocated
+*/
+
+int hp_write_var(HP_SHARE *share, uchar *pos, const uchar *record)
+{
+  HP_COLUMNDEF *column, *end;
+  HP_VAR_WRITER writer;
+  DBUG_ENTER("hp_write_var");
+
+  bzero(&writer, sizeof(writer));
+  writer.share= share;
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    const uchar *from= record + column->offset;
+    switch ((enum hp_column_type) column->type) {
+    case HP_COLUMN_FIXED:
+      if (hp_put(&writer, from, column->length))
+        goto err;
+      break;
+    case HP_COLUMN_VARCHAR:
+    {
+      uint length= (column->length_bytes == 1 ? (uint) *from :
+                    uint2korr(from));
+      if (hp_put(&writer, from, column->length_bytes + length))
+        goto err;
+      break;
+    }
+    case HP_COLUMN_BLOB:
+    {
+      const uchar *data;
+      ulong length= hp_blob_length(column->length_bytes, from);
+      memcpy(&data, from + column->length_bytes, sizeof(data));
+      if (hp_put(&writer, from, column->length_bytes) ||
+          hp_put(&writer, data, length))
+        goto err;
+      break;
+    }
+    }
+  }
+  int4store(pos + share->fixed_length, (uint32) writer.length);
+  memcpy(pos + share->fixed_length + 4, &writer.first, sizeof(uchar*));
+  DBUG_RETURN(0);
+
+err:
+  hp_free_chain(share, writer.first);
+  DBUG_RETURN(my_errno);
+}
+
+
+/*
+  Free the chunks of a record
+
+  SYNOPSIS
+    hp_free_var()
+    share      Heap table share
+    header     The HP_VAR_HEADER_LENGTH bytes following the first
+               share->fixed_length bytes of the record
+*/
+
+void hp_free_var(HP_SHARE *share, const uchar *header)
+{
+  uchar *chunk;
+  memcpy(&chunk, header + 4, sizeof(uchar*));
+  hp_free_chain(share, chunk);
+}
+
+
+/*
+  Copy a stored record to the caller's record buffer
+
+  SYNOPSIS
+    hp_extract_record()
+    info       Heap table handler
+    record     Record buffer to fill
+    pos        Record in share->block
+
+  NOTES
+    BLOB columns of the returned record point into info->rec_buff and
+    are valid until the next row is read with this handler.
+
+  RETURN
+    0      ok
+    #      error (out of memory)
+*/
+
+int hp_extract_record(HP_INFO *info, uchar *record, const uchar *pos)
+{
+  HP_SHARE *share= info->s;
+  HP_COLUMNDEF *column, *end;
+  const uchar *from, *chunk;
+  size_t length, chunk_data= share->var_block.recbuffer - sizeof(uchar*);
+
+  if (!share->columns)
+  {
+    memcpy(record, pos, (size_t) share->reclength);
+    return 0;
+  }
+  memcpy(record, pos, (size_t) share->fixed_length);
+  length= uint4korr(pos + share->fixed_length);
+  memcpy(&chunk, pos + share->fixed_length + 4, sizeof(uchar*));
+
+  if (length <= chunk_data && !share->blobs)
+    from= chunk + sizeof(uchar*);             /* Unpack from the chunk */
+  else
+  {
+    uchar *to;
+    size_t left;
+    if (length > info->rec_buff_length)
+    {
+      uchar *buff;
+      if (!(buff= (uchar*) my_realloc(info->rec_buff, length,
+                                      MYF(MY_WME | MY_ALLOW_ZERO_PTR |
+                                          (share->internal ?
+                                           MY_THREAD_SPECIFIC : 0)))))
+        return my_errno;
+      info->rec_buff= buff;
+      info->rec_buff_length= length;
+    }
+    for (to= info->rec_buff, left= length; left; left-= chunk_data)
+    {
+      DBUG_ASSERT(chunk);
+      if (left <= chunk_data)
+      {
+        memcpy(to, chunk + sizeof(uchar*), left);
+        break;
+      }
+      memcpy(to, chunk + sizeof(uchar*), chunk_data);
+      to+= chunk_data;
+      chunk= *((uchar* const*) chunk);
+    }
+    from= info->rec_buff;
+  }
+
+  for (column= share->columndef, end= column + share->columns;
+       column < end; column++)
+  {
+    uchar *to= record + column->offset;
+    switch ((enum hp_column_type) column->type) {
+    case HP_COLUMN_FIXED:
+      memcpy(to, from, column->length);
+      from+= column->length;
+      break;
+    case HP_COLUMN_VARCHAR:
+    {
+      uint var_length= column->length_bytes + (column->length_bytes == 1 ?
+                                               (uint) *from :
+                                               uint2korr(from));
+      memcpy(to, from, var_length);
+      from+= var_length;
+      break;
+    }
+    case HP_COLUMN_BLOB:
+    {
+      ulong blob_length= hp_blob_length(column->length_bytes, from);
+      memcpy(to, from, column->length_bytes);
+      from+= column->length_bytes;
+      memcpy(to + column->length_bytes, &from, sizeof(from));
+      from+= blob_length;
+      break;
+    }
+    }
+  }
+  return 0;
+}
@@ -45,6 +45,14 @@ int heap_write(HP_INFO *info, const uchar *record)
   if (!(pos=next_free_record_pos(share)))
     DBUG_RETURN(my_errno);
   share->changed=1;
+  if (share->columns && hp_write_var(share, pos, record))
+  {
+    share->deleted++;
+    *((uchar**) pos)=share->del_link;
+    share->del_link=pos;
+    pos[share->visible]= 0;
+    DBUG_RETURN(my_errno);
+  }
 
   for (keydef = share->keydef, end = keydef + share->keys; keydef < end;
        keydef++)
@@ -53,7 +61,7 @@ int heap_write(HP_INFO *info, const uchar *record)
       goto err;
   }
 
-  memcpy(pos,record,(size_t) share->reclength);
+  memcpy(pos,record,(size_t) share->fixed_length);
   pos[share->visible]= 1;                     /* Mark record as not deleted */
   if (++share->records == share->blength)
     share->blength+= share->blength;
@@ -89,6 +97,8 @@ int heap_write(HP_INFO *info, const uchar *record)
     keydef--;
   } 
 
+  if (share->columns)
+    hp_free_var(share, pos + share->fixed_length);
   share->deleted++;
   *((uchar**) pos)=share->del_link;
   share->del_link=pos;
@@ -316,6 +316,45 @@ size_t vio_write(Vio *vio, const uchar* buf, size_t size)
   DBUG_RETURN(ret);
 }
 
+#ifndef _WIN32
+/*
+  Write the contents of several buffers with a single system call.
+
+  Unlike vio_write(), this never waits for the socket to become writable,
+  and is only available for plain sockets, not for SSL, named pipes or
+  shared memory. The caller is expected to write whatever was not taken
+  with vio_write().
+
+  @return number of bytes written, or -1 if nothing could be written
+*/
+
+ssize_t vio_writev(Vio *vio, const struct iovec *iov, int iovcnt)
+{
+  ssize_t ret;
+  struct msghdr msg;
+  MYSQL_SOCKET_WAIT_VARIABLES(locker, state) /* no ';' */
+  DBUG_ENTER("vio_writev");
+
+  if ((vio->type != VIO_TYPE_TCPIP && vio->type != VIO_TYPE_SOCKET) ||
+      vio->async_context)
+    DBUG_RETURN(-1);
+
+  bzero(&msg, sizeof(msg));
+  msg.msg_iov= (struct iovec *) iov;
+  msg.msg_iovlen= iovcnt;
+
+  MYSQL_START_SOCKET_WAIT(locker, &state, vio->mysql_socket,
+                          PSI_SOCKET_SEND, 0);
+  ret= sendmsg(mysql_socket_getfd(vio->mysql_socket), &msg,
+               vio->write_timeout >= 0 ? VIO_DONTWAIT : 0);
+  MYSQL_END_SOCKET_WAIT(locker, ret > 0 ? (size_t) ret : 0);
+
+  DBUG_PRINT("exit", ("%d", (int) ret));
+  DBUG_RETURN(ret);
+}
+#endif
+
+
 int vio_socket_shutdown(Vio *vio, int how)
 {
   int ret= shutdown(mysql_socket_getfd(vio->mysql_socket), how);